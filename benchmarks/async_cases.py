@@ -372,3 +372,29 @@ def deep_hierarchy(scale):
             jitter()
 
     ti.benchmark(task, repeat=5)
+
+
+@benchmark_async
+def launch_throughput(scale):
+    # Many distinct small kernels, so that the launch path (cloning and
+    # hashing offloaded tasks, inserting them into the SFG) dominates.
+    num_kernels = 32 * scale
+    a = ti.field(dtype=ti.f32, shape=num_kernels)
+
+    def make_kernel(k):
+        @ti.kernel
+        def inc():
+            for i in range(16):
+                a[k] += i
+            a[(k + 1) % num_kernels] *= 0.5
+
+        return inc
+
+    kernels = [make_kernel(k) for k in range(num_kernels)]
+
+    def task():
+        for _ in range(10):
+            for inc in kernels:
+                inc()
+
+    ti.benchmark(task, repeat=10)
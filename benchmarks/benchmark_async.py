@@ -7,7 +7,8 @@ rerun = True
 
 cases = [
     chain_copy, increments, fill_array, sparse_saxpy, autodiff,
-    stencil_reduction, mpm_splitted, simple_advection, multires, deep_hierarchy
+    stencil_reduction, mpm_splitted, simple_advection, multires, deep_hierarchy,
+    launch_throughput
 ]
 
 if rerun:
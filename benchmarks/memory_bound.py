@@ -57,3 +57,36 @@ def benchmark_saxpy():
             z[i] = a * x[i] + y[i]
 
     return ti.benchmark(task, repeat=10)
+
+
+# 4 B/it: four 14-bit significands and their 8-bit exponent per 8 B word
+@ti.test(require=ti.extension.quant)
+def benchmark_sscal_shared_exponent():
+    cft = ti.quant.float(exp=8, frac=14)
+    a = ti.field(dtype=cft)
+    ti.root.dense(ti.i, N // 4).bit_array(ti.i, 4, num_bits=64).place(
+        a, shared_exponent=True)
+
+    @ti.kernel
+    def task():
+        for i in range(N):
+            a[i] = 0.5 * a[i]
+
+    return ti.benchmark(task, repeat=10)
+
+
+# 4 B/it
+@ti.test(require=ti.extension.quant)
+def benchmark_memcpy_fixed16():
+    cft = ti.quant.fixed(frac=16, num_range=2.0)
+    a = ti.field(dtype=cft)
+    b = ti.field(dtype=cft)
+    ti.root.dense(ti.i, N // 2).bit_array(ti.i, 2, num_bits=32).place(a)
+    ti.root.dense(ti.i, N // 2).bit_array(ti.i, 2, num_bits=32).place(b)
+
+    @ti.kernel
+    def memcpy():
+        for i in range(N):
+            a[i] = b[i]
+
+    return ti.benchmark(memcpy, repeat=10)
@@ -0,0 +1,22 @@
+import taichi as ti
+
+
+def fill_random(n):
+    x = ti.field(dtype=ti.f32, shape=n)
+
+    @ti.kernel
+    def fill():
+        for i in x:
+            x[i] = ti.random() + ti.random()
+
+    return fill
+
+
+@ti.test(arch=[ti.cpu, ti.cuda])
+def benchmark_random_xorshift():
+    return ti.benchmark(fill_random(1024 * 1024 * 16), repeat=50)
+
+
+@ti.test(arch=[ti.cpu, ti.cuda], random_generator='philox')
+def benchmark_random_philox():
+    return ti.benchmark(fill_random(1024 * 1024 * 16), repeat=50)
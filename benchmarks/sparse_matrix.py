@@ -0,0 +1,56 @@
+import numpy as np
+
+import taichi as ti
+
+
+def build_poisson(n):
+    N = n * n
+    K = ti.linalg.SparseMatrixBuilder(N, N, max_num_triplets=N * 5)
+
+    @ti.kernel
+    def fill(A: ti.linalg.sparse_matrix_builder()):
+        for i, j in ti.ndrange(n, n):
+            row = i * n + j
+            A[row, row] += 4.0
+            if i > 0:
+                A[row, row - n] += -1.0
+            if i + 1 < n:
+                A[row, row + n] += -1.0
+            if j > 0:
+                A[row, row - 1] += -1.0
+            if j + 1 < n:
+                A[row, row + 1] += -1.0
+
+    fill(K)
+    return K.build()
+
+
+@ti.test(arch=ti.cpu)
+def benchmark_spmv():
+    A = build_poisson(1000)
+    x = np.ones(1000 * 1000, dtype=np.float32)
+
+    def spmv():
+        A @ x
+
+    return ti.benchmark(spmv, repeat=100)
+
+
+@ti.test(arch=ti.cpu)
+def benchmark_sparse_add():
+    A = build_poisson(1000)
+
+    def add():
+        A + A
+
+    return ti.benchmark(add, repeat=20)
+
+
+@ti.test(arch=ti.cpu)
+def benchmark_spmm():
+    A = build_poisson(500)
+
+    def spmm():
+        A @ A
+
+    return ti.benchmark(spmm, repeat=10)
@@ -338,7 +338,7 @@ if (NOT WIN32)
 	# OS X or BSD
     else()
         # Linux
-        target_link_libraries(${CORE_LIBRARY_NAME} stdc++fs X11)
+        target_link_libraries(${CORE_LIBRARY_NAME} stdc++fs X11 Xext)
         target_link_libraries(${CORE_LIBRARY_NAME} -static-libgcc -static-libstdc++)
         if (NOT TI_EXPORT_CORE) # expose api for CHI IR Builder
             target_link_libraries(${CORE_LIBRARY_NAME} -Wl,--version-script,${CMAKE_CURRENT_SOURCE_DIR}/misc/linker.map)
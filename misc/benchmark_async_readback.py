@@ -0,0 +1,65 @@
+import queue
+import sys
+import threading
+import time
+
+import taichi as ti
+
+# Cost of logging a field every few steps of a simulation, with synchronous
+# to_numpy() calls vs. ti.AsyncReadback and a consumer thread, e.g.
+#   python misc/benchmark_async_readback.py cuda
+arch = getattr(ti, sys.argv[1]) if len(sys.argv) > 1 else ti.cpu
+n = 2048
+num_steps = 400
+log_interval = 4
+
+ti.init(arch=arch)
+
+x = ti.field(ti.f32, shape=(n, n))
+
+
+@ti.kernel
+def step(t: ti.f32):
+    for i, j in x:
+        x[i, j] = ti.sin(x[i, j] + t * 1e-3 + i * 1e-4 + j * 1e-5)
+
+
+def log(frame):
+    frame.mean()  # Stands for writing the frame somewhere
+
+
+def synchronous():
+    for t in range(num_steps):
+        step(t)
+        if t % log_interval == 0:
+            log(x.to_numpy())
+    ti.sync()
+
+
+def asynchronous():
+    readback = ti.AsyncReadback(x)
+    futures = queue.Queue()
+
+    def consume():
+        while True:
+            future = futures.get()
+            if future is None:
+                break
+            log(future.result())
+
+    consumer = threading.Thread(target=consume)
+    consumer.start()
+    for t in range(num_steps):
+        step(t)
+        if t % log_interval == 0:
+            futures.put(readback.read())
+    futures.put(None)
+    consumer.join()
+    ti.sync()
+
+
+for name, run in [('to_numpy', synchronous), ('AsyncReadback', asynchronous)]:
+    run()  # warm up
+    t = time.time()
+    run()
+    print(f'{name:14s} {(time.time() - t) / num_steps * 1e3:8.3f}ms per step')
@@ -0,0 +1,69 @@
+import sys
+import time
+
+import taichi as ti
+
+# Time of a Laplacian stencil over a sparse grid of dense blocks on the CPU,
+# with and without caching the input in block local storage, e.g.
+#   python misc/benchmark_bls_cpu.py 2 4096 16
+#   python misc/benchmark_bls_cpu.py 3 256 8
+dim = int(sys.argv[1]) if len(sys.argv) > 1 else 2
+n = int(sys.argv[2]) if len(sys.argv) > 2 else (4096 if dim == 2 else 256)
+bs = int(sys.argv[3]) if len(sys.argv) > 3 else (16 if dim == 2 else 8)
+num_runs = 20
+
+ti.init(arch=ti.cpu)
+
+index = ti.indices(*range(dim))
+x, y, y2 = ti.field(ti.f32), ti.field(ti.f32), ti.field(ti.f32)
+for f in [x, y, y2]:
+    ti.root.pointer(index, n // bs).dense(index, bs).place(f)
+
+offsets = []
+for i in range(dim):
+    for d in [-1, 1]:
+        offsets.append(tuple(d if j == i else 0 for j in range(dim)))
+
+
+@ti.kernel
+def populate():
+    for I in ti.grouped(ti.ndrange(*[(1, n - 1)] * dim)):
+        x[I] = ti.sin(I.sum() * 0.01)
+
+
+@ti.kernel
+def laplacian(use_bls: ti.template(), y: ti.template()):
+    if ti.static(use_bls):
+        ti.block_local(x)
+    for I in ti.grouped(x):
+        s = -2.0 * dim * x[I]
+        for offset in ti.static(offsets):
+            s += x[I + ti.Vector(offset)]
+        y[I] = s
+
+
+@ti.kernel
+def max_difference() -> ti.f32:
+    d = 0.0
+    for I in ti.grouped(y):
+        ti.atomic_max(d, abs(y[I] - y2[I]))
+    return d
+
+
+def run(name, use_bls, y):
+    laplacian(use_bls, y)
+    ti.sync()
+    t = time.time()
+    for _ in range(num_runs):
+        laplacian(use_bls, y)
+    ti.sync()
+    elapsed = (time.time() - t) / num_runs
+    print(f'{name:10s} {elapsed * 1e3:8.2f}ms  '
+          f'{n**dim / elapsed * 1e-9:6.2f} G cells/s')
+
+
+populate()
+print(f'{dim}D, {n}^{dim} cells in blocks of {bs}^{dim}')
+run('global', False, y2)
+run('BLS', True, y)
+print(f'max difference {max_difference()}')
@@ -0,0 +1,28 @@
+import sys
+import time
+
+import taichi as ti
+
+# Compile time of a kernel with many common subexpressions, e.g.
+#   python misc/benchmark_cse.py 2000
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+
+ti.init(arch=ti.cpu)
+
+x = ti.field(ti.f32, shape=n)
+y = ti.field(ti.f32, shape=())
+
+
+@ti.kernel
+def many_subexpressions():
+    for _ in range(1):
+        s = 0.0
+        for i in ti.static(range(n)):
+            s += (x[i] + 1) * (x[i] + 1) + ti.sin(x[i] + 1)
+        y[None] = s
+
+
+t = time.time()
+many_subexpressions()
+print(f'{n} unrolled iterations: compiled and ran in {time.time() - t:.3f}s')
+ti.print_profile_summary()
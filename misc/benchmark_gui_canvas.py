@@ -0,0 +1,37 @@
+import sys
+import time
+
+import numpy as np
+
+import taichi as ti
+
+# Primitives per second drawn by the batched GUI canvas calls into a headless
+# window, e.g.
+#   python misc/benchmark_gui_canvas.py 1000000
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 100000
+res = 1024
+repeat = 5
+
+gui = ti.GUI('benchmark', res=res, show_gui=False)
+rng = np.random.default_rng(0)
+pos = rng.random((n, 2), dtype=np.float32)
+pos_b = pos + (rng.random((n, 2), dtype=np.float32) - 0.5) * 0.02
+pos_c = pos + (rng.random((n, 2), dtype=np.float32) - 0.5) * 0.02
+colors = rng.integers(0, 0xFFFFFF, n, dtype=np.uint32)
+
+
+def run(name, draw):
+    draw()  # warm up
+    t = time.time()
+    for _ in range(repeat):
+        gui.clear(0x112F41)
+        draw()
+    elapsed = (time.time() - t) / repeat
+    print(f'{name:10s} {elapsed * 1e3:9.2f}ms  '
+          f'{n / elapsed / 1e6:8.2f}M primitives/s')
+
+
+print(f'{n} primitives, {res}x{res} pixels')
+run('circles', lambda: gui.circles(pos, radius=1.5, color=colors))
+run('lines', lambda: gui.lines(pos, pos_b, radius=1, color=colors))
+run('triangles', lambda: gui.triangles(pos, pos_b, pos_c, color=colors))
@@ -0,0 +1,48 @@
+import os
+import resource
+import subprocess
+import sys
+import time
+
+import taichi as ti
+
+# Compile time and peak memory of a kernel with a large IR, with and without
+# the pooled allocator for IR nodes, e.g.
+#   python misc/benchmark_ir_alloc.py 2000
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+
+
+def run():
+    ti.init(arch=ti.cpu)
+
+    x = ti.field(ti.f32, shape=n)
+    y = ti.field(ti.f32, shape=())
+
+    @ti.kernel
+    def large_kernel():
+        for _ in range(1):
+            s = 0.0
+            for i in ti.static(range(n)):
+                s += x[i] * (i + 1) + ti.sqrt(x[i] * x[i] + i)
+            y[None] = s
+
+    t = time.time()
+    large_kernel()
+    elapsed = time.time() - t
+    peak_mb = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024
+    print(f'{elapsed:.3f} {peak_mb:.1f}')
+
+
+if os.environ.get('TI_BENCHMARK_IR_ALLOC_WORKER'):
+    run()
+else:
+    for enabled in ['0', '1']:
+        env = dict(os.environ,
+                   TI_SMALL_OBJECT_ALLOCATOR=enabled,
+                   TI_BENCHMARK_IR_ALLOC_WORKER='1')
+        out = subprocess.check_output([sys.executable, __file__,
+                                       str(n)],
+                                      env=env).decode().split('\n')
+        elapsed, peak_mb = out[-2].split()
+        print(f'small object allocator={enabled}: {n} unrolled iterations '
+              f'compiled and ran in {elapsed}s, peak RSS {peak_mb} MB')
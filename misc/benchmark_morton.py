@@ -0,0 +1,69 @@
+import sys
+import time
+
+import taichi as ti
+
+# Time of a 3D 7-point stencil over an n^3 grid and of transposing an m^2
+# matrix, with the fields stored in row-major order and in Morton order
+# (ti.root.dense(..., morton=True)), e.g.
+#   python misc/benchmark_morton.py 256 8192
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 256
+m = int(sys.argv[2]) if len(sys.argv) > 2 else 4096
+num_runs = 10
+
+ti.init(arch=ti.cpu)
+
+
+def make_fields(morton):
+    u = ti.field(ti.f32)
+    v = ti.field(ti.f32)
+    ti.root.dense(ti.ijk, n, morton=morton).place(u)
+    ti.root.dense(ti.ijk, n, morton=morton).place(v)
+    a = ti.field(ti.f32)
+    b = ti.field(ti.f32)
+    ti.root.dense(ti.ij, m, morton=morton).place(a)
+    ti.root.dense(ti.ij, m, morton=morton).place(b)
+    return u, v, a, b
+
+
+fields = {'row-major': make_fields(False), 'morton': make_fields(True)}
+
+
+@ti.kernel
+def fill(u: ti.template(), a: ti.template()):
+    for I in ti.grouped(u):
+        u[I] = ti.random()
+    for I in ti.grouped(a):
+        a[I] = ti.random()
+
+
+@ti.kernel
+def stencil(u: ti.template(), v: ti.template()):
+    for i, j, k in ti.ndrange((1, n - 1), (1, n - 1), (1, n - 1)):
+        v[i, j, k] = u[i - 1, j, k] + u[i + 1, j, k] + u[i, j - 1, k] + u[
+            i, j + 1, k] + u[i, j, k - 1] + u[i, j, k + 1] - 6 * u[i, j, k]
+
+
+@ti.kernel
+def transpose(a: ti.template(), b: ti.template()):
+    for i, j in a:
+        b[j, i] = a[i, j]
+
+
+def run(func, *args):
+    func(*args)
+    ti.sync()
+    t = time.time()
+    for _ in range(num_runs):
+        func(*args)
+    ti.sync()
+    return (time.time() - t) / num_runs
+
+
+print(f'stencil on {n}^3, transpose of {m}^2')
+for name, (u, v, a, b) in fields.items():
+    fill(u, a)
+    t_stencil = run(stencil, u, v)
+    t_transpose = run(transpose, a, b)
+    print(f'{name:10s} stencil {t_stencil * 1e3:8.2f}ms  '
+          f'transpose {t_transpose * 1e3:8.2f}ms')
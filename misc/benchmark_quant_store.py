@@ -0,0 +1,77 @@
+import sys
+import time
+
+import taichi as ti
+
+# Time of storing and loading n values in fp32 fields and in quantized
+# fields, e.g.
+#   python misc/benchmark_quant_store.py 16777216
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 2**24
+num_runs = 20
+
+ti.init(arch=ti.cpu)
+
+f32 = ti.field(dtype=ti.f32, shape=n)
+
+# 8 4-bit ints per 32-bit word
+ci4 = ti.quant.int(4, True)
+q4 = ti.field(dtype=ci4)
+ti.root.dense(ti.i, n // 8).bit_array(ti.i, 8, num_bits=32).place(q4)
+
+# Two 16-bit fixed-point values per 32-bit word
+cft = ti.quant.fixed(frac=16, signed=True, num_range=2.0)
+qa, qb = ti.field(dtype=cft), ti.field(dtype=cft)
+ti.root.dense(ti.i, n).bit_struct(num_bits=32).place(qa, qb)
+fa, fb = ti.field(dtype=ti.f32, shape=n), ti.field(dtype=ti.f32, shape=n)
+
+
+@ti.kernel
+def store_f32():
+    for i in range(n):
+        f32[i] = i % 16 - 8
+
+
+@ti.kernel
+def store_q4():
+    for i in range(n):
+        q4[i] = i % 16 - 8
+
+
+@ti.kernel
+def store_f32_pair():
+    for i in range(n):
+        fa[i] = (i % 7) * 0.1
+        fb[i] = (i % 5) * -0.1
+
+
+@ti.kernel
+def store_q16_pair():
+    for i in range(n):
+        qa[i] = (i % 7) * 0.1
+        qb[i] = (i % 5) * -0.1
+
+
+@ti.kernel
+def store_q16_half():
+    for i in range(n):
+        qa[i] = (i % 7) * 0.1
+
+
+def run(name, kernel, bytes_per_element):
+    kernel()
+    ti.sync()
+    t = time.time()
+    for _ in range(num_runs):
+        kernel()
+    ti.sync()
+    elapsed = (time.time() - t) / num_runs
+    print(f'{name:32s} {elapsed * 1e3:8.2f}ms  '
+          f'{n * bytes_per_element / elapsed * 1e-9:6.2f} GB/s stored')
+
+
+print(f'{n} elements')
+run('f32', store_f32, 4)
+run('4-bit int in bit_array', store_q4, 0.5)
+run('f32 pair', store_f32_pair, 8)
+run('16-bit fixed pair in bit_struct', store_q16_pair, 4)
+run('one half of the bit_struct', store_q16_half, 2)
@@ -1,6 +1,16 @@
+import sys
+
 import taichi as ti
 
-ti.init(arch=ti.cuda, async_mode=True)
+# Usage: python benchmark_rebuild_graph.py [num_tasks_per_round]
+# With num_tasks_per_round > 0, benchmarks incremental optimization instead of
+# full graph rebuilds.
+num_tasks_per_round = int(sys.argv[1]) if len(sys.argv) > 1 else 0
+
+ti.init(arch=ti.cuda,
+        async_mode=True,
+        async_flush_every=0,
+        async_opt_every=0)
 
 a = ti.field(dtype=ti.i32, shape=())
 b = ti.field(dtype=ti.i32, shape=())
@@ -23,4 +33,4 @@ def foo():
 for i in range(1000):
     foo()
 
-ti.get_runtime().prog.benchmark_rebuild_graph()
+ti.get_runtime().prog.benchmark_rebuild_graph(num_tasks_per_round)
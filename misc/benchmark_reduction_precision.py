@@ -0,0 +1,68 @@
+import sys
+import time
+
+import numpy as np
+
+import taichi as ti
+
+# Error and time of summing n f32 values with f32 accumulators, with f64
+# accumulators (ti.accumulate_in_f64), and of summing them as an f64 field, e.g.
+#   python misc/benchmark_reduction_precision.py 268435456
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 2**26
+num_runs = 10
+
+ti.init(arch=ti.cpu)
+
+x32 = ti.field(dtype=ti.f32, shape=n)
+x64 = ti.field(dtype=ti.f64, shape=n)
+tot32 = ti.field(dtype=ti.f32, shape=())
+tot32_wide = ti.field(dtype=ti.f32, shape=())
+tot64 = ti.field(dtype=ti.f64, shape=())
+
+
+@ti.kernel
+def fill():
+    for i in range(n):
+        x32[i] = ti.random() + 0.5
+        x64[i] = x32[i]
+
+
+@ti.kernel
+def sum_f32():
+    for i in range(n):
+        tot32[None] += x32[i]
+
+
+@ti.kernel
+def sum_f32_wide():
+    ti.accumulate_in_f64(tot32_wide)
+    for i in range(n):
+        tot32_wide[None] += x32[i]
+
+
+@ti.kernel
+def sum_f64():
+    for i in range(n):
+        tot64[None] += x64[i]
+
+
+def run(name, kernel, tot, bytes_per_element, exact):
+    tot[None] = 0
+    kernel()
+    error = abs(tot[None] - exact) / exact
+    ti.sync()
+    t = time.time()
+    for _ in range(num_runs):
+        kernel()
+    ti.sync()
+    elapsed = (time.time() - t) / num_runs
+    print(f'{name:20s} relative error {error:9.2e}  {elapsed * 1e3:8.2f}ms  '
+          f'{n * bytes_per_element / elapsed * 1e-9:6.2f} GB/s')
+
+
+fill()
+exact = np.sum(x32.to_numpy(), dtype=np.float64)
+print(f'{n} elements')
+run('f32', sum_f32, tot32, 4, exact)
+run('f32, f64 accumulator', sum_f32_wide, tot32_wide, 4, exact)
+run('f64', sum_f64, tot64, 8, exact)
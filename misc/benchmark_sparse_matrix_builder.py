@@ -0,0 +1,36 @@
+import sys
+import time
+
+import taichi as ti
+
+# Assembly throughput of ti.linalg.SparseMatrixBuilder.build() for the
+# stiffness matrix of an n x n grid of 4-node elements, e.g.
+#   python misc/benchmark_sparse_matrix_builder.py 1000
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 500
+
+ti.init(arch=ti.cpu)
+
+num_nodes = (n + 1) * (n + 1)
+num_triplets = n * n * 16
+Abuilder = ti.linalg.SparseMatrixBuilder(num_nodes,
+                                         num_nodes,
+                                         max_num_triplets=num_triplets)
+
+
+@ti.kernel
+def fill(Abuilder: ti.linalg.sparse_matrix_builder(), frame: ti.f32):
+    for i, j in ti.ndrange(n, n):
+        for a, b in ti.static(ti.ndrange(4, 4)):
+            row = (i + a // 2) * (n + 1) + j + a % 2
+            col = (i + b // 2) * (n + 1) + j + b % 2
+            Abuilder[row, col] += 1.0 + frame * 1e-3
+
+
+for frame in range(5):
+    fill(Abuilder, frame)
+    t = time.time()
+    A = Abuilder.build()
+    elapsed = time.time() - t
+    # The first build computes the sparsity pattern, later ones reuse it
+    print(f'frame {frame}: {num_triplets} triplets in {elapsed:.3f}s, '
+          f'{num_triplets / elapsed / 1e6:.2f}M triplets/s')
@@ -0,0 +1,70 @@
+import sys
+import time
+
+import numpy as np
+
+import taichi as ti
+
+# Per-frame cost of refactorizing a matrix whose values change but whose
+# sparsity pattern does not, with and without reusing the symbolic analysis,
+# on the 7-point Poisson problem of an n^3 grid, e.g.
+#   python misc/benchmark_sparse_refactorization.py 30
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 20
+num_frames = 10
+
+ti.init(arch=ti.cpu)
+
+N = n**3
+Abuilder = ti.linalg.SparseMatrixBuilder(N,
+                                         N,
+                                         max_num_triplets=N * 7,
+                                         dtype=ti.f64)
+
+
+@ti.kernel
+def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64),
+         frame: ti.f64):
+    for i, j, k in ti.ndrange(n, n, n):
+        row = (i * n + j) * n + k
+        Abuilder[row, row] += 6.0 + frame * 1e-2
+        if i > 0:
+            Abuilder[row, row - n * n] -= 1.0
+        if i < n - 1:
+            Abuilder[row, row + n * n] -= 1.0
+        if j > 0:
+            Abuilder[row, row - n] -= 1.0
+        if j < n - 1:
+            Abuilder[row, row + n] -= 1.0
+        if k > 0:
+            Abuilder[row, row - 1] -= 1.0
+        if k < n - 1:
+            Abuilder[row, row + 1] -= 1.0
+
+
+def run(name, reuse):
+    A = ti.linalg.SparseMatrix(N, N, dtype=ti.f64)
+    solver = ti.linalg.SparseSolver(dtype=ti.f64, solver_type='LLT')
+    b = np.ones(N)
+    t_build = t_factorize = t_solve = 0
+    for frame in range(num_frames):
+        fill(Abuilder, frame)
+        t = time.time()
+        Abuilder.build_into(A)
+        t_build += time.time() - t
+        t = time.time()
+        if not reuse:
+            solver.analyze_pattern(A)
+        solver.factorize(A)
+        t_factorize += time.time() - t
+        t = time.time()
+        solver.solve(b)
+        t_solve += time.time() - t
+    print(f'{name:20s} per frame: build {t_build / num_frames * 1e3:8.2f}ms  '
+          f'factorize {t_factorize / num_frames * 1e3:8.2f}ms  '
+          f'solve {t_solve / num_frames * 1e3:8.2f}ms  '
+          f'({solver.num_analyses()} analyses)')
+
+
+print(f'{N} unknowns, {num_frames} frames')
+run('analyze every frame', reuse=False)
+run('reuse analysis', reuse=True)
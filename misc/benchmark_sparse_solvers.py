@@ -0,0 +1,98 @@
+import sys
+import time
+
+import numpy as np
+
+import taichi as ti
+
+# Direct vs. iterative solvers on the 7-point Poisson problem of an n^3 grid,
+# e.g.
+#   python misc/benchmark_sparse_solvers.py 40
+n = int(sys.argv[1]) if len(sys.argv) > 1 else 24
+
+ti.init(arch=ti.cpu)
+
+N = n**3
+Abuilder = ti.linalg.SparseMatrixBuilder(N,
+                                         N,
+                                         max_num_triplets=N * 7,
+                                         dtype=ti.f64)
+
+
+@ti.kernel
+def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64)):
+    for i, j, k in ti.ndrange(n, n, n):
+        row = (i * n + j) * n + k
+        Abuilder[row, row] += 6.0
+        if i > 0:
+            Abuilder[row, row - n * n] -= 1.0
+        if i < n - 1:
+            Abuilder[row, row + n * n] -= 1.0
+        if j > 0:
+            Abuilder[row, row - n] -= 1.0
+        if j < n - 1:
+            Abuilder[row, row + n] -= 1.0
+        if k > 0:
+            Abuilder[row, row - 1] -= 1.0
+        if k < n - 1:
+            Abuilder[row, row + 1] -= 1.0
+
+
+@ti.kernel
+def matvec(x: ti.any_arr(), y: ti.any_arr()):
+    for i, j, k in ti.ndrange(n, n, n):
+        row = (i * n + j) * n + k
+        r = 6.0 * x[row]
+        if i > 0:
+            r -= x[row - n * n]
+        if i < n - 1:
+            r -= x[row + n * n]
+        if j > 0:
+            r -= x[row - n]
+        if j < n - 1:
+            r -= x[row + n]
+        if k > 0:
+            r -= x[row - 1]
+        if k < n - 1:
+            r -= x[row + 1]
+        y[row] = r
+
+
+fill(Abuilder)
+A = Abuilder.build()
+b = np.ones(N)
+
+
+def report(name, setup, solve):
+    t = time.time()
+    setup()
+    t_setup = time.time() - t
+    t = time.time()
+    x = solve()
+    t_solve = time.time() - t
+    residual = np.linalg.norm(A @ x - b) / np.linalg.norm(b)
+    print(f'{name:24s} setup {t_setup:7.3f}s  solve {t_solve:7.3f}s  '
+          f'residual {residual:.2e}')
+
+
+print(f'{N} unknowns')
+for solver_type in ['LLT', 'LDLT']:
+    solver = ti.linalg.SparseSolver(dtype=ti.f64, solver_type=solver_type)
+    report(solver_type, lambda: solver.compute(A), lambda: solver.solve(b))
+
+for solver_type in ['CG', 'MINRES', 'BiCGSTAB']:
+    for preconditioner in ['none', 'Jacobi', 'IC']:
+        solver = ti.linalg.IterativeSolver(dtype=ti.f64,
+                                           solver_type=solver_type,
+                                           preconditioner=preconditioner,
+                                           tolerance=1e-8)
+        report(f'{solver_type} {preconditioner}', lambda: solver.compute(A),
+               lambda: solver.solve(b))
+
+solver = ti.linalg.IterativeSolver(dtype=ti.f64,
+                                   solver_type='CG',
+                                   preconditioner='Jacobi',
+                                   tolerance=1e-8)
+report('CG Jacobi (matrix-free)',
+       lambda: solver.set_operator(N, matvec, diagonal=np.full(N, 6.0)),
+       lambda: solver.solve(b))
@@ -0,0 +1,58 @@
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+import taichi as ti
+
+# Time to turn rendered frames into an mp4 video, writing PNG frames for
+# ffmpeg (ti.VideoManager) vs. streaming raw frames into it (ti.VideoWriter),
+# e.g.
+#   python misc/benchmark_video_writer.py 1920 1080 120
+width, height, num_frames = (int(a) for a in sys.argv[1:4]) if len(
+    sys.argv) > 3 else (1280, 720, 60)
+
+ti.init(arch=ti.cpu)
+
+pixels = ti.Vector.field(3, ti.f32, shape=(width, height))
+
+
+@ti.kernel
+def render(t: ti.f32):
+    for i, j in pixels:
+        u, v = i / width, j / height
+        pixels[i, j] = ti.Vector([
+            0.5 + 0.5 * ti.sin(10 * u + t), 0.5 + 0.5 * ti.cos(10 * v + t),
+            0.5 + 0.5 * ti.sin(10 * (u + v) - t)
+        ])
+
+
+def run(name, write):
+    directory = tempfile.mkdtemp()
+    t = time.time()
+    write(directory)
+    elapsed = time.time() - t
+    shutil.rmtree(directory)
+    print(f'{name:14s} {elapsed:7.2f}s  {num_frames / elapsed:7.2f} frames/s')
+
+
+def png_frames(directory):
+    video = ti.VideoManager(directory, framerate=24, automatic_build=False)
+    for frame in range(num_frames):
+        render(frame * 0.1)
+        video.write_frame(pixels.to_numpy())
+    video.make_video(gif=False)
+
+
+def streaming(directory):
+    with ti.VideoWriter(os.path.join(directory, 'video.mp4'),
+                        framerate=24) as video:
+        for frame in range(num_frames):
+            render(frame * 0.1)
+            video.write_frame(pixels)
+
+
+print(f'{num_frames} frames of {width}x{height}')
+run('VideoManager', png_frames)
+run('VideoWriter', streaming)
@@ -38,6 +38,7 @@ from taichi.lang.mesh import Mesh, MeshElementFieldProxy, TetMesh, TriMesh
 from taichi.lang.ndrange import GroupedNDRange, ndrange
 from taichi.lang.ops import *  # pylint: disable=W0622
 from taichi.lang.quant_impl import quant
+from taichi.lang.readback import AsyncReadback, ReadbackFuture
 from taichi.lang.runtime_ops import async_flush, sync
 from taichi.lang.snode import SNode
 from taichi.lang.source_builder import SourceBuilder
@@ -612,6 +613,24 @@ def cache_read_only(*args):
                 _ti_core.SNodeAccessFlag.read_only, v.ptr)
 
 
+def accumulate_in_f64(*args):
+    """Hints Taichi to accumulate the sums into the fields in f64.
+
+    This applies to the reductions of the following loop into 0-D real fields
+    with fewer than 64 bits, e.g. `total[None] += x[i]` with `total` in f32.
+    Each thread then sums its part in f64, and rounds it only once when adding
+    it to the field. This is only effective on backends with thread-local
+    reductions (CPU and CUDA).
+
+    Args:
+        *args (List[Field]): A list of 0-D Taichi fields.
+    """
+    for a in args:
+        for v in a.get_field_members():
+            _ti_core.insert_snode_access_flag(
+                _ti_core.SNodeAccessFlag.f64_accumulator, v.ptr)
+
+
 def assume_in_range(val, base, low, high):
     return _ti_core.expr_assume_in_range(
         Expr(val).ptr,
@@ -4,34 +4,40 @@ from taichi.lang.any_array import AnyArray
 from taichi.lang.enums import Layout
 from taichi.lang.expr import Expr
 from taichi.lang.util import cook_dtype
-from taichi.type.primitive_types import u64
+from taichi.type.primitive_types import f32, f64, u64
 
 
 class SparseMatrixEntry:
-    def __init__(self, ptr, i, j):
+    def __init__(self, ptr, i, j, dtype):
         self.ptr = ptr
         self.i = i
         self.j = j
+        self.dtype = dtype
 
     def augassign(self, value, op):
+        if self.dtype == f64:
+            func_name = "insert_triplet_f64"
+            value = taichi.lang.ops.cast(value, f64)
+        else:
+            func_name = "insert_triplet"
+            value = taichi.lang.ops.cast(value, f32)
         if op == 'Add':
-            taichi.lang.impl.call_internal("insert_triplet", self.ptr, self.i,
-                                           self.j,
-                                           taichi.lang.impl.ti_float(value))
+            taichi.lang.impl.call_internal(func_name, self.ptr, self.i, self.j,
+                                           value)
         elif op == 'Sub':
-            taichi.lang.impl.call_internal("insert_triplet", self.ptr, self.i,
-                                           self.j,
-                                           -taichi.lang.impl.ti_float(value))
+            taichi.lang.impl.call_internal(func_name, self.ptr, self.i, self.j,
+                                           -value)
         else:
             assert False, f"Only operations '+=' and '-=' are supported on sparse matrices."
 
 
 class SparseMatrixProxy:
-    def __init__(self, ptr):
+    def __init__(self, ptr, dtype=f32):
         self.ptr = ptr
+        self.dtype = dtype
 
     def subscript(self, i, j):
-        return SparseMatrixEntry(self.ptr, i, j)
+        return SparseMatrixEntry(self.ptr, i, j, self.dtype)
 
 
 def decl_scalar_arg(dtype):
@@ -40,11 +46,12 @@ def decl_scalar_arg(dtype):
     return Expr(_ti_core.make_arg_load_expr(arg_id, dtype))
 
 
-def decl_sparse_matrix():
+def decl_sparse_matrix(dtype=f32):
     ptr_type = cook_dtype(u64)
     # Treat the sparse matrix argument as a scalar since we only need to pass in the base pointer
     arg_id = _ti_core.decl_arg(ptr_type, False)
-    return SparseMatrixProxy(_ti_core.make_arg_load_expr(arg_id, ptr_type))
+    return SparseMatrixProxy(_ti_core.make_arg_load_expr(arg_id, ptr_type),
+                             dtype)
 
 
 def decl_any_arr_arg(dtype, dim, element_shape, layout):
@@ -499,6 +499,13 @@ class Kernel:
                         raise KernelArgError(i, needed.to_string(), provided)
                     launch_ctx.set_arg_int(actual_argument_slot, int(v))
                 elif isinstance(needed, sparse_matrix_builder):
+                    # The triplets are written according to the annotated dtype
+                    if v.dtype != needed.dtype:
+                        raise KernelArgError(
+                            i,
+                            f'sparse_matrix_builder(dtype={needed.dtype.to_string()})',
+                            f'sparse_matrix_builder(dtype={v.dtype.to_string()})'
+                        )
                     # Pass only the base pointer of the ti.linalg.sparse_matrix_builder() argument
                     launch_ctx.set_arg_int(actual_argument_slot, v.get_addr())
                 elif isinstance(needed, any_arr) and (
@@ -1,4 +1,5 @@
 import json
+import os
 
 import numpy as np
 from taichi.core.util import ti_core as _ti_core
@@ -294,10 +295,7 @@ class MeshInstance:
 
 
 class MeshMetadata:
-    def __init__(self, filename):
-        with open(filename, "r") as fi:
-            data = json.loads(fi.read())
-
+    def __init__(self, data):
         self.num_patches = data["num_patches"]
 
         self.element_fields = {}
@@ -447,7 +445,49 @@ class Mesh:
 
     @staticmethod
     def load_meta(filename):
-        return MeshMetadata(filename)
+        with open(filename, "r") as fi:
+            data = json.loads(fi.read())
+        return MeshMetadata(data)
+
+    @staticmethod
+    def generate_meta(vertices,
+                      indices,
+                      patch_size=256,
+                      relations=None,
+                      num_threads=None):
+        """Builds the mesh metadata from raw arrays, without an external
+        preprocessing tool.
+
+        Args:
+            vertices (numpy.ndarray): Vertex positions of shape (n, 3).
+            indices (numpy.ndarray): Vertex indices of the triangles or
+                tetrahedra, of shape (m, 3) or (m, 4).
+            patch_size (int): Maximum number of triangles or tetrahedra
+                owned by a patch.
+            relations (List[MeshRelationType], optional): Relations to
+                build. All the relations of the mesh if not specified.
+            num_threads (int, optional): Number of threads used. Defaults
+                to the number of CPUs.
+
+        Returns:
+            MeshMetadata: The metadata to be passed to `MeshBuilder.build()`.
+        """
+        indices = np.asarray(indices)
+        assert indices.ndim == 2 and indices.shape[1] in (3, 4)
+        topology = MeshTopology.Triangle if indices.shape[
+            1] == 3 else MeshTopology.Tetrahedron
+        top_order = indices.shape[1] - 1
+        if relations is None:
+            relations = [
+                relation_by_orders(i, j) for i in range(top_order + 1)
+                for j in range(top_order + 1)
+            ]
+        vertices = np.asarray(vertices)
+        data = _ti_core.build_mesh_patches(topology, vertices.shape[0],
+                                           indices, relations, patch_size,
+                                           num_threads or os.cpu_count())
+        data["attrs"] = {"x": vertices}
+        return MeshMetadata(data)
 
 
 def TriMesh():
@@ -2,7 +2,7 @@ from taichi.core import get_os_name
 from taichi.lang import impl
 from taichi.lang.expr import Expr
 from taichi.lang.field import ScalarField
-from taichi.lang.kernel_impl import kernel
+from taichi.lang.kernel_impl import func, kernel
 from taichi.type.annotations import any_arr, ext_arr, template
 
 import taichi as ti
@@ -78,6 +78,59 @@ def vector_to_fast_image(img: template(), out: ext_arr()):
             out[idx] = (b << 16) + (g << 8) + r + alpha
 
 
+@func
+def to_video_channel(c, is_float: template()):
+    # Rounds like ti.imwrite
+    v = 0
+    if ti.static(is_float):
+        v = int(ti.min(ti.max(c, 0.0), 1.0) * 255 + 0.5)
+    else:
+        v = int(c)
+    return v
+
+
+@func
+def to_video_pixel(r, g, b, is_float: template()):
+    # rgb0 bytes in little-endian order
+    return (to_video_channel(b, is_float) << 16) + (
+        to_video_channel(g, is_float) << 8) + to_video_channel(r, is_float)
+
+
+# |out| is a (height, width) i32 array of rgb0 pixels with rows from the top.
+# |layout| is 'grey' for 2D scalar images, 'vector' for 2D vector images and
+# 'channels' for 3D scalar images, whose last dimension is the channel.
+@kernel
+def image_to_video_frame(img: template(), out: ext_arr(), layout: template(),
+                         is_float: template()):
+    for j, i in ti.ndrange(out.shape[0], out.shape[1]):
+        y = out.shape[0] - 1 - j
+        if ti.static(layout == 'grey'):
+            out[j, i] = to_video_pixel(img[i, y], img[i, y], img[i, y],
+                                       is_float)
+        elif ti.static(layout == 'vector'):
+            out[j, i] = to_video_pixel(img[i, y][0], img[i, y][1],
+                                       img[i, y][2], is_float)
+        else:
+            out[j, i] = to_video_pixel(img[i, y, 0], img[i, y, 1],
+                                       img[i, y, 2], is_float)
+
+
+@kernel
+def ndarray_to_video_frame(ndarray: any_arr(), out: ext_arr(),
+                           layout: template(), is_float: template()):
+    for j, i in ti.ndrange(out.shape[0], out.shape[1]):
+        y = out.shape[0] - 1 - j
+        if ti.static(layout == 'grey'):
+            out[j, i] = to_video_pixel(ndarray[i, y], ndarray[i, y],
+                                       ndarray[i, y], is_float)
+        elif ti.static(layout == 'vector'):
+            out[j, i] = to_video_pixel(ndarray[i, y][0], ndarray[i, y][1],
+                                       ndarray[i, y][2], is_float)
+        else:
+            out[j, i] = to_video_pixel(ndarray[i, y, 0], ndarray[i, y, 1],
+                                       ndarray[i, y, 2], is_float)
+
+
 @kernel
 def tensor_to_image(tensor: template(), arr: ext_arr()):
     for I in ti.grouped(tensor):
@@ -96,6 +149,20 @@ def vector_to_image(mat: template(), arr: ext_arr()):
                 arr[I, 2] = 0
 
 
+@kernel
+def tensor_to_ndarray(tensor: template(), ndarray: any_arr()):
+    for I in ti.grouped(tensor):
+        ndarray[I] = tensor[I]
+
+
+@kernel
+def matrix_to_ndarray(mat: template(), ndarray: any_arr()):
+    for I in ti.grouped(mat):
+        for p in ti.static(range(mat.n)):
+            for q in ti.static(range(mat.m)):
+                ndarray[I][p, q] = mat[I][p, q]
+
+
 @kernel
 def tensor_to_tensor(tensor: template(), other: template()):
     for I in ti.grouped(tensor):
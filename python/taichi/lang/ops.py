@@ -391,6 +391,11 @@ def logical_not(a):
 def random(dtype=float):
     """The random function.
 
+    With ``ti.init(random_generator='philox')`` (CPU and CUDA), the random numbers are drawn from a
+    counter-based generator keyed by the random seed, the kernel launch, the loop iteration and the
+    number of random numbers drawn so far in the iteration, so that they do not depend on the number
+    of threads or the scheduling.
+
     Args:
         dtype (DataType): Type of the random variable.
 
@@ -0,0 +1,137 @@
+import ctypes
+import threading
+
+import numpy as np
+from taichi.core.util import ti_core as _ti_core
+from taichi.lang import impl, meta
+from taichi.lang._ndarray import Ndarray, ScalarNdarray
+from taichi.lang.enums import Layout
+from taichi.lang.field import ScalarField
+from taichi.lang.matrix import MatrixField, MatrixNdarray
+from taichi.lang.util import python_scope, to_numpy_type
+
+
+class ReadbackFuture:
+    """The pending result of :func:`AsyncReadback.read`.
+
+    Attributes:
+        frame (int): Index of the read, counting from 0.
+    """
+    def __init__(self, readback, buffer, frame, result=None):
+        self._readback = readback
+        self._buffer = buffer
+        self._result = result
+        self._lock = threading.Lock()
+        self.frame = frame
+
+    def result(self):
+        """Waits for the copy to finish and returns it.
+
+        This can be called from any thread, and returns the same array when
+        called again.
+
+        Returns:
+            numpy.ndarray: The contents of the source at the time of the read,
+            shaped like the result of `to_numpy()`.
+        """
+        with self._lock:
+            if self._buffer is not None:
+                self._result = self._readback._collect(self._buffer)
+                self._buffer = None
+            return self._result
+
+    def __del__(self):
+        # Futures dropped without a result still return their buffer
+        if self._buffer is not None:
+            self._readback._release(self._buffer)
+
+
+class AsyncReadback:
+    """Reads a field or ndarray back to the host without waiting for it.
+
+    Each :func:`read` copies the source into the next buffer of a ring of
+    `num_buffers` host buffers and returns a :class:`ReadbackFuture`. On
+    CUDA, the buffers are pinned and the copy is enqueued behind the kernels
+    launched so far, so the caller can keep launching kernels while it is in
+    flight. The future's result can be picked up later, e.g. by a logging
+    thread. A read waits for the future of the read `num_buffers` reads ago
+    to release its buffer, which happens when its result is taken or the
+    future is dropped.
+
+    On backends other than CPU and CUDA, reads fall back to `to_numpy()`.
+
+    Args:
+        source (Union[ti.field, ti.Vector.field, ti.Matrix.field, ti.ndarray]):
+            The field or ndarray to read.
+        num_buffers (int, optional): Number of reads that can be in flight.
+            Default is 3.
+
+    Example::
+
+        >>> readback = ti.AsyncReadback(pixels)
+        >>> for step in range(1000):
+        >>>     substep()
+        >>>     if step % 10 == 0:
+        >>>         frames.put(readback.read())  # Consumed by another thread
+    """
+    def __init__(self, source, num_buffers=3):
+        assert isinstance(source, (ScalarField, MatrixField, Ndarray)), \
+            f"AsyncReadback only takes a Taichi field or ndarray, not {type(source)}"
+        self.source = source
+        self.num_buffers = num_buffers
+        self.dtype = to_numpy_type(source.dtype)
+        self._staging = None
+        if isinstance(source, Ndarray):
+            self.shape = tuple(source.arr.shape)
+        elif isinstance(source, ScalarField):
+            self.shape = source.shape
+            self._staging = ScalarNdarray(source.dtype, source.shape)
+        else:
+            self.shape = source.shape + ((source.n, ) if source.m == 1 else
+                                         (source.n, source.m))
+            self._staging = MatrixNdarray(source.n, source.m, source.dtype,
+                                          source.shape, Layout.AOS)
+        arch = impl.current_cfg().arch
+        self._readback = None
+        if arch in [
+                _ti_core.Arch.x64, _ti_core.Arch.arm64, _ti_core.Arch.cuda
+        ]:
+            size = int(np.prod(self.shape)) * np.dtype(self.dtype).itemsize
+            self._readback = _ti_core.AsyncReadback(arch, size, num_buffers)
+        self._released = [threading.Event() for _ in range(num_buffers)]
+        for released in self._released:
+            released.set()
+        self._frame = 0
+
+    @python_scope
+    def read(self):
+        """Enqueues a copy of the source into the next buffer.
+
+        Returns:
+            ReadbackFuture: The future of the copy.
+        """
+        frame = self._frame
+        self._frame += 1
+        if self._readback is None:
+            return ReadbackFuture(self, None, frame, self.source.to_numpy())
+        buffer = frame % self.num_buffers
+        self._released[buffer].wait()
+        self._released[buffer].clear()
+        if isinstance(self.source, ScalarField):
+            meta.tensor_to_ndarray(self.source, self._staging)
+        elif isinstance(self.source, MatrixField):
+            meta.matrix_to_ndarray(self.source, self._staging)
+        src = self.source if self._staging is None else self._staging
+        self._readback.enqueue(buffer, src.data_handle)
+        return ReadbackFuture(self, buffer, frame)
+
+    def _collect(self, buffer):
+        ptr = self._readback.wait(buffer)
+        data = (ctypes.c_char * self._readback.size()).from_address(ptr)
+        result = np.frombuffer(data, dtype=self.dtype).reshape(
+            self.shape).copy()
+        self._release(buffer)
+        return result
+
+    def _release(self, buffer):
+        self._released[buffer].set()
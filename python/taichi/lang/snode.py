@@ -26,21 +26,30 @@ class SNode:
     def __init__(self, ptr):
         self.ptr = ptr
 
-    def dense(self, axes, dimensions):
+    def dense(self, axes, dimensions, morton=False):
         """Adds a dense SNode as a child component of `self`.
 
         Args:
             axes (List[Axis]): Axes to activate.
             dimensions (Union[List[int], int]): Shape of each axis.
+            morton (bool): Whether to store the cells in Morton (Z) order
+                instead of row-major order, which keeps cells that are close
+                in any direction close in memory. Not supported in packed
+                mode.
 
         Returns:
             The added :class:`~taichi.lang.SNode` instance.
         """
         if isinstance(dimensions, int):
             dimensions = [dimensions] * len(axes)
-        return SNode(
-            self.ptr.dense(axes, dimensions,
-                           impl.current_cfg().packed))
+        packed = impl.current_cfg().packed
+        if morton and packed:
+            raise RuntimeError(
+                'Morton-ordered dense SNodes are not supported in packed mode')
+        snode = self.ptr.dense(axes, dimensions, packed)
+        if morton:
+            snode.morton(True)
+        return SNode(snode)
 
     def pointer(self, axes, dimensions):
         """Adds a pointer SNode as a child component of `self`.
@@ -144,7 +153,8 @@ class SNode:
         Args:
             *args (List[ti.field]): A list of Taichi fields to place.
             offset (Union[Number, tuple[Number]]): Offset of the field domain.
-            shared_exponent (bool): Only useful for quant types.
+            shared_exponent (bool): Only useful for quant types. Under a
+                bit_array, the elements of each container share one exponent.
 
         Returns:
             The `self` container.
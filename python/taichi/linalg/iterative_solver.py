@@ -0,0 +1,132 @@
+import ctypes
+
+import numpy as np
+import taichi.lang
+from taichi.core.util import ti_core as _ti_core
+from taichi.lang._ndarray import Ndarray
+from taichi.lang.util import to_numpy_type
+from taichi.linalg.sparse_matrix import SparseMatrix
+from taichi.type.primitive_types import f32, f64
+
+
+class IterativeSolver:
+    """Iterative sparse linear system solver
+
+    Krylov subspace solvers running on the CPU thread pool. The system is given either by a
+    sparse matrix, or by a matrix-vector product (matrix-free).
+
+    Args:
+        dtype (DataType): The data type of the system, ti.f32 or ti.f64.
+        solver_type (str): "CG" for symmetric positive definite systems, "BiCGSTAB" for general
+            systems, or "MINRES" for symmetric indefinite systems.
+        preconditioner (str): "none", "Jacobi", or "IC" (zero fill-in incomplete Cholesky, which
+            needs a sparse matrix).
+        max_iterations (int): The maximum number of iterations.
+        tolerance (float): The relative residual to reach.
+    """
+    def __init__(self,
+                 dtype=f32,
+                 solver_type="CG",
+                 preconditioner="Jacobi",
+                 max_iterations=1000,
+                 tolerance=1e-6):
+        solver_type_list = ["CG", "BiCGSTAB", "MINRES"]
+        preconditioner_list = ["none", "Jacobi", "IC"]
+        assert solver_type in solver_type_list and preconditioner in preconditioner_list, f"The solver type {solver_type} with {preconditioner} is not supported for now. Only {solver_type_list} with {preconditioner_list} are supported."
+        taichi_arch = taichi.lang.impl.get_runtime().prog.config.arch
+        assert taichi_arch == _ti_core.Arch.x64 or taichi_arch == _ti_core.Arch.arm64, "IterativeSolver only supports CPU for now."
+        self.dtype = dtype
+        self.n = None
+        self.solver = _ti_core.make_iterative_solver(dtype, solver_type,
+                                                     preconditioner,
+                                                     max_iterations, tolerance)
+
+    def compute(self, sparse_matrix):
+        """Uses a sparse matrix as the operator, and builds the preconditioner from it.
+
+        Args:
+            sparse_matrix (SparseMatrix): The matrix of the system, of the dtype of the solver.
+        """
+        assert isinstance(
+            sparse_matrix, SparseMatrix
+        ), f"The parameter type: {type(sparse_matrix)} is not supported in linear solvers for now."
+        self.solver.compute(sparse_matrix.matrix)
+        self.n = sparse_matrix.n
+
+    def set_operator(self, n, matvec, diagonal=None):
+        """Uses a matrix-vector product as the operator (matrix-free).
+
+        Args:
+            n (int): The size of the system.
+            matvec (Callable): Called as ``matvec(x, y)`` to compute ``y = A x``. x and y are numpy
+                arrays sharing memory with the solver, so that a Taichi kernel taking two
+                ``ti.any_arr()`` arguments accesses them without copies.
+            diagonal (numpy.array, optional): The diagonal of A, needed by the Jacobi preconditioner.
+        """
+        ctype = ctypes.c_double if self.dtype == f64 else ctypes.c_float
+
+        def wrapped_matvec(x_ptr, y_ptr):
+            x = np.ctypeslib.as_array((ctype * n).from_address(x_ptr))
+            y = np.ctypeslib.as_array((ctype * n).from_address(y_ptr))
+            matvec(x, y)
+
+        diagonal_ptr = 0
+        if diagonal is not None:
+            diagonal = np.ascontiguousarray(diagonal,
+                                            dtype=to_numpy_type(self.dtype))
+            assert diagonal.shape == (n, )
+            diagonal_ptr = diagonal.ctypes.data
+        self.solver.set_operator(n, wrapped_matvec, diagonal_ptr)
+        self.n = n
+
+    def solve(self, b, x=None):
+        """Solves the linear system, starting from the values of x.
+
+        Args:
+            b (numpy.array, Field or Ndarray): The right-hand side of the linear system.
+            x (numpy.array, Field or Ndarray, optional): The initial guess, overwritten by the
+                solution. A numpy array or an Ndarray of the dtype of the solver is updated in
+                place. Zero by default.
+
+        Returns:
+            The solution x, as a numpy array if x is not given.
+        """
+        np_type = to_numpy_type(self.dtype)
+        if isinstance(b, (taichi.lang.Field, Ndarray)):
+            b = b.to_numpy()
+        b = np.ascontiguousarray(b, dtype=np_type)
+        assert b.shape == (
+            self.n, ), f"Shape mismatch between the system ({self.n}) and b {b.shape}"
+        if x is None:
+            x = np.zeros_like(b)
+        assert tuple(
+            x.shape) == b.shape, f"Shape mismatch between b {b.shape} and x {x.shape}"
+        if isinstance(x, np.ndarray):
+            assert x.dtype == np_type and x.flags.c_contiguous, f"The solution array must be a contiguous array of {np_type}"
+            self.solver.solve(b.ctypes.data, x.ctypes.data)
+        elif isinstance(x, Ndarray):
+            assert x.dtype == self.dtype, f"The solution ndarray has dtype {x.dtype}, but the solver has dtype {self.dtype}."
+            self.solver.solve(b.ctypes.data, x.data_handle)
+        elif isinstance(x, taichi.lang.Field):
+            x_np = np.ascontiguousarray(x.to_numpy(), dtype=np_type)
+            self.solver.solve(b.ctypes.data, x_np.ctypes.data)
+            x.from_numpy(x_np)
+        else:
+            assert False, f"The solution type: {type(x)} is not supported in linear solvers for now."
+        return x
+
+    def num_iterations(self):
+        """The number of iterations of the last solve."""
+        return self.solver.num_iterations()
+
+    def residual(self):
+        """The relative residual norm reached by the last solve."""
+        return self.solver.residual()
+
+    def info(self):
+        """Check if the last solve reached the tolerance.
+
+        Returns:
+            bool: True if the solving process succeeded, False otherwise.
+        """
+        return self.solver.info()
@@ -1,7 +1,8 @@
 import numpy as np
 from taichi.core.util import ti_core as _ti_core
 from taichi.lang.field import Field
-from taichi.type.primitive_types import f32
+from taichi.lang.util import to_numpy_type
+from taichi.type.primitive_types import f32, i32
 
 
 class SparseMatrix:
@@ -13,16 +14,27 @@ class SparseMatrix:
         n (int): the first dimension of a sparse matrix.
         m (int): the second dimension of a sparse matrix.
         sm (SparseMatrix): another sparse matrix that will be built from.
+        dtype (DataType): the data type of the entries, ti.f32 or ti.f64.
+        index_dtype (DataType): the type of the storage indices, ti.i32 or ti.i64.
     """
-    def __init__(self, n=None, m=None, sm=None, dtype=f32):
+    def __init__(self, n=None, m=None, sm=None, dtype=f32, index_dtype=i32):
         if sm is None:
             self.n = n
             self.m = m if m else n
-            self.matrix = _ti_core.create_sparse_matrix(n, m)
+            self.matrix = _ti_core.create_sparse_matrix(
+                n, self.m, dtype, index_dtype)
         else:
             self.n = sm.num_rows()
             self.m = sm.num_cols()
             self.matrix = sm
+        self.dtype = self.matrix.get_data_type()
+        self.index_dtype = self.matrix.get_index_type()
+
+    def to_numpy_vector(self, v):
+        """Converts a vector to a numpy array of the data type of the matrix."""
+        if isinstance(v, Field):
+            v = v.to_numpy()
+        return np.ascontiguousarray(v, dtype=to_numpy_type(self.dtype))
 
     def __add__(self, other):
         """Addition operation for sparse matrix.
@@ -100,11 +112,11 @@ class SparseMatrix:
         if isinstance(other, Field):
             assert self.m == other.shape[
                 0], f"Dimension mismatch between sparse matrix ({self.n}, {self.m}) and vector ({other.shape})"
-            return self.matrix.mat_vec_mul(other.to_numpy())
+            return self.matrix.mat_vec_mul(self.to_numpy_vector(other))
         if isinstance(other, np.ndarray):
             assert self.m == other.shape[
                 0], f"Dimension mismatch between sparse matrix ({self.n}, {self.m}) and vector ({other.shape})"
-            return self.matrix.mat_vec_mul(other)
+            return self.matrix.mat_vec_mul(self.to_numpy_vector(other))
         assert False, f"Sparse matrix-matrix/vector multiplication does not support {type(other)} for now. Supported types are SparseMatrix, ti.field, and numpy.ndarray."
 
     def __getitem__(self, indices):
@@ -130,17 +142,23 @@ class SparseMatrixBuilder:
         num_rows (int): the first dimension of a sparse matrix.
         num_cols (int): the second dimension of a sparse matrix.
         max_num_triplets (int): the maximum number of triplets.
+        dtype (DataType): the data type of the triplets and of the built matrix, ti.f32 or ti.f64.
+            As a kernel argument annotation, ``sparse_matrix_builder(dtype=ti.f64)`` accepts f64 builders.
+        index_dtype (DataType): the type of the storage indices of the built matrix, ti.i32 or ti.i64.
     """
     def __init__(self,
                  num_rows=None,
                  num_cols=None,
                  max_num_triplets=0,
-                 dtype=f32):
+                 dtype=f32,
+                 index_dtype=i32):
         self.num_rows = num_rows
         self.num_cols = num_cols if num_cols else num_rows
+        self.dtype = dtype
+        self.index_dtype = index_dtype
         if num_rows is not None:
             self.ptr = _ti_core.create_sparse_matrix_builder(
-                num_rows, num_cols, max_num_triplets)
+                num_rows, self.num_cols, max_num_triplets, dtype, index_dtype)
 
     def get_addr(self):
         """Get the address of the sparse matrix"""
@@ -150,11 +168,33 @@ class SparseMatrixBuilder:
         """Print the triplets stored in the builder"""
         self.ptr.print_triplets()
 
-    def build(self, dtype=f32, _format='CSR'):
-        """Create a sparse matrix using the triplets"""
-        sm = self.ptr.build()
+    def build(self, dtype=None, index_dtype=None, _format='CSR'):
+        """Create a sparse matrix using the triplets
+
+        Args:
+            dtype (DataType): the data type of the matrix, the dtype of the builder by default.
+            index_dtype (DataType): the index type of the matrix, the index_dtype of the builder by default.
+        """
+        sm = self.ptr.build(self.dtype if dtype is None else dtype,
+                            self.index_dtype
+                            if index_dtype is None else index_dtype)
         return SparseMatrix(sm=sm)
 
+    def build_into(self, sparse_matrix):
+        """Build the sparse matrix into an existing one in place, e.g. to refill the same matrix every frame.
+
+        If the triplets have the sparsity pattern of the matrix, only its values change, and sparse solvers reuse
+        their analysis of the pattern.
+
+        Args:
+            sparse_matrix (SparseMatrix): the matrix to overwrite, of the shape of the builder.
+
+        Returns:
+            SparseMatrix: `sparse_matrix`.
+        """
+        self.ptr.build_into(sparse_matrix.matrix)
+        return sparse_matrix
+
 
 sparse_matrix_builder = SparseMatrixBuilder
 # Alias for :class:`SparseMatrixBuilder`
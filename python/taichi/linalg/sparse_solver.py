@@ -1,8 +1,10 @@
 import numpy as np
 import taichi.lang
 from taichi.core.util import ti_core as _ti_core
+from taichi.lang._ndarray import Ndarray
+from taichi.lang.util import to_numpy_type
 from taichi.linalg import SparseMatrix
-from taichi.type.primitive_types import f32
+from taichi.type.primitive_types import f32, i32
 
 
 class SparseSolver:
@@ -11,16 +13,24 @@ class SparseSolver:
     Use this class to solve linear systems represented by sparse matrices.
 
     Args:
+        dtype (DataType): The data type of the matrices to solve, ti.f32 or ti.f64.
         solver_type (str): The factorization type.
         ordering (str): The method for matrices re-ordering.
+        index_dtype (DataType): The index type of the matrices to solve, ti.i32 or ti.i64.
     """
-    def __init__(self, dtype=f32, solver_type="LLT", ordering="AMD"):
+    def __init__(self,
+                 dtype=f32,
+                 solver_type="LLT",
+                 ordering="AMD",
+                 index_dtype=i32):
         solver_type_list = ["LLT", "LDLT", "LU"]
         solver_ordering = ['AMD', 'COLAMD']
         if solver_type in solver_type_list and ordering in solver_ordering:
             taichi_arch = taichi.lang.impl.get_runtime().prog.config.arch
             assert taichi_arch == _ti_core.Arch.x64 or taichi_arch == _ti_core.Arch.arm64, "SparseSolver only supports CPU for now."
-            self.solver = _ti_core.make_sparse_solver(solver_type, ordering)
+            self.dtype = dtype
+            self.solver = _ti_core.make_sparse_solver(dtype, index_dtype,
+                                                      solver_type, ordering)
         else:
             assert False, f"The solver type {solver_type} with {ordering} is not supported for now. Only {solver_type_list} with {solver_ordering} are supported."
 
@@ -31,6 +41,8 @@ class SparseSolver:
     def compute(self, sparse_matrix):
         """This method is equivalent to calling both `analyze_pattern` and then `factorize`.
 
+        The analysis is skipped if the matrix has the sparsity pattern of the last analyzed one.
+
         Args:
             sparse_matrix (SparseMatrix): The sparse matrix to be computed.
         """
@@ -53,6 +65,8 @@ class SparseSolver:
     def factorize(self, sparse_matrix):
         """Do the factorization step
 
+        The pattern of the matrix is analyzed first if it differs from the last analyzed one.
+
         Args:
             sparse_matrix (SparseMatrix): The sparse matrix to be factorized.
         """
@@ -61,19 +75,40 @@ class SparseSolver:
         else:
             self.type_assert(sparse_matrix)
 
-    def solve(self, b):
+    def solve(self, b, x=None):
         """Computes the solution of the linear systems.
         Args:
-            b (numpy.array or Field): The right-hand side of the linear systems.
+            b (numpy.array, Field or Ndarray): The right-hand side of the linear systems.
+            x (Field or Ndarray, optional): Where to store the solution. An Ndarray of the
+                dtype of the solver is written in place without copying the solution.
 
         Returns:
-            numpy.array: The solution of linear systems.
+            numpy.array: The solution of linear systems, or x if it is given.
         """
-        if isinstance(b, taichi.lang.Field):
-            return self.solver.solve(b.to_numpy())
-        if isinstance(b, np.ndarray):
+        if isinstance(b, Ndarray) and isinstance(
+                x, Ndarray) and b.dtype == self.dtype:
+            b_ptr = b.data_handle
+        else:
+            if isinstance(b, (taichi.lang.Field, Ndarray)):
+                b = b.to_numpy()
+            assert isinstance(
+                b, np.ndarray
+            ), f"The parameter type: {type(b)} is not supported in linear solvers for now."
+            b = np.ascontiguousarray(b, dtype=to_numpy_type(self.dtype))
+            b_ptr = b.ctypes.data
+
+        if x is None:
             return self.solver.solve(b)
-        assert False, f"The parameter type: {type(b)} is not supported in linear solvers for now."
+        if isinstance(x, Ndarray):
+            assert x.dtype == self.dtype, f"The solution ndarray has dtype {x.dtype}, but the solver has dtype {self.dtype}."
+            assert tuple(x.shape) == tuple(
+                b.shape), f"Shape mismatch between b {b.shape} and x {x.shape}"
+            self.solver.solve_in_place(b_ptr, x.data_handle)
+        elif isinstance(x, taichi.lang.Field):
+            x.from_numpy(self.solver.solve(b))
+        else:
+            assert False, f"The solution type: {type(x)} is not supported in linear solvers for now."
+        return x
 
     def info(self):
         """Check if the linear systems are solved successfully.
@@ -82,3 +117,11 @@ class SparseSolver:
             bool: True if the solving process succeeded, False otherwise.
         """
         return self.solver.info()
+
+    def num_analyses(self):
+        """The number of times a sparsity pattern has been analyzed by this solver.
+
+        Returns:
+            int: The number of symbolic analyses.
+        """
+        return self.solver.num_analyses()
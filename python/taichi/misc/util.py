@@ -190,6 +190,18 @@ def print_profile_info():
     _ti_core.print_profile_info()
 
 
+def print_profile_summary():
+    """Print the total time elapsed in each profiled scope on the host.
+
+    Unlike :func:`print_profile_info`, the time of a scope is summed over all
+    its call sites, so this shows e.g. how much of the kernel compilation time
+    is spent in each IR pass.
+
+    Call function imports from C++ : _ti_core.print_profile_summary()
+    """
+    _ti_core.print_profile_summary()
+
+
 def clear_profile_info():
     """Clear profiler's records about time elapsed on the host tasks.
 
@@ -247,6 +259,14 @@ def print_async_stats(include_kernel_profiler=False):
     NUM_FUSED_TASKS_KEY = 'num_fused_tasks'
     if NUM_FUSED_TASKS_KEY in counters:
         print(f'Tasks fused:          {int(counters["num_fused_tasks"])}')
+    for name, key in [('Fusion', 'fusion_cache'),
+                      ('Compilation', 'async_compile_cache')]:
+        hits = counters.get(f'{key}_hits', 0)
+        misses = counters.get(f'{key}_misses', 0)
+        if hits + misses > 0:
+            label = f'{name} cache hits:'
+            print(f'{label:<22}{int(hits)}/{int(hits + misses)} '
+                  f'({100 * hits / (hits + misses):.1f}%)')
     print('=======================')
 
 
@@ -264,5 +284,6 @@ __all__ = [
     'get_traceback',
     'set_gdb_trigger',
     'print_profile_info',
+    'print_profile_summary',
     'clear_profile_info',
 ]
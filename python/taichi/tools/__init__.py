@@ -1,5 +1,5 @@
 from .np2ply import PLYWriter
 from .patterns import taichi_logo
-from .video import VideoManager
+from .video import VideoManager, VideoWriter
 
 __all__ = [s for s in dir() if not s.startswith('_')]
@@ -1,8 +1,19 @@
 import os
+import queue
 import shutil
+import subprocess
+import threading
 
+import numpy as np
 from taichi.core import get_os_name
-from taichi.misc.image import imwrite
+from taichi.core import ti_core as _ti_core
+from taichi.lang import meta
+from taichi.lang._ndarray import Ndarray, ScalarNdarray
+from taichi.lang.field import ScalarField
+from taichi.lang.matrix import MatrixField
+from taichi.misc.image import cook_image_to_bytes, imwrite
+
+import taichi as ti
 
 FRAME_FN_TEMPLATE = '%06d.png'
 FRAME_DIR = 'frames'
@@ -131,6 +142,144 @@ class VideoManager:
             os.remove(fn)
 
 
+class VideoWriter:
+    """Streams frames into an ffmpeg process, without writing them to disk.
+
+    Frames from Taichi fields and ndarrays are converted to raw pixels by a
+    parallel kernel, and a background thread pipes them into ffmpeg, which
+    encodes them while the next frames are rendered. At most `queue_size`
+    converted frames wait for the encoder; further calls to `write_frame`
+    block until it catches up.
+
+    Args:
+        output_path (str): Path of the video, e.g. 'video.mp4'.
+        framerate (int, optional): Frames per second. Default is 24.
+        crf (int, optional): Constant rate factor of H.264 videos, lower is
+            better. Default is 20.
+        queue_size (int, optional): Number of frames that can be queued for
+            the encoder. Default is 8.
+
+    Example::
+
+        >>> with ti.VideoWriter('video.mp4', framerate=24) as video:
+        >>>     for frame in range(100):
+        >>>         render(frame)
+        >>>         video.write_frame(pixels)
+    """
+    def __init__(self, output_path, framerate=24, crf=20, queue_size=8):
+        self.output_path = output_path
+        self.framerate = framerate
+        self.crf = crf
+        self.res = None
+        self.frame_counter = 0
+        self._queue = queue.Queue(maxsize=queue_size)
+        self._process = None
+        self._thread = None
+        self._error = None
+
+    def _start(self, width, height):
+        self.res = (width, height)
+        command = [
+            get_ffmpeg_path(), '-y', '-loglevel', 'error', '-f', 'rawvideo',
+            '-pix_fmt', 'rgb0', '-s:v', f'{width}x{height}', '-framerate',
+            str(self.framerate), '-i', '-'
+        ]
+        if not self.output_path.endswith('.gif'):
+            # H.264 with yuv420p needs an even width and height
+            command += [
+                '-vf', 'pad=ceil(iw/2)*2:ceil(ih/2)*2', '-c:v', 'libx264',
+                '-profile:v', 'high', '-crf',
+                str(self.crf), '-pix_fmt', 'yuv420p'
+            ]
+        command.append(self.output_path)
+        self._process = subprocess.Popen(command, stdin=subprocess.PIPE)
+        self._thread = threading.Thread(target=self._encode, daemon=True)
+        self._thread.start()
+
+    def _encode(self):
+        while True:
+            frame = self._queue.get()
+            if frame is None:
+                break
+            if self._error is not None:
+                continue  # Keep draining so that write_frame never blocks
+            try:
+                self._process.stdin.write(frame)
+            except OSError as e:
+                self._error = e
+
+    def _convert(self, img):
+        if isinstance(img, np.ndarray):
+            img = cook_image_to_bytes(img)
+            frame = np.zeros(img.shape[:2] + (4, ), dtype=np.uint8)
+            frame[..., :3] = img[..., :3]
+            return frame
+        if isinstance(img, (ScalarField, ScalarNdarray)):
+            layout = 'grey' if len(img.shape) == 2 else 'channels'
+            assert len(img.shape) == 2 or (len(img.shape) == 3 and img.shape[2] in [3, 4]), \
+                "Only greyscale, RGB or RGBA images are supported in VideoWriter"
+        else:
+            layout = 'vector'
+            assert img.n in [3, 4] and getattr(img, 'm', 1) == 1, \
+                "Only greyscale, RGB or RGBA images are supported in VideoWriter"
+        assert not _ti_core.is_integral(img.dtype) or img.dtype == ti.u8, \
+            "Only float and u8 images are supported in VideoWriter"
+        width, height = img.shape[:2]
+        frame = np.empty((height, width), dtype=np.int32)
+        is_float = not _ti_core.is_integral(img.dtype)
+        if isinstance(img, Ndarray):
+            meta.ndarray_to_video_frame(img, frame, layout, is_float)
+        else:
+            meta.image_to_video_frame(img, frame, layout, is_float)
+        return frame
+
+    def write_frame(self, img):
+        """Queues a frame for the encoder.
+
+        Args:
+            img (Union[ti.field, ti.ndarray, numpy.array]): A greyscale, RGB
+                or RGBA image of shape `(width, height)` or
+                `(width, height, channels)`. Fields and ndarrays must be
+                float (in [0, 1]) or u8.
+        """
+        if self._error is not None:
+            raise RuntimeError(
+                f'ffmpeg failed to encode {self.output_path}: {self._error}')
+        assert isinstance(img, (np.ndarray, ScalarField, MatrixField, Ndarray)), \
+            f"VideoWriter only takes a Taichi field, ndarray or NumPy array, not {type(img)}"
+        frame = self._convert(img)
+        height, width = frame.shape[:2]
+        if self._process is None:
+            self._start(width, height)
+        assert self.res == (width, height), \
+            f"Frame resolution {(width, height)} does not match the video resolution {self.res}"
+        self._queue.put(frame)
+        self.frame_counter += 1
+
+    def close(self):
+        """Waits until all the frames are encoded and the video is written."""
+        if self._process is None:
+            return
+        self._queue.put(None)
+        self._thread.join()
+        try:
+            self._process.stdin.close()
+        except OSError as e:
+            self._error = self._error or e
+        ret = self._process.wait()
+        self._process = None
+        if ret != 0 or self._error is not None:
+            raise RuntimeError(
+                f'ffmpeg failed to encode {self.output_path} (exit code {ret})'
+            )
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
 def interpolate_frames(frame_dir, mul=4):
     # TODO: remove dependency on cv2 here
     import cv2  # pylint: disable=C0415
@@ -167,14 +167,62 @@ class UniquelyAccessedSNodeSearcher : public BasicStmtVisitor {
 
 class UniquelyAccessedBitStructGatherer : public BasicStmtVisitor {
  private:
+  const CompileConfig &config_;
   std::unordered_map<OffloadedStmt *,
                      std::unordered_map<const SNode *, GlobalPtrStmt *>>
       result_;
 
+  static bool is_loop_index(Stmt *stmt, OffloadedStmt *offload, int index) {
+    auto loop_index = stmt->cast<LoopIndexStmt>();
+    return loop_index && loop_index->loop == offload &&
+           loop_index->index == index;
+  }
+
+  // Whether no two threads of |offload| store to the same physical word of
+  // |bit_array| when |ptr| is the only pointer to it, so that the words can
+  // be updated without CAS loops.
+  bool owns_bit_array_words(OffloadedStmt *offload,
+                            const SNode *bit_array,
+                            GlobalPtrStmt *ptr) const {
+    if (offload->task_type == OffloadedTaskType::struct_for) {
+      // A struct-for over a bit_array processes each container (word) in one
+      // iteration.
+      if (offload->snode != bit_array)
+        return false;
+      for (int i = 0; i < (int)ptr->indices.size(); i++) {
+        if (!is_loop_index(ptr->indices[i], offload,
+                           bit_array->physical_index_position[i]))
+          return false;
+      }
+      return true;
+    }
+    if (offload->task_type == OffloadedTaskType::range_for) {
+      // A CPU range-for hands out |block_dim| consecutive iterations to each
+      // task. If the loop index is the coordinate along an axis, and the
+      // tasks start at multiples of the bit_array shape along that axis, the
+      // words touched by different tasks are disjoint.
+      if (!arch_is_cpu(config_.arch) || offload->reversed ||
+          !offload->const_begin || offload->block_dim <= 0 ||
+          !ptr->snodes[0]->index_offsets.empty())
+        return false;
+      for (int i = 0; i < (int)ptr->indices.size(); i++) {
+        if (is_loop_index(ptr->indices[i], offload, 0)) {
+          const int shape =
+              bit_array->extractors[bit_array->physical_index_position[i]]
+                  .shape;
+          return offload->begin_value % shape == 0 &&
+                 offload->block_dim % shape == 0;
+        }
+      }
+    }
+    return false;
+  }
+
  public:
   using BasicStmtVisitor::visit;
 
-  UniquelyAccessedBitStructGatherer() {
+  explicit UniquelyAccessedBitStructGatherer(const CompileConfig &config)
+      : config_(config) {
     allow_undefined_visitor = true;
     invoke_default_visitor = false;
   }
@@ -194,6 +242,12 @@ class UniquelyAccessedBitStructGatherer : public BasicStmtVisitor {
           while (snode->is_bit_level) {
             snode = snode->parent;
           }
+          // For bit_arrays, a unique pointer is only useful if the threads
+          // also own the words it points into.
+          if (ptr1 != nullptr && snode->type == SNodeType::bit_array &&
+              !owns_bit_array_words(stmt, snode, ptr1)) {
+            ptr1 = nullptr;
+          }
           // Check whether uniquely accessed
           auto accessed_ptr = loop_unique_bit_struct.find(snode);
           if (accessed_ptr == loop_unique_bit_struct.end()) {
@@ -220,8 +274,8 @@ class UniquelyAccessedBitStructGatherer : public BasicStmtVisitor {
 
   static std::unordered_map<OffloadedStmt *,
                             std::unordered_map<const SNode *, GlobalPtrStmt *>>
-  run(IRNode *root) {
-    UniquelyAccessedBitStructGatherer gatherer;
+  run(IRNode *root, const CompileConfig &config) {
+    UniquelyAccessedBitStructGatherer gatherer(config);
     root->accept(&gatherer);
     return gatherer.result_;
   }
@@ -237,9 +291,11 @@ gather_uniquely_accessed_pointers(IRNode *root) {
   return UniquelyAccessedSNodeSearcher::run(root);
 }
 
-void gather_uniquely_accessed_bit_structs(IRNode *root, AnalysisManager *amgr) {
+void gather_uniquely_accessed_bit_structs(IRNode *root,
+                                          const CompileConfig &config,
+                                          AnalysisManager *amgr) {
   amgr->put_pass_result<GatherUniquelyAccessedBitStructsPass>(
-      {UniquelyAccessedBitStructGatherer::run(root)});
+      {UniquelyAccessedBitStructGatherer::run(root, config)});
 }
 }  // namespace irpass::analysis
 
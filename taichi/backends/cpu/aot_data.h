@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "taichi/common/core.h"
+
+namespace taichi {
+namespace lang {
+namespace cpu {
+
+struct AotArgData {
+  std::string dtype_name;
+  bool is_external_array{false};
+  std::size_t size{0};
+
+  TI_IO_DEF(dtype_name, is_external_array, size);
+};
+
+struct AotCompiledKernel {
+  std::string identifier;
+  // Symbols of the offloaded tasks in the shared object, in launch order.
+  std::vector<std::string> tasks;
+  std::vector<AotArgData> args;
+  std::vector<std::string> ret_dtype_names;
+
+  TI_IO_DEF(identifier, tasks, args, ret_dtype_names);
+};
+
+struct AotCompiledKernelTmpl {
+  std::unordered_map<std::string, AotCompiledKernel> kernels;
+  std::string identifier;
+
+  TI_IO_DEF(kernels, identifier);
+};
+
+struct AotFieldData {
+  std::string field_name;
+  std::string dtype_name;
+  int snode_tree_id{0};
+  // Byte offset of the dense container in the root buffer
+  std::size_t mem_offset_in_parent{0};
+  // Byte offset of the field in a cell of the dense container
+  std::size_t mem_offset_in_cell{0};
+  std::size_t cell_stride{0};
+  std::vector<int> shape;
+  bool is_scalar{false};
+  int row_num{0};
+  int column_num{0};
+
+  TI_IO_DEF(field_name,
+            dtype_name,
+            snode_tree_id,
+            mem_offset_in_parent,
+            mem_offset_in_cell,
+            cell_stride,
+            shape,
+            is_scalar,
+            row_num,
+            column_num);
+};
+
+// Mirrors what LlvmProgramImpl::initialize_llvm_runtime_snodes() passes to
+// the runtime.
+struct AotNodeAllocatorData {
+  int snode_id{0};
+  std::size_t node_size{0};
+
+  TI_IO_DEF(snode_id, node_size);
+};
+
+struct AotSNodeTreeData {
+  int id{0};
+  int root_id{0};
+  std::size_t root_size{0};
+  int num_snodes{0};
+  bool all_dense{false};
+  std::vector<AotNodeAllocatorData> node_allocators;
+
+  TI_IO_DEF(id, root_id, root_size, num_snodes, all_dense, node_allocators);
+};
+
+/**
+ * AOT module data for the LLVM CPU backend. The object code itself lives in
+ * a shared object next to the serialized AotData.
+ */
+struct AotData {
+  std::vector<AotCompiledKernel> kernels;
+  std::vector<AotCompiledKernelTmpl> kernel_tmpls;
+  std::vector<AotFieldData> fields;
+  std::vector<AotSNodeTreeData> snode_trees;
+  int cpu_max_num_threads{0};
+  int random_seed{0};
+
+  TI_IO_DEF(kernels,
+            kernel_tmpls,
+            fields,
+            snode_trees,
+            cpu_max_num_threads,
+            random_seed);
+};
+
+}  // namespace cpu
+}  // namespace lang
+}  // namespace taichi
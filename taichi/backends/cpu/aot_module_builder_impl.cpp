@@ -0,0 +1,260 @@
+#include "taichi/backends/cpu/aot_module_builder_impl.h"
+
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include "taichi/backends/cpu/codegen_cpu.h"
+#include "taichi/llvm/llvm_program.h"
+#include "taichi/program/kernel.h"
+#include "taichi/struct/struct_llvm.h"
+#include "taichi/util/str.h"
+
+namespace taichi {
+namespace lang {
+namespace cpu {
+namespace {
+
+// Index of |snode| among the children of its parent that have an LLVM type.
+int find_llvm_children_id(const SNode *snode) {
+  int id = 0;
+  for (const auto &ch : snode->parent->ch) {
+    if (ch.get() == snode) {
+      return id;
+    }
+    if (!ch->is_bit_level) {
+      id++;
+    }
+  }
+  TI_ERROR("Child not found in parent!");
+}
+
+void collect_snodes(const SNode *snode, std::vector<const SNode *> *snodes) {
+  snodes->push_back(snode);
+  for (const auto &ch : snode->ch) {
+    collect_snodes(ch.get(), snodes);
+  }
+}
+
+void emit_object_file(llvm::Module *module, const std::string &path) {
+  auto triple = llvm::sys::getProcessTriple();
+  std::string err_str;
+  const llvm::Target *target = llvm::TargetRegistry::lookupTarget(triple,
+                                                                  err_str);
+  TI_ERROR_UNLESS(target, err_str);
+
+  llvm::TargetOptions options;
+  // The shared object may be loaded at any address.
+  std::unique_ptr<llvm::TargetMachine> target_machine(
+      target->createTargetMachine(triple, llvm::sys::getHostCPUName(), "",
+                                  options, llvm::Reloc::PIC_,
+                                  llvm::CodeModel::Small,
+                                  llvm::CodeGenOpt::Aggressive));
+  TI_ERROR_UNLESS(target_machine.get(), "Could not allocate target machine!");
+  module->setTargetTriple(triple);
+  module->setDataLayout(target_machine->createDataLayout());
+
+  std::error_code ec;
+  llvm::raw_fd_ostream dest(path, ec, llvm::sys::fs::OF_None);
+  TI_ERROR_IF(ec, "Could not open file {}: {}", path, ec.message());
+
+  llvm::legacy::PassManager pass_manager;
+  bool fail = target_machine->addPassesToEmitFile(pass_manager, dest, nullptr,
+                                                  llvm::CGFT_ObjectFile);
+  TI_ERROR_IF(fail, "Failed to set up passes to emit object file");
+  pass_manager.run(*module);
+  dest.flush();
+}
+
+}  // namespace
+
+AotModuleBuilderImpl::AotModuleBuilderImpl(LlvmProgramImpl *prog)
+    : prog_(prog) {
+  TI_AUTO_PROF
+  module_ = prog_->get_llvm_context(host_arch())->clone_struct_module();
+  aot_data_.cpu_max_num_threads = prog_->config->cpu_max_num_threads;
+  aot_data_.random_seed = prog_->config->random_seed;
+}
+
+AotModuleBuilderImpl::~AotModuleBuilderImpl() = default;
+
+void AotModuleBuilderImpl::dump(const std::string &output_dir,
+                                const std::string &filename) const {
+  AotData aot_data = aot_data_;
+  const auto data_layout =
+      prog_->get_llvm_context(host_arch())->get_data_layout();
+  for (const auto &kv : snode_tree_roots_) {
+    const SNode *root = kv.second;
+    std::vector<const SNode *> snodes;
+    collect_snodes(root, &snodes);
+
+    AotSNodeTreeData tree;
+    tree.id = kv.first;
+    tree.root_id = root->id;
+    tree.root_size = data_layout.getTypeAllocSize(
+        StructCompilerLLVM::get_llvm_node_type(module_.get(),
+                                               const_cast<SNode *>(root)));
+    tree.num_snodes = snodes.size();
+    tree.all_dense = prog_->config->demote_dense_struct_fors;
+    for (const auto *snode : snodes) {
+      if (snode->type != SNodeType::dense &&
+          snode->type != SNodeType::place &&
+          snode->type != SNodeType::root) {
+        tree.all_dense = false;
+      }
+      if (is_gc_able(snode->type)) {
+        AotNodeAllocatorData allocator;
+        allocator.snode_id = snode->id;
+        if (snode->type == SNodeType::pointer) {
+          allocator.node_size = snode->cell_size_bytes;
+        } else {
+          allocator.node_size =
+              sizeof(void *) + snode->cell_size_bytes * snode->chunk_size;
+        }
+        tree.node_allocators.push_back(allocator);
+      }
+    }
+    aot_data.snode_trees.push_back(tree);
+  }
+
+  const std::string bin_path =
+      fmt::format("{}/{}_metadata.tcb", output_dir, filename);
+  write_to_binary_file(aot_data, bin_path);
+  // The json file is mostly for debugging purpose.
+  const std::string txt_path =
+      fmt::format("{}/{}_metadata.json", output_dir, filename);
+  TextSerializer ts;
+  ts.serialize_to_json("aot_data", aot_data);
+  ts.write_to_file(txt_path);
+
+  // Keep the module intact so that dump() can be called again.
+  auto module = llvm::CloneModule(*module_);
+  TaichiLLVMContext::eliminate_unused_functions(
+      module.get(), [&](std::string func_name) {
+        // The runtime entry points are needed by the loader to initialize
+        // the LLVMRuntime and the SNode trees.
+        if (starts_with(func_name, "runtime_") ||
+            starts_with(func_name, "LLVMRuntime_")) {
+          return true;
+        }
+        for (auto &name : name_list_) {
+          if (name == func_name)
+            return true;
+        }
+        return false;
+      });
+  prog_->get_llvm_context(host_arch())->jit->global_optimize_module(
+      module.get());
+
+  const std::string obj_path = fmt::format("{}/{}.o", output_dir, filename);
+  emit_object_file(module.get(), obj_path);
+  const std::string so_path = fmt::format("{}/{}.so", output_dir, filename);
+  const auto cmd = fmt::format(prog_->config->cc_link_cmd, so_path, obj_path);
+  TI_TRACE("Executing command: {}", cmd);
+  TI_ERROR_IF(std::system(cmd.c_str()) != 0,
+              "AOT: failed to link the shared object {}", so_path);
+}
+
+AotCompiledKernel AotModuleBuilderImpl::compile_kernel(
+    const std::string &identifier,
+    Kernel *kernel) {
+  for (int i = 0; i < kernel->program->get_snode_tree_size(); i++) {
+    add_snode_tree(kernel->program->get_snode_root(i));
+  }
+
+  auto module_info = CodeGenCPU(kernel).modulegen(std::move(module_));
+  module_ = std::move(module_info->module);
+
+  AotCompiledKernel compiled;
+  compiled.identifier = identifier;
+  compiled.tasks = module_info->name_list;
+  for (auto &name : module_info->name_list) {
+    name_list_.push_back(name);
+  }
+  for (const auto &arg : kernel->args) {
+    AotArgData arg_data;
+    arg_data.dtype_name = arg.dt.to_string();
+    arg_data.is_external_array = arg.is_external_array;
+    arg_data.size = arg.size;
+    compiled.args.push_back(arg_data);
+  }
+  for (const auto &ret : kernel->rets) {
+    compiled.ret_dtype_names.push_back(ret.dt.to_string());
+  }
+  return compiled;
+}
+
+void AotModuleBuilderImpl::add_snode_tree(const SNode *root) {
+  TI_ASSERT(root->type == SNodeType::root);
+  snode_tree_roots_[const_cast<SNode *>(root)->get_snode_tree_id()] = root;
+}
+
+void AotModuleBuilderImpl::add_per_backend(const std::string &identifier,
+                                           Kernel *kernel) {
+  aot_data_.kernels.push_back(compile_kernel(identifier, kernel));
+}
+
+void AotModuleBuilderImpl::add_field_per_backend(const std::string &identifier,
+                                                 const SNode *rep_snode,
+                                                 bool is_scalar,
+                                                 DataType dt,
+                                                 std::vector<int> shape,
+                                                 int row_num,
+                                                 int column_num) {
+  TI_ERROR_IF(!all_fields_are_dense_in_container(rep_snode->parent),
+              "AOT: only supports dense field");
+  const SNode *dense = rep_snode->parent;
+  const SNode *root = dense->parent;
+  add_snode_tree(root);
+
+  const auto data_layout =
+      prog_->get_llvm_context(host_arch())->get_data_layout();
+  auto *root_type = llvm::cast<llvm::StructType>(
+      StructCompilerLLVM::get_llvm_body_type(module_.get(),
+                                             const_cast<SNode *>(root)));
+  auto *cell_type = llvm::cast<llvm::StructType>(
+      StructCompilerLLVM::get_llvm_element_type(module_.get(),
+                                                const_cast<SNode *>(dense)));
+
+  AotFieldData field;
+  field.field_name = identifier;
+  field.dtype_name = dt.to_string();
+  field.snode_tree_id = const_cast<SNode *>(root)->get_snode_tree_id();
+  field.mem_offset_in_parent =
+      data_layout.getStructLayout(root_type)->getElementOffset(
+          find_llvm_children_id(dense));
+  field.mem_offset_in_cell =
+      data_layout.getStructLayout(cell_type)->getElementOffset(
+          find_llvm_children_id(rep_snode));
+  field.cell_stride = dense->cell_size_bytes;
+  field.shape = shape;
+  field.is_scalar = is_scalar;
+  field.row_num = row_num;
+  field.column_num = column_num;
+  aot_data_.fields.push_back(field);
+}
+
+void AotModuleBuilderImpl::add_per_backend_tmpl(const std::string &identifier,
+                                                const std::string &key,
+                                                Kernel *kernel) {
+  auto compiled = compile_kernel(identifier, kernel);
+  for (auto &k : aot_data_.kernel_tmpls) {
+    if (k.identifier == identifier) {
+      k.kernels.insert(std::make_pair(key, compiled));
+      return;
+    }
+  }
+
+  AotCompiledKernelTmpl tmpldata;
+  tmpldata.identifier = identifier;
+  tmpldata.kernels.insert(std::make_pair(key, compiled));
+  aot_data_.kernel_tmpls.push_back(std::move(tmpldata));
+}
+
+}  // namespace cpu
+}  // namespace lang
+}  // namespace taichi
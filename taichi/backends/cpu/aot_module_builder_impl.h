@@ -0,0 +1,59 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "taichi/program/aot_module_builder.h"
+#include "taichi/backends/cpu/aot_data.h"
+#include "taichi/llvm/llvm_fwd.h"
+
+namespace taichi {
+namespace lang {
+
+class LlvmProgramImpl;
+
+namespace cpu {
+
+// Dumps the kernels as a shared object of optimized native code, together
+// with the metadata needed by AotModuleLoader to launch them without LLVM.
+// All the SNode trees must have been materialized before construction.
+class AotModuleBuilderImpl : public AotModuleBuilder {
+ public:
+  explicit AotModuleBuilderImpl(LlvmProgramImpl *prog);
+
+  ~AotModuleBuilderImpl() override;
+
+  void dump(const std::string &output_dir,
+            const std::string &filename) const override;
+
+ protected:
+  void add_per_backend(const std::string &identifier, Kernel *kernel) override;
+  void add_per_backend_tmpl(const std::string &identifier,
+                            const std::string &key,
+                            Kernel *kernel) override;
+  void add_field_per_backend(const std::string &identifier,
+                             const SNode *rep_snode,
+                             bool is_scalar,
+                             DataType dt,
+                             std::vector<int> shape,
+                             int row_num,
+                             int column_num) override;
+
+ private:
+  AotCompiledKernel compile_kernel(const std::string &identifier,
+                                   Kernel *kernel);
+
+  void add_snode_tree(const SNode *root);
+
+  LlvmProgramImpl *prog_;
+  std::unique_ptr<llvm::Module> module_{nullptr};
+  std::vector<std::string> name_list_;
+  // Keyed by the SNode tree id
+  std::map<int, const SNode *> snode_tree_roots_;
+  AotData aot_data_;
+};
+
+}  // namespace cpu
+}  // namespace lang
+}  // namespace taichi
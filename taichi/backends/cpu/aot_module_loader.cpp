@@ -0,0 +1,209 @@
+#include "taichi/backends/cpu/aot_module_loader.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "taichi/backends/cpu/cpu_device.h"
+#include "taichi/math/arithmetic.h"
+#include "taichi/system/dynamic_loader.h"
+#include "taichi/system/memory_pool.h"
+#include "taichi/system/threading.h"
+#include "taichi/util/str.h"
+
+namespace taichi {
+namespace lang {
+namespace cpu {
+namespace {
+
+void assert_failed_host(const char *msg) {
+  TI_ERROR("Assertion failure: {}", msg);
+}
+
+void *taichi_allocate_aligned(MemoryPool *memory_pool,
+                              std::size_t size,
+                              std::size_t alignment) {
+  return memory_pool->allocate(size, alignment);
+}
+
+const AotCompiledKernel *find_kernel(const std::vector<AotCompiledKernel> &ks,
+                                     const std::string &identifier) {
+  for (const auto &k : ks) {
+    if (k.identifier == identifier) {
+      return &k;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+AotModuleLoader::AotModuleLoader(const std::string &output_dir,
+                                 const std::string &filename) {
+  read_from_binary_file(aot_data_,
+                        fmt::format("{}/{}_metadata.tcb", output_dir, filename));
+  const auto so_path = fmt::format("{}/{}.so", output_dir, filename);
+  dll_ = std::make_unique<DynamicLoader>(so_path);
+  TI_ERROR_IF(!dll_->loaded(), "AOT: could not load shared object {}",
+              so_path);
+
+  initialize_runtime();
+  for (const auto &tree : aot_data_.snode_trees) {
+    initialize_snode_tree(tree);
+  }
+}
+
+AotModuleLoader::~AotModuleLoader() {
+  if (memory_pool_) {
+    memory_pool_->terminate();
+  }
+}
+
+template <typename... Args>
+void AotModuleLoader::call_runtime(const std::string &name, Args... args) {
+  using FuncT = void (*)(Args...);
+  auto func = (FuncT)dll_->load_function(name);
+  func(args...);
+}
+
+void AotModuleLoader::initialize_runtime() {
+  device_ = std::make_unique<CpuDevice>();
+  memory_pool_ = std::make_unique<MemoryPool>(Arch::x64, device_.get());
+  thread_pool_ = std::make_unique<ThreadPool>(aot_data_.cpu_max_num_threads);
+  result_buffer_ = (uint64 *)memory_pool_->allocate(
+      sizeof(uint64) * taichi_result_buffer_entries, 8);
+
+  // See LlvmProgramImpl::materialize_runtime().
+  const int starting_rand_state = aot_data_.random_seed * 1048576;
+  call_runtime<void *, void *, std::size_t, void *, int, int, void *, void *,
+               void *>(
+      "runtime_initialize", result_buffer_, memory_pool_.get(),
+      std::size_t(0), nullptr, starting_rand_state,
+      aot_data_.cpu_max_num_threads, (void *)&taichi_allocate_aligned,
+      (void *)std::printf, (void *)std::vsnprintf);
+  llvm_runtime_ =
+      (LLVMRuntime *)result_buffer_[taichi_result_buffer_ret_value_id];
+
+  call_runtime<void *>("runtime_get_mem_req_queue", llvm_runtime_);
+  memory_pool_->set_queue(
+      (MemRequestQueue *)result_buffer_[taichi_result_buffer_ret_value_id]);
+  call_runtime<void *, void *, void *>(
+      "LLVMRuntime_initialize_thread_pool", llvm_runtime_, thread_pool_.get(),
+      (void *)ThreadPool::static_run);
+  call_runtime<void *, void *>("LLVMRuntime_set_assert_failed", llvm_runtime_,
+                               (void *)assert_failed_host);
+}
+
+void AotModuleLoader::initialize_snode_tree(const AotSNodeTreeData &tree) {
+  // See LlvmProgramImpl::initialize_llvm_runtime_snodes().
+  const std::size_t rounded_size =
+      taichi::iroundup(tree.root_size, taichi_page_size);
+  call_runtime<void *, std::size_t, std::size_t>(
+      "runtime_memory_allocate_aligned", llvm_runtime_, rounded_size,
+      taichi_page_size);
+  auto *root = (uint8 *)result_buffer_[taichi_result_buffer_runtime_query_id];
+  roots_[tree.id] = root;
+
+  call_runtime<void *, std::size_t, int, int, int, std::size_t, uint8 *, bool>(
+      "runtime_initialize_snodes", llvm_runtime_, tree.root_size, tree.root_id,
+      tree.num_snodes, tree.id, rounded_size, root, tree.all_dense);
+  for (const auto &allocator : tree.node_allocators) {
+    call_runtime<void *, int, std::size_t>("runtime_NodeAllocator_initialize",
+                                           llvm_runtime_, allocator.snode_id,
+                                           allocator.node_size);
+    call_runtime<void *, int, std::size_t>("runtime_allocate_ambient",
+                                           llvm_runtime_, allocator.snode_id,
+                                           allocator.node_size);
+  }
+}
+
+RuntimeContext AotModuleLoader::make_context() const {
+  RuntimeContext ctx;
+  std::memset(&ctx, 0, sizeof(ctx));
+  ctx.runtime = llvm_runtime_;
+  return ctx;
+}
+
+void AotModuleLoader::launch_kernel(const AotCompiledKernel &kernel,
+                                    RuntimeContext *ctx) {
+  TI_ASSERT(ctx->runtime == llvm_runtime_);
+  for (const auto &task : kernel.tasks) {
+    auto iter = tasks_.find(task);
+    if (iter == tasks_.end()) {
+      auto *func = (void (*)(RuntimeContext *))dll_->load_function(task);
+      iter = tasks_.emplace(task, func).first;
+    }
+    iter->second(ctx);
+  }
+}
+
+const AotCompiledKernel &AotModuleLoader::get_kernel(
+    const std::string &identifier) const {
+  const auto *kernel = find_kernel(aot_data_.kernels, identifier);
+  TI_ERROR_IF(!kernel, "AOT: kernel {} not found", identifier);
+  return *kernel;
+}
+
+const AotCompiledKernel &AotModuleLoader::get_kernel_tmpl(
+    const std::string &identifier,
+    const std::string &key) const {
+  for (const auto &k : aot_data_.kernel_tmpls) {
+    if (k.identifier != identifier) {
+      continue;
+    }
+    auto iter = k.kernels.find(key);
+    TI_ERROR_IF(iter == k.kernels.end(),
+                "AOT: kernel template {} has no instance {}", identifier, key);
+    return iter->second;
+  }
+  TI_ERROR("AOT: kernel template {} not found", identifier);
+}
+
+void AotModuleLoader::launch(const std::string &identifier,
+                             RuntimeContext *ctx) {
+  launch_kernel(get_kernel(identifier), ctx);
+}
+
+void AotModuleLoader::launch_tmpl(const std::string &identifier,
+                                  const std::string &key,
+                                  RuntimeContext *ctx) {
+  launch_kernel(get_kernel_tmpl(identifier, key), ctx);
+}
+
+void *AotModuleLoader::get_field_ptr(const std::string &identifier,
+                                     int i) const {
+  for (const auto &f : aot_data_.fields) {
+    if (f.field_name == identifier) {
+      return roots_.at(f.snode_tree_id) + f.mem_offset_in_parent +
+             f.cell_stride * i + f.mem_offset_in_cell;
+    }
+  }
+  TI_ERROR("AOT: field {} not found", identifier);
+}
+
+void AotModuleLoader::check_runtime_error() {
+  call_runtime<void *>("runtime_retrieve_and_reset_error_code", llvm_runtime_);
+  const auto error_code = result_buffer_[taichi_result_buffer_error_id];
+  if (error_code) {
+    std::string error_message_template;
+    for (int i = 0;; i++) {
+      call_runtime<void *, int>("runtime_retrieve_error_message",
+                                llvm_runtime_, i);
+      auto c = (char)result_buffer_[taichi_result_buffer_error_id];
+      error_message_template += c;
+      if (c == '\0') {
+        break;
+      }
+    }
+    const auto error_message_formatted = format_error_message(
+        error_message_template, [this](int argument_id) {
+          call_runtime<void *, int>("runtime_retrieve_error_message_argument",
+                                    llvm_runtime_, argument_id);
+          return result_buffer_[taichi_result_buffer_error_id];
+        });
+    TI_ERROR("Assertion failure: {}", error_message_formatted);
+  }
+}
+
+}  // namespace cpu
+}  // namespace lang
+}  // namespace taichi
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "taichi/backends/cpu/aot_data.h"
+#define TI_RUNTIME_HOST
+#include "taichi/program/context.h"
+#undef TI_RUNTIME_HOST
+
+namespace taichi {
+
+class DynamicLoader;
+class ThreadPool;
+
+namespace lang {
+
+class MemoryPool;
+
+namespace cpu {
+
+class CpuDevice;
+
+/**
+ * Loads a module dumped by the CPU AotModuleBuilderImpl and launches its
+ * kernels. The module is a shared object containing both the kernels and the
+ * LLVM runtime, so no LLVM is involved at load time.
+ */
+class AotModuleLoader {
+ public:
+  AotModuleLoader(const std::string &output_dir, const std::string &filename);
+
+  ~AotModuleLoader();
+
+  const AotData &aot_data() const {
+    return aot_data_;
+  }
+
+  // Returns a context whose kernel arguments are to be filled in with
+  // RuntimeContext::set_arg().
+  RuntimeContext make_context() const;
+
+  const AotCompiledKernel &get_kernel(const std::string &identifier) const;
+
+  // Returns the instance |key| of a kernel template, where |key| is built by
+  // ti.aot.KernelTemplate, e.g. "n=6/".
+  const AotCompiledKernel &get_kernel_tmpl(const std::string &identifier,
+                                           const std::string &key) const;
+
+  void launch(const std::string &identifier, RuntimeContext *ctx);
+
+  void launch_tmpl(const std::string &identifier,
+                   const std::string &key,
+                   RuntimeContext *ctx);
+
+  template <typename T>
+  T get_ret(int i) const {
+    return taichi_union_cast_with_different_sizes<T>(
+        result_buffer_[taichi_result_buffer_ret_value_id + i]);
+  }
+
+  // Address of the |i|-th element (in row-major order) of a field.
+  void *get_field_ptr(const std::string &identifier, int i) const;
+
+  // Throws if an assertion failed in a kernel launched so far.
+  void check_runtime_error();
+
+ private:
+  template <typename... Args>
+  void call_runtime(const std::string &name, Args... args);
+
+  void launch_kernel(const AotCompiledKernel &kernel, RuntimeContext *ctx);
+
+  void initialize_runtime();
+
+  void initialize_snode_tree(const AotSNodeTreeData &tree);
+
+  AotData aot_data_;
+  std::unique_ptr<DynamicLoader> dll_;
+  std::unique_ptr<CpuDevice> device_;
+  std::unique_ptr<MemoryPool> memory_pool_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  uint64 *result_buffer_{nullptr};
+  LLVMRuntime *llvm_runtime_{nullptr};
+  std::unordered_map<int, uint8 *> roots_;
+  // Resolved symbols of the offloaded tasks
+  std::unordered_map<std::string, void (*)(RuntimeContext *)> tasks_;
+};
+
+}  // namespace cpu
+}  // namespace lang
+}  // namespace taichi
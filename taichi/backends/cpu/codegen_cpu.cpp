@@ -16,7 +16,10 @@ class CodeGenLLVMCPU : public CodeGenLLVM {
  public:
   using IRVisitor::visit;
 
-  CodeGenLLVMCPU(Kernel *kernel, IRNode *ir) : CodeGenLLVM(kernel, ir) {
+  CodeGenLLVMCPU(Kernel *kernel,
+                 IRNode *ir,
+                 std::unique_ptr<llvm::Module> &&module = nullptr)
+      : CodeGenLLVM(kernel, ir, std::move(module)) {
     TI_AUTO_PROF
   }
 
@@ -99,6 +102,7 @@ class CodeGenLLVMCPU : public CodeGenLLVM {
 
       {
         builder->SetInsertPoint(loop_body_bb);
+        loop_iteration_begin = loop_body_bb;
         loop_vars_llvm[stmt].push_back(loop_index);
         for (int i = 0; i < stmt->body->size(); i++) {
           auto &s = stmt->body->statements[i];
@@ -109,6 +113,7 @@ class CodeGenLLVMCPU : public CodeGenLLVM {
                              loop_index);
         builder->CreateBr(loop_test_bb);
         builder->SetInsertPoint(func_exit);
+        loop_iteration_begin = nullptr;
       }
 
       if (stmt->bls_epilogue) {
@@ -159,8 +164,15 @@ class CodeGenLLVMCPU : public CodeGenLLVM {
     } else if (stmt->task_type == Type::mesh_for) {
       create_offload_mesh_for(stmt);
     } else if (stmt->task_type == Type::struct_for) {
-      stmt->block_dim = std::min(stmt->snode->parent->max_num_elements(),
-                                 (int64)stmt->block_dim);
+      if (stmt->bls_prologue) {
+        // The BLS prologue runs once per task, so each block is processed as
+        // a whole instead of being split into parts that each fill the
+        // buffer again.
+        stmt->block_dim = stmt->snode->parent->max_num_elements();
+      } else {
+        stmt->block_dim = std::min(stmt->snode->parent->max_num_elements(),
+                                   (int64)stmt->block_dim);
+      }
       create_offload_struct_for(stmt);
     } else if (stmt->task_type == Type::listgen) {
       emit_list_gen(stmt);
@@ -194,4 +206,17 @@ FunctionType CodeGenCPU::codegen() {
   return CodeGenLLVMCPU(kernel, ir).gen();
 }
 
+std::unique_ptr<ModuleGenValue> CodeGenCPU::modulegen(
+    std::unique_ptr<llvm::Module> &&module) {
+  TI_AUTO_PROF
+  CodeGenLLVMCPU gen(kernel, ir, std::move(module));
+  gen.emit_to_module();
+
+  std::vector<std::string> name_list;
+  for (auto &task : gen.offloaded_tasks) {
+    name_list.push_back(task.name);
+  }
+  return std::make_unique<ModuleGenValue>(std::move(gen.module), name_list);
+}
+
 TLANG_NAMESPACE_END
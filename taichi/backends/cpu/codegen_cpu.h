@@ -2,16 +2,27 @@
 
 #pragma once
 
+#include <memory>
+
 #include "taichi/codegen/codegen.h"
+#include "taichi/llvm/llvm_fwd.h"
 
 TLANG_NAMESPACE_BEGIN
 
+class ModuleGenValue;
+
 class CodeGenCPU : public KernelCodeGen {
  public:
   CodeGenCPU(Kernel *kernel, IRNode *ir = nullptr) : KernelCodeGen(kernel, ir) {
   }
 
   virtual FunctionType codegen() override;
+
+  // AOT Module Gen: emits the offloaded tasks into |module| (a clone of the
+  // struct module if null) without compiling them. The names of the task
+  // functions are returned in launch order.
+  std::unique_ptr<ModuleGenValue> modulegen(
+      std::unique_ptr<llvm::Module> &&module);
 };
 
 TLANG_NAMESPACE_END
@@ -623,6 +623,7 @@ class CodeGenLLVMCUDA : public CodeGenLLVM {
 
       {
         builder->SetInsertPoint(loop_body_bb);
+        loop_iteration_begin = loop_body_bb;
         loop_vars_llvm[stmt].push_back(loop_index);
         for (int i = 0; i < stmt->body->size(); i++) {
           auto &s = stmt->body->statements[i];
@@ -633,6 +634,7 @@ class CodeGenLLVMCUDA : public CodeGenLLVM {
             loop_index);
         builder->CreateBr(loop_test_bb);
         builder->SetInsertPoint(func_exit);
+        loop_iteration_begin = nullptr;
       }
 
       if (stmt->bls_epilogue) {
@@ -58,6 +58,7 @@ class StructCompiler {
     {
       max_snodes_ = 0;
       has_sparse_snode_ = false;
+      bool has_morton_snode = false;
 #define CHECK_UNSUPPORTED_TYPE(type_case)                                \
   else if (ty == SNodeType::type_case) {                                 \
     TI_ERROR("Metal backend does not support SNode=" #type_case " yet"); \
@@ -73,8 +74,13 @@ class StructCompiler {
           max_snodes_ = std::max(max_snodes_, sn->id);
         }
         has_sparse_snode_ = has_sparse_snode_ || is_supported_sparse_type(ty);
+        has_morton_snode = has_morton_snode || sn->_morton;
       }
       ++max_snodes_;
+      // Struct-fors over sparse SNodes refine coordinates in row-major order
+      TI_ERROR_IF(has_sparse_snode_ && has_morton_snode,
+                  "Metal backend does not support Morton-ordered SNodes "
+                  "together with sparse SNodes yet");
     }
 #undef CHECK_UNSUPPORTED_TYPE
 
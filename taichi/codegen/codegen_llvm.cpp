@@ -162,17 +162,91 @@ void CodeGenLLVM::visit(AllocaStmt *stmt) {
   }
 }
 
+llvm::Value *CodeGenLLVM::get_rand_stream() {
+  auto i64_type = llvm::Type::getInt64Ty(*llvm_context);
+  llvm::Value *stream = tlctx->get_constant((int64)0);
+  // Serial tasks, and the TLS prologues and epilogues, only have one stream.
+  auto in_current_function = [&](llvm::Value *v) {
+    return v && llvm::cast<llvm::Instruction>(v)->getFunction() == func;
+  };
+  using Type = OffloadedStmt::TaskType;
+  const auto task_type =
+      current_offload ? current_offload->task_type : Type::serial;
+  if (task_type == Type::range_for || task_type == Type::mesh_for) {
+    auto it = loop_vars_llvm.find(current_offload);
+    if (it != loop_vars_llvm.end() && in_current_function(it->second[0])) {
+      auto index = builder->CreateLoad(it->second[0]);
+      if (task_type == Type::range_for) {
+        stream = builder->CreateSExt(index, i64_type);
+      } else {
+        // The loop index is local to the patch (the third argument)
+        stream = builder->CreateOr(
+            builder->CreateShl(builder->CreateZExt(get_arg(2), i64_type), 32),
+            builder->CreateZExt(index, i64_type));
+      }
+    }
+  } else if (task_type == Type::struct_for &&
+             in_current_function(current_coordinates)) {
+    auto coord_object = RuntimeObject(kLLVMPhysicalCoordinatesName, this,
+                                      builder.get(), current_coordinates);
+    auto snode = current_offload->snode;
+    for (int i = 0; i < snode->num_active_indices; i++) {
+      auto coord = coord_object.get(
+          "val", tlctx->get_constant(snode->physical_index_position[i]));
+      stream = builder->CreateAdd(
+          builder->CreateMul(stream,
+                             tlctx->get_constant((int64)0x9E3779B97F4A7C15)),
+          builder->CreateZExt(coord, i64_type));
+    }
+  }
+  return stream;
+}
+
+llvm::Value *CodeGenLLVM::get_rand_counter() {
+  // Functions called for each loop iteration reset the counter on entry,
+  // loops inside a function at the beginning of each iteration.
+  auto reset_block = entry_block;
+  if (loop_iteration_begin && loop_iteration_begin->getParent() == func) {
+    reset_block = loop_iteration_begin;
+  }
+  auto &counter = rand_counters[reset_block];
+  if (!counter) {
+    counter = create_entry_block_alloca(PrimitiveType::i32);
+    llvm::IRBuilderBase::InsertPointGuard guard(*builder);
+    if (reset_block == entry_block) {
+      builder->SetInsertPoint(entry_block);
+    } else {
+      builder->SetInsertPoint(reset_block, reset_block->getFirstInsertionPt());
+    }
+    builder->CreateStore(tlctx->get_constant(0), counter);
+  }
+  return counter;
+}
+
 void CodeGenLLVM::visit(RandStmt *stmt) {
-  if (stmt->ret_type->is_primitive(PrimitiveTypeID::f16)) {
-    // Promoting to f32 since there's no rand_f16 support in runtime.cpp.
-    auto val_f32 = create_call("rand_f32", {get_context()});
-    llvm_val[stmt] =
-        builder->CreateFPTrunc(val_f32, llvm::Type::getHalfTy(*llvm_context));
+  // Promoting f16 to f32 since there's no rand_f16 support in runtime.cpp.
+  const auto dt = stmt->ret_type->is_primitive(PrimitiveTypeID::f16)
+                      ? PrimitiveType::f32
+                      : stmt->ret_type;
+  llvm::Value *val;
+  if (prog->config.random_generator == "philox") {
+    auto counter = get_rand_counter();
+    auto call = builder->CreateLoad(counter);
+    builder->CreateStore(builder->CreateAdd(call, tlctx->get_constant(1)),
+                         counter);
+    val = create_call(
+        fmt::format("philox_rand_{}", data_type_name(dt)),
+        {get_context(), get_rand_stream(), call,
+         tlctx->get_constant((int32)offloaded_tasks.size()),
+         tlctx->get_constant(prog->config.random_seed)});
   } else {
-    llvm_val[stmt] =
-        create_call(fmt::format("rand_{}", data_type_name(stmt->ret_type)),
-                    {get_context()});
+    val = create_call(fmt::format("rand_{}", data_type_name(dt)),
+                      {get_context()});
   }
+  if (dt != stmt->ret_type) {
+    val = builder->CreateFPTrunc(val, llvm::Type::getHalfTy(*llvm_context));
+  }
+  llvm_val[stmt] = val;
 }
 
 void CodeGenLLVM::emit_extra_unary(UnaryOpStmt *stmt) {
@@ -1237,7 +1311,15 @@ void CodeGenLLVM::visit(AtomicOpStmt *stmt) {
       } else if (auto cit = dst_type->cast<CustomIntType>()) {
         old_value = atomic_add_custom_int(stmt, cit);
       } else if (auto cft = dst_type->cast<CustomFloatType>()) {
-        old_value = atomic_add_custom_float(stmt, cft);
+        auto get_ch = stmt->dest->cast<GetChStmt>();
+        if (cft->get_exponent_type() && get_ch &&
+            get_ch->input_snode->type == SNodeType::bit_array) {
+          old_value = update_bit_array_with_shared_exponent(
+              llvm_val[stmt->dest], get_ch->output_snode, llvm_val[stmt->val],
+              /*add=*/true, /*atomic=*/true);
+        } else {
+          old_value = atomic_add_custom_float(stmt, cft);
+        }
       } else {
         TI_NOT_IMPLEMENTED
       }
@@ -1320,20 +1402,32 @@ void CodeGenLLVM::visit(GlobalStoreStmt *stmt) {
   if (ptr_type->is_bit_pointer()) {
     auto pointee_type = ptr_type->get_pointee_type();
     if (!pointee_type->is<CustomIntType>()) {
-      if (stmt->dest->as<GetChStmt>()->input_snode->type ==
-          SNodeType::bit_struct) {
+      auto get_ch = stmt->dest->as<GetChStmt>();
+      if (get_ch->input_snode->type == SNodeType::bit_struct) {
         TI_ERROR(
             "Bit struct stores with type {} should have been "
             "handled by BitStructStoreStmt.",
             pointee_type->to_string());
+      }
+      auto cft = pointee_type->cast<CustomFloatType>();
+      TI_ERROR_IF(!cft, "Bit array only supports custom int and float types.");
+      if (cft->get_exponent_type()) {
+        update_bit_array_with_shared_exponent(
+            llvm_val[stmt->dest], get_ch->output_snode, llvm_val[stmt->val],
+            /*add=*/false, /*atomic=*/stmt->is_atomic);
       } else {
-        TI_ERROR("Bit array only supports custom int type.");
+        auto cit = cft->get_digits_type()->as<CustomIntType>();
+        store_custom_int(llvm_val[stmt->dest], cit,
+                         float_to_custom_int(cft, cit, llvm_val[stmt->val]),
+                         /*atomic=*/stmt->is_atomic);
       }
+      return;
     }
     llvm::Value *store_value = nullptr;
     auto *cit = pointee_type->as<CustomIntType>();
     store_value = llvm_val[stmt->val];
-    store_custom_int(llvm_val[stmt->dest], cit, store_value, /*atomic=*/true);
+    store_custom_int(llvm_val[stmt->dest], cit, store_value,
+                     /*atomic=*/stmt->is_atomic);
   } else {
     builder->CreateStore(llvm_val[stmt->val], llvm_val[stmt->dest]);
   }
@@ -1815,6 +1909,7 @@ void CodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt, bool spmd) {
     // ***********************
     // Begin loop_body_bb:
     builder->SetInsertPoint(loop_body_bb);
+    loop_iteration_begin = loop_body_bb;
 
     // initialize the coordinates
     auto new_coordinates = create_entry_block_alloca(physical_coordinate_ty);
@@ -1974,6 +2069,7 @@ void CodeGenLLVM::create_offload_struct_for(OffloadedStmt *stmt, bool spmd) {
   current_coordinates = nullptr;
   parent_coordinates = nullptr;
   block_corner_coordinates = nullptr;
+  loop_iteration_begin = nullptr;
 }
 
 void CodeGenLLVM::visit(LoopIndexStmt *stmt) {
@@ -2084,11 +2180,26 @@ void CodeGenLLVM::visit(AdStackAllocaStmt *stmt) {
   TI_ASSERT(stmt->width() == 1);
   TI_ASSERT_INFO(stmt->max_size > 0,
                  "Adaptive autodiff stack's size should have been determined.");
+  // |max_size| entries are stored inline; the rest spill to the per-thread
+  // AD-stack heap (see stack_push in runtime.cpp).
   auto type = llvm::ArrayType::get(llvm::Type::getInt8Ty(*llvm_context),
-                                   stmt->size_in_bytes());
+                                   taichi_ad_stack_header_size +
+                                       stmt->entry_size_in_bytes() *
+                                           stmt->max_size);
   auto alloca = create_entry_block_alloca(type, sizeof(int64));
-  llvm_val[stmt] = builder->CreateBitCast(
-      alloca, llvm::PointerType::getInt8PtrTy(*llvm_context));
+  {
+    // The pointer is created in the entry block, so that it dominates both
+    // stack_init_spill below and the uses of the stack in the body.
+    llvm::IRBuilderBase::InsertPointGuard guard(*builder);
+    builder->SetInsertPoint(entry_block);
+    llvm_val[stmt] = builder->CreateBitCast(
+        alloca, llvm::PointerType::getInt8PtrTy(*llvm_context));
+    if (ad_stack_heap_reset_block != entry_block) {
+      call("ad_stack_heap_reset", get_context());
+      ad_stack_heap_reset_block = entry_block;
+    }
+    call("stack_init_spill", llvm_val[stmt]);
+  }
   call("stack_init", llvm_val[stmt]);
 }
 
@@ -2098,9 +2209,11 @@ void CodeGenLLVM::visit(AdStackPopStmt *stmt) {
 
 void CodeGenLLVM::visit(AdStackPushStmt *stmt) {
   auto stack = stmt->stack->as<AdStackAllocaStmt>();
-  call("stack_push", llvm_val[stack], tlctx->get_constant(stack->max_size),
+  call("stack_push", get_context(), llvm_val[stack],
+       tlctx->get_constant(stack->max_size),
        tlctx->get_constant(stack->element_size_in_bytes()));
   auto primal_ptr = call("stack_top_primal", llvm_val[stack],
+                         tlctx->get_constant(stack->max_size),
                          tlctx->get_constant(stack->element_size_in_bytes()));
   primal_ptr = builder->CreateBitCast(
       primal_ptr,
@@ -2111,6 +2224,7 @@ void CodeGenLLVM::visit(AdStackPushStmt *stmt) {
 void CodeGenLLVM::visit(AdStackLoadTopStmt *stmt) {
   auto stack = stmt->stack->as<AdStackAllocaStmt>();
   auto primal_ptr = call("stack_top_primal", llvm_val[stack],
+                         tlctx->get_constant(stack->max_size),
                          tlctx->get_constant(stack->element_size_in_bytes()));
   primal_ptr = builder->CreateBitCast(
       primal_ptr,
@@ -2121,6 +2235,7 @@ void CodeGenLLVM::visit(AdStackLoadTopStmt *stmt) {
 void CodeGenLLVM::visit(AdStackLoadTopAdjStmt *stmt) {
   auto stack = stmt->stack->as<AdStackAllocaStmt>();
   auto adjoint = call("stack_top_adjoint", llvm_val[stack],
+                      tlctx->get_constant(stack->max_size),
                       tlctx->get_constant(stack->element_size_in_bytes()));
   adjoint = builder->CreateBitCast(
       adjoint, llvm::PointerType::get(tlctx->get_data_type(stmt->ret_type), 0));
@@ -2130,6 +2245,7 @@ void CodeGenLLVM::visit(AdStackLoadTopAdjStmt *stmt) {
 void CodeGenLLVM::visit(AdStackAccAdjointStmt *stmt) {
   auto stack = stmt->stack->as<AdStackAllocaStmt>();
   auto adjoint_ptr = call("stack_top_adjoint", llvm_val[stack],
+                          tlctx->get_constant(stack->max_size),
                           tlctx->get_constant(stack->element_size_in_bytes()));
   adjoint_ptr = builder->CreateBitCast(
       adjoint_ptr,
@@ -62,6 +62,13 @@ class CodeGenLLVM : public IRVisitor, public LLVMModuleBuilder {
   llvm::Value *parent_coordinates{nullptr};
   llvm::Value *block_corner_coordinates{nullptr};
   llvm::GlobalVariable *bls_buffer{nullptr};
+  // The entry block of the function that last reset the AD-stack heap
+  llvm::BasicBlock *ad_stack_heap_reset_block{nullptr};
+  // Where each iteration of the struct-for or mesh-for loop being generated
+  // begins, and the number of counter-based random numbers drawn in the
+  // current iteration (or function call) for each such block
+  llvm::BasicBlock *loop_iteration_begin{nullptr};
+  std::unordered_map<llvm::BasicBlock *, llvm::Value *> rand_counters;
   // Mainly for supporting continue stmt
   llvm::BasicBlock *current_loop_reentry;
   // Mainly for supporting break stmt
@@ -168,6 +175,12 @@ class CodeGenLLVM : public IRVisitor, public LLVMModuleBuilder {
 
   void visit(RandStmt *stmt) override;
 
+  // Index of the current iteration of the offloaded loop (i64)
+  llvm::Value *get_rand_stream();
+
+  // Counter of the random numbers drawn in the current loop iteration
+  llvm::Value *get_rand_counter();
+
   llvm::Value *cast_int(llvm::Value *input_val, Type *from, Type *to);
 
   virtual void emit_extra_unary(UnaryOpStmt *stmt);
@@ -246,6 +259,14 @@ class CodeGenLLVM : public IRVisitor, public LLVMModuleBuilder {
 
   void store_floats_with_shared_exponents(BitStructStoreStmt *stmt);
 
+  // Stores |value| to (or adds it to, if |add|) a custom float in a bit_array
+  // whose elements share an exponent. Returns the old value.
+  llvm::Value *update_bit_array_with_shared_exponent(llvm::Value *bit_ptr,
+                                                     SNode *digits_snode,
+                                                     llvm::Value *value,
+                                                     bool add,
+                                                     bool atomic);
+
   llvm::Value *reconstruct_float_from_bit_struct(llvm::Value *local_bit_struct,
                                                  SNode *digits);
 
@@ -375,6 +396,11 @@ class CodeGenLLVM : public IRVisitor, public LLVMModuleBuilder {
   llvm::Value *get_float_digits_with_shared_exponents(llvm::Value *f,
                                                       llvm::Value *shared_exp);
 
+  llvm::Value *get_custom_float_digits_with_shared_exponents(
+      llvm::Value *f,
+      llvm::Value *shared_exp,
+      CustomFloatType *cft);
+
   llvm::Value *get_exponent_offset(llvm::Value *exponent, CustomFloatType *cft);
 
   llvm::Value *atomic_op_using_cas(
@@ -373,36 +373,11 @@ void CodeGenLLVM::store_floats_with_shared_exponents(BitStructStoreStmt *stmt) {
     for (int c = 0; c < (int)exp->exponent_users.size(); c++) {
       auto user = exp->exponent_users[c];
       auto ch_id = snode->child_id(user);
-      auto digits =
-          get_float_digits_with_shared_exponents(floats[c], max_exp_bits);
       auto digits_snode = snode->ch[ch_id].get();
       auto cft = digits_snode->dt->as<CustomFloatType>();
       auto digits_bit_offset = digits_snode->bit_offset;
-
-      int right_shift_bits = 23 + cft->get_is_signed() - cft->get_digit_bits();
-      if (!cft->get_is_signed()) {
-        // unsigned
-        right_shift_bits += 1;
-      }
-
-      // round to nearest
-      digits = builder->CreateAdd(
-          digits, tlctx->get_constant(1 << (right_shift_bits - 1)));
-      // do not allow overflowing
-      digits =
-          create_call("min_u32", {digits, tlctx->get_constant((1u << 24) - 1)});
-
-      // Compress f32 digits to cft digits.
-      // Note that we need to keep the leading 1 bit so 24 instead of 23 in the
-      // following code.
-      digits = builder->CreateLShr(digits, right_shift_bits);
-      if (cft->get_is_signed()) {
-        auto float_bits = builder->CreateBitCast(
-            floats[c], llvm::Type::getInt32Ty(*llvm_context));
-        auto sign_bit = builder->CreateAnd(float_bits, 1 << 31);
-        sign_bit = builder->CreateLShr(sign_bit, 31 - cft->get_digit_bits());
-        digits = builder->CreateOr(digits, sign_bit);
-      }
+      auto digits = get_custom_float_digits_with_shared_exponents(
+          floats[c], max_exp_bits, cft);
 
       // store the digits
       val = builder->CreateZExt(digits, llvm_type(bit_struct_physical_type));
@@ -417,6 +392,101 @@ void CodeGenLLVM::store_floats_with_shared_exponents(BitStructStoreStmt *stmt) {
                stmt->is_atomic);
 }
 
+llvm::Value *CodeGenLLVM::update_bit_array_with_shared_exponent(
+    llvm::Value *bit_ptr,
+    SNode *digits_snode,
+    llvm::Value *value,
+    bool add,
+    bool atomic) {
+  // Changing one element may change the exponent shared by the container, so
+  // all of its elements are re-encoded and it is written as a whole.
+  auto bit_array = digits_snode->parent;
+  auto exp_snode = digits_snode->exp_snode;
+  auto cft = digits_snode->dt->as<CustomFloatType>();
+  auto digits_type = cft->get_digits_type()->as<CustomIntType>();
+  auto exponent_type = exp_snode->dt->as<CustomIntType>();
+  auto physical_type = bit_array->physical_type;
+  auto [byte_ptr, bit_offset] = load_bit_pointer(bit_ptr);
+  auto container_ptr =
+      builder->CreateBitCast(byte_ptr, llvm_ptr_type(physical_type));
+
+  llvm::BasicBlock *body = nullptr;
+  llvm::BasicBlock *after_loop = nullptr;
+  if (atomic) {
+    body = llvm::BasicBlock::Create(*llvm_context, "while_loop_body", func);
+    after_loop = llvm::BasicBlock::Create(*llvm_context, "after_while", func);
+    builder->CreateBr(body);
+    builder->SetInsertPoint(body);
+  }
+
+  // load all floats
+  auto old_container = builder->CreateLoad(container_ptr);
+  auto old_exponent = extract_custom_int(
+      old_container, tlctx->get_constant(exp_snode->bit_offset),
+      exponent_type);
+  std::vector<llvm::Value *> floats;
+  std::vector<llvm::Value *> is_updated;
+  llvm::Value *old_value = nullptr;
+  for (int i = 0; i < bit_array->num_cells_per_container; i++) {
+    auto offset = tlctx->get_constant(i * digits_type->get_num_bits());
+    auto digits = extract_custom_int(old_container, offset, digits_type);
+    floats.push_back(reconstruct_custom_float_with_exponent(
+        digits, old_exponent, cft, /*shared_exponent=*/true));
+    is_updated.push_back(builder->CreateICmpEQ(bit_offset, offset));
+    old_value = old_value ? builder->CreateSelect(is_updated[i], floats[i],
+                                                  old_value)
+                          : floats[i];
+  }
+  auto new_value =
+      builder->CreateFPCast(value, llvm_type(cft->get_compute_type()));
+  if (add) {
+    new_value = builder->CreateFAdd(old_value, new_value);
+  }
+
+  llvm::Value *max_exp_bits = nullptr;
+  for (int i = 0; i < (int)floats.size(); i++) {
+    floats[i] = builder->CreateSelect(is_updated[i], new_value, floats[i]);
+    auto exp_bits = extract_exponent_from_float(floats[i]);
+    if (max_exp_bits) {
+      max_exp_bits = create_call("max_u32", {max_exp_bits, exp_bits});
+    } else {
+      max_exp_bits = exp_bits;
+    }
+  }
+
+  // store the exponent
+  auto max_exp_bits_to_store = builder->CreateSub(
+      max_exp_bits, get_exponent_offset(max_exp_bits, cft));
+  max_exp_bits_to_store =
+      create_call("max_i32", {max_exp_bits_to_store, tlctx->get_constant(0)});
+  llvm::Value *new_container = builder->CreateIntCast(
+      max_exp_bits_to_store, llvm_type(physical_type), false);
+  new_container = builder->CreateShl(new_container, exp_snode->bit_offset);
+
+  // store the digits
+  for (int i = 0; i < (int)floats.size(); i++) {
+    auto digits = get_custom_float_digits_with_shared_exponents(
+        floats[i], max_exp_bits, cft);
+    auto val = builder->CreateIntCast(digits, llvm_type(physical_type), false);
+    val = builder->CreateShl(val, i * digits_type->get_num_bits());
+    new_container = builder->CreateOr(new_container, val);
+  }
+
+  if (atomic) {
+    auto atomic_cmp_xchg = builder->CreateAtomicCmpXchg(
+        container_ptr, old_container, new_container,
+        llvm::AtomicOrdering::SequentiallyConsistent,
+        llvm::AtomicOrdering::SequentiallyConsistent);
+    // Retry if the container was changed by others in the meantime
+    auto ok = builder->CreateExtractValue(atomic_cmp_xchg, 1);
+    builder->CreateCondBr(builder->CreateNot(ok), body, after_loop);
+    builder->SetInsertPoint(after_loop);
+  } else {
+    builder->CreateStore(new_container, container_ptr);
+  }
+  return old_value;
+}
+
 llvm::Value *CodeGenLLVM::extract_exponent_from_float(llvm::Value *f) {
   TI_ASSERT(f->getType() == llvm::Type::getFloatTy(*llvm_context));
   f = builder->CreateBitCast(f, llvm::Type::getInt32Ty(*llvm_context));
@@ -459,6 +529,39 @@ llvm::Value *CodeGenLLVM::get_float_digits_with_shared_exponents(
   return builder->CreateLShr(digits, exp_offset);
 }
 
+llvm::Value *CodeGenLLVM::get_custom_float_digits_with_shared_exponents(
+    llvm::Value *f,
+    llvm::Value *shared_exp,
+    CustomFloatType *cft) {
+  auto digits = get_float_digits_with_shared_exponents(f, shared_exp);
+
+  int right_shift_bits = 23 + cft->get_is_signed() - cft->get_digit_bits();
+  if (!cft->get_is_signed()) {
+    // unsigned
+    right_shift_bits += 1;
+  }
+
+  // round to nearest
+  digits = builder->CreateAdd(
+      digits, tlctx->get_constant(1 << (right_shift_bits - 1)));
+  // do not allow overflowing
+  digits =
+      create_call("min_u32", {digits, tlctx->get_constant((1u << 24) - 1)});
+
+  // Compress f32 digits to cft digits.
+  // Note that we need to keep the leading 1 bit so 24 instead of 23 in the
+  // following code.
+  digits = builder->CreateLShr(digits, right_shift_bits);
+  if (cft->get_is_signed()) {
+    auto float_bits =
+        builder->CreateBitCast(f, llvm::Type::getInt32Ty(*llvm_context));
+    auto sign_bit = builder->CreateAnd(float_bits, 1 << 31);
+    sign_bit = builder->CreateLShr(sign_bit, 31 - cft->get_digit_bits());
+    digits = builder->CreateOr(digits, sign_bit);
+  }
+  return digits;
+}
+
 llvm::Value *CodeGenLLVM::reconstruct_float_from_bit_struct(
     llvm::Value *local_bit_struct,
     SNode *digits_snode) {
@@ -658,8 +761,18 @@ llvm::Value *CodeGenLLVM::load_custom_float(Stmt *ptr_stmt) {
     auto exponent_snode = digits_snode->exp_snode;
     // Compute the bit pointer of the exponent bits.
     TI_ASSERT(digits_snode->parent == exponent_snode->parent);
-    auto exponent_bit_ptr = offset_bit_ptr(
-        digits_bit_ptr, exponent_snode->bit_offset - digits_snode->bit_offset);
+    llvm::Value *exponent_bit_ptr = nullptr;
+    if (ptr->input_snode->type == SNodeType::bit_array) {
+      // The exponent shared by the elements of a bit_array container follows
+      // all of their digits.
+      auto [byte_ptr, bit_offset] = load_bit_pointer(digits_bit_ptr);
+      exponent_bit_ptr = create_bit_ptr_struct(
+          byte_ptr, tlctx->get_constant(exponent_snode->bit_offset));
+    } else {
+      exponent_bit_ptr =
+          offset_bit_ptr(digits_bit_ptr, exponent_snode->bit_offset -
+                                             digits_snode->bit_offset);
+    }
     return load_custom_float_with_exponent(digits_bit_ptr, exponent_bit_ptr,
                                            cft,
                                            digits_snode->owns_shared_exponent);
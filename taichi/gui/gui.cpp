@@ -1,9 +1,116 @@
 #include "taichi/gui/gui.h"
 
+#include "taichi/system/threading.h"
+
 TI_NAMESPACE_BEGIN
 
 Vector2 Canvas::Line::vertices[128];
 
+namespace {
+
+// Batched primitives are binned into square screen tiles, and the tiles are
+// rasterized in parallel. Within a tile, primitives are drawn in their
+// original order, so overlapping primitives blend exactly as if they were
+// drawn one by one.
+constexpr int kTileSize = 64;
+// Fewer primitives are drawn serially without binning
+constexpr int kMinParallelPrimitives = 256;
+
+// Inclusive pixel ranges [x0, x1] x [y0, y1]
+struct PixelRect {
+  int x0, y0, x1, y1;
+
+  bool empty() const {
+    return x0 > x1 || y0 > y1;
+  }
+
+  PixelRect intersect(const PixelRect &o) const {
+    return {std::max(x0, o.x0), std::max(y0, o.y0), std::min(x1, o.x1),
+            std::min(y1, o.y1)};
+  }
+};
+
+// |bounds(i)| returns the pixels primitive i may touch, clipped to the image,
+// and |raster(i, rect)| draws primitive i restricted to |rect|.
+template <typename Bounds, typename Raster>
+void rasterize_tiled(const Array2D<Vector4> &img,
+                     int n,
+                     const Bounds &bounds,
+                     const Raster &raster) {
+  if (n < kMinParallelPrimitives) {
+    for (int i = 0; i < n; i++) {
+      const auto rect = bounds(i);
+      if (!rect.empty()) {
+        raster(i, rect);
+      }
+    }
+    return;
+  }
+  auto &pool = SharedThreadPool::get_instance();
+  const int tiles_x = (img.get_width() + kTileSize - 1) / kTileSize;
+  const int tiles_y = (img.get_height() + kTileSize - 1) / kTileSize;
+  const int num_tiles = tiles_x * tiles_y;
+  const int num_chunks = std::min(n, pool.num_threads() * 4);
+  auto chunk_begin = [&](int c) { return (int)((int64)n * c / num_chunks); };
+  auto for_each_tile = [&](const PixelRect &rect, auto &&func) {
+    for (int ty = rect.y0 / kTileSize; ty <= rect.y1 / kTileSize; ty++) {
+      for (int tx = rect.x0 / kTileSize; tx <= rect.x1 / kTileSize; tx++) {
+        func(ty * tiles_x + tx);
+      }
+    }
+  };
+
+  // Count the primitives of each chunk overlapping each tile...
+  std::vector<PixelRect> rects(n);
+  std::vector<int> offsets((std::size_t)num_chunks * num_tiles, 0);
+  pool.parallel_for(num_chunks, [&](int, int c) {
+    int *count = &offsets[(std::size_t)c * num_tiles];
+    for (int i = chunk_begin(c); i < chunk_begin(c + 1); i++) {
+      rects[i] = bounds(i);
+      if (!rects[i].empty()) {
+        for_each_tile(rects[i], [&](int t) { count[t]++; });
+      }
+    }
+  });
+  // ...so that the bin of a tile lists the chunks in order...
+  std::vector<int> tile_begin(num_tiles + 1);
+  int total = 0;
+  for (int t = 0; t < num_tiles; t++) {
+    tile_begin[t] = total;
+    for (int c = 0; c < num_chunks; c++) {
+      auto &offset = offsets[(std::size_t)c * num_tiles + t];
+      const int count = offset;
+      offset = total;
+      total += count;
+    }
+  }
+  tile_begin[num_tiles] = total;
+  // ...and each chunk fills its part of the bins in primitive order.
+  std::vector<int> bins(total);
+  pool.parallel_for(num_chunks, [&](int, int c) {
+    int *offset = &offsets[(std::size_t)c * num_tiles];
+    for (int i = chunk_begin(c); i < chunk_begin(c + 1); i++) {
+      if (!rects[i].empty()) {
+        for_each_tile(rects[i], [&](int t) { bins[offset[t]++] = i; });
+      }
+    }
+  });
+
+  pool.parallel_for(num_tiles, [&](int, int t) {
+    const int x0 = t % tiles_x * kTileSize;
+    const int y0 = t / tiles_x * kTileSize;
+    const PixelRect tile{x0, y0,
+                         std::min(x0 + kTileSize, img.get_width()) - 1,
+                         std::min(y0 + kTileSize, img.get_height()) - 1};
+    for (int k = tile_begin[t]; k < tile_begin[t + 1]; k++) {
+      const int i = bins[k];
+      raster(i, rects[i].intersect(tile));
+    }
+  });
+}
+
+}  // namespace
+
 void Canvas::triangles_batched(int n,
                                std::size_t a_,
                                std::size_t b_,
@@ -14,14 +121,60 @@ void Canvas::triangles_batched(int n,
   auto b = (real *)b_;
   auto c = (real *)c_;
   auto color_arr = (uint32 *)color_array;
+  struct Triangle {
+    Vector2 a, b, c;
+    Vector4 color;
+  };
+  std::vector<Triangle> triangles(n);
   for (int i = 0; i < n; i++) {
     auto clr = color_single;
     if (color_arr) {
       clr = color_arr[i];
     }
-    triangle_single(a[i * 2], a[i * 2 + 1], b[i * 2], b[i * 2 + 1], c[i * 2],
-                    c[i * 2 + 1], clr);
+    triangles[i] = {transform(Vector2(a[i * 2], a[i * 2 + 1])),
+                    transform(Vector2(b[i * 2], b[i * 2 + 1])),
+                    transform(Vector2(c[i * 2], c[i * 2 + 1])),
+                    color_from_hex(clr)};
   }
+  rasterize_tiled(
+      img, n,
+      [&](int i) {
+        const auto &tri = triangles[i];
+        // Same pixels as triangle()
+        return PixelRect{
+            std::max(0, (int)std::floor(min(tri.a.x, min(tri.b.x, tri.c.x)))),
+            std::max(0, (int)std::floor(min(tri.a.y, min(tri.b.y, tri.c.y)))),
+            std::min(img.get_width(),
+                     (int)std::ceil(max(tri.a.x, max(tri.b.x, tri.c.x)))) -
+                1,
+            std::min(img.get_height(),
+                     (int)std::ceil(max(tri.a.y, max(tri.b.y, tri.c.y)))) -
+                1};
+      },
+      [&](int i, const PixelRect &rect) {
+        const auto &tri = triangles[i];
+        auto inside = [&](int x, int y) {
+          Vector2 pixel(x + 0.5_f, y + 0.5_f);
+          bool inside_a = cross(pixel - tri.a, tri.b - tri.a) <= 0;
+          bool inside_b = cross(pixel - tri.b, tri.c - tri.b) <= 0;
+          bool inside_c = cross(pixel - tri.c, tri.a - tri.c) <= 0;
+          return (inside_a == inside_b) && (inside_a == inside_c);
+        };
+        // The pixels of a column inside a triangle are contiguous, so only
+        // the ends of the span are tested.
+        for (int x = rect.x0; x <= rect.x1; x++) {
+          int lo = rect.y0, hi = rect.y1;
+          while (lo <= hi && !inside(x, lo)) {
+            lo++;
+          }
+          while (hi > lo && !inside(x, hi)) {
+            hi--;
+          }
+          if (lo <= hi) {
+            std::fill(img[x] + lo, img[x] + hi + 1, tri.color);
+          }
+        }
+      });
 }
 
 void Canvas::paths_batched(int n,
@@ -35,6 +188,12 @@ void Canvas::paths_batched(int n,
   auto b = (real *)b_;
   auto color_arr = (uint32 *)color_array;
   auto radius_arr = (real *)radius_array;
+  struct Segment {
+    Vector2 a, b, direction, tangent;
+    real length, radius;
+    Vector4 color;
+  };
+  std::vector<Segment> segments(n);
   for (int i = 0; i < n; i++) {
     auto r = radius_single;
     if (radius_arr) {
@@ -45,9 +204,44 @@ void Canvas::paths_batched(int n,
       clr = color_arr[i];
     }
     // FIXME: path_single seems not displaying correct without the 1e-6 term:
-    path_single(a[i * 2], a[i * 2 + 1], b[i * 2] + 1e-6 * (i % 18 + 6),
-                b[i * 2 + 1], clr, r);
+    auto begin = transform(Vector2(a[i * 2], a[i * 2 + 1]));
+    auto end =
+        transform(Vector2(b[i * 2] + 1e-6 * (i % 18 + 6), b[i * 2 + 1]));
+    auto direction = normalized(end - begin);
+    segments[i] = {begin, end, direction, Vector2(-direction.y, direction.x),
+                   length(end - begin), r, color_from_hex(clr)};
   }
+  rasterize_tiled(
+      img, n,
+      [&](int i) {
+        const auto &seg = segments[i];
+        // Same pixels as Line::stroke()
+        auto a_i = (seg.a + Vector2(0.5_f)).cast<int>();
+        auto b_i = (seg.b + Vector2(0.5_f)).cast<int>();
+        auto radius_i = (int)std::ceil(seg.radius + 0.5_f);
+        return PixelRect{
+            std::max(0, std::min(a_i.x, b_i.x) - radius_i),
+            std::max(0, std::min(a_i.y, b_i.y) - radius_i),
+            std::min(img.get_width() - 1, std::max(a_i.x, b_i.x) + radius_i),
+            std::min(img.get_height() - 1, std::max(a_i.y, b_i.y) + radius_i)};
+      },
+      [&](int i, const PixelRect &rect) {
+        const auto &seg = segments[i];
+        for (int x = rect.x0; x <= rect.x1; x++) {
+          Vector4 *column = img[x];
+          for (int y = rect.y0; y <= rect.y1; y++) {
+            auto pixel_coord = Vector2(x + 0.5_f, y + 0.5_f) - seg.a;
+            auto u = dot(seg.tangent, pixel_coord);
+            auto v = dot(seg.direction, pixel_coord);
+            if (v > 0) {
+              v = std::max(0.0_f, v - seg.length);
+            }
+            real dist = std::sqrt(u * u + v * v);
+            auto alpha = seg.color.w * clamp(seg.radius - dist);
+            column[y] = lerp(alpha, column[y], seg.color);
+          }
+        }
+      });
 }
 
 void Canvas::circles_batched(int n,
@@ -59,6 +253,12 @@ void Canvas::circles_batched(int n,
   auto x = (real *)x_;
   auto color_arr = (uint32 *)color_array;
   auto radius_arr = (real *)radius_array;
+  struct Disk {
+    Vector2 center;
+    real radius;
+    Vector4 color;
+  };
+  std::vector<Disk> disks(n);
   for (int i = 0; i < n; i++) {
     auto r = radius_single;
     if (radius_arr) {
@@ -68,8 +268,48 @@ void Canvas::circles_batched(int n,
     if (color_arr) {
       c = color_arr[i];
     }
-    circle(x[i * 2], x[i * 2 + 1]).radius(r).color(c).finish();
+    disks[i] = {transform(Vector2(x[i * 2], x[i * 2 + 1])), r,
+                color_from_hex(c)};
   }
+  rasterize_tiled(
+      img, n,
+      [&](int i) {
+        const auto &disk = disks[i];
+        // Same pixels as Circle::finish()
+        const auto r = disk.radius;
+        return PixelRect{
+            std::max(0, (int)std::ceil(disk.center.x - r)),
+            std::max(0, (int)std::ceil(disk.center.y - r)),
+            std::min((int)std::floor(disk.center.x + r), img.get_width() - 1),
+            std::min((int)std::floor(disk.center.y + r),
+                     img.get_height() - 1)};
+      },
+      [&](int i, const PixelRect &rect) {
+        const auto &disk = disks[i];
+        const auto r = disk.radius;
+        for (int x = rect.x0; x <= rect.x1; x++) {
+          // Pixels at a distance of at least r are left unchanged, so only
+          // the span of the column within the circle, padded by a pixel
+          // against rounding, is blended.
+          const real dx = disk.center.x - x;
+          const real h2 = r * r - dx * dx;
+          if (h2 < 0) {
+            continue;
+          }
+          const real h = std::sqrt(h2);
+          const int lo =
+              std::max(rect.y0, (int)std::ceil(disk.center.y - h) - 1);
+          const int hi =
+              std::min(rect.y1, (int)std::floor(disk.center.y + h) + 1);
+          Vector4 *column = img[x];
+          for (int y = lo; y <= hi; y++) {
+            const real dy = disk.center.y - y;
+            real dist = std::sqrt(dx * dx + dy * dy);
+            auto alpha = disk.color.w * clamp(r - dist);
+            column[y] = lerp(alpha, column[y], disk.color);
+          }
+        }
+      });
 }
 
 void Canvas::circle_single(real x, real y, uint32 color, real radius) {
@@ -817,6 +817,12 @@ class GUI : public GUIBase {
 
   void redraw();
 
+#if defined(TI_GUI_X11)
+  // Copies the pixels shown in the window into |data|, as 0x00RRGGBB rows
+  // from the top.
+  void get_window_image(uint32 *data);
+#endif
+
   void set_title(std::string title);
 
   void redraw_widgets() {
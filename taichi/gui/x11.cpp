@@ -4,7 +4,13 @@
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
 #include <cstdlib>
+#include <cstring>
+
+#include "taichi/util/environ_config.h"
 
 // Undo terrible unprefixed macros in X.h
 #ifdef None
@@ -16,47 +22,201 @@
 
 TI_NAMESPACE_BEGIN
 
+namespace {
+
+// Rows are pushed to the server in bands of this many rows, and only the
+// columns of a band that changed since the last frame are pushed.
+constexpr int kDamageBandHeight = 16;
+
+bool shm_attach_failed = false;
+
+int shm_attach_error_handler(Display *, XErrorEvent *) {
+  shm_attach_failed = true;
+  return 0;
+}
+
+}  // namespace
+
+// The pixels of the window as 0x00RRGGBB, the layout of a 24-bit ZPixmap
+// and of fast_gui buffers. When the MIT-SHM extension is available, the
+// pixels live in a segment shared with the X server, which then reads them
+// without copying them through the socket.
 class CXImage {
  public:
-  XImage *image;
-  std::vector<uint8> image_data;
-  void *fast_data{nullptr};
+  Display *display;
+  XImage *image{nullptr};
+  XShmSegmentInfo shm_info;
+  bool use_shm{false};
+  std::vector<uint32> image_data;
+  uint32 *pixels;
   int width, height;
+  // Dirty columns [damage_begin, damage_end) of each band of rows
+  std::vector<int> damage_begin, damage_end;
 
   CXImage(Display *display, Visual *visual, int width, int height)
-      : width(width), height(height) {
-    image_data.resize(width * height * 4);
-    image = XCreateImage(display, visual, 24, ZPixmap, 0,
-                         (char *)image_data.data(), width, height, 32, 0);
-    TI_ASSERT((void *)image->data == image_data.data());
+      : display(display), width(width), height(height) {
+    if (lang::get_environ_config("TI_GUI_X11_SHM", 1)) {
+      use_shm = create_shm_image(visual);
+    }
+    if (!use_shm) {
+      image_data.resize(width * height);
+      image = XCreateImage(display, visual, 24, ZPixmap, 0,
+                           (char *)image_data.data(), width, height, 32, 0);
+    }
+    TI_ASSERT(image->bits_per_pixel == 32 &&
+              image->bytes_per_line == width * 4);
+    pixels = (uint32 *)image->data;
+    const int num_bands = (height + kDamageBandHeight - 1) / kDamageBandHeight;
+    damage_begin.resize(num_bands);
+    damage_end.resize(num_bands);
+    invalidate();
+  }
+
+  bool create_shm_image(Visual *visual) {
+    if (!XShmQueryExtension(display)) {
+      return false;
+    }
+    image = XShmCreateImage(display, visual, 24, ZPixmap, nullptr, &shm_info,
+                            width, height);
+    if (!image) {
+      return false;
+    }
+    shm_info.shmid = shmget(IPC_PRIVATE, image->bytes_per_line * height,
+                            IPC_CREAT | 0600);
+    if (shm_info.shmid < 0) {
+      XDestroyImage(image);
+      image = nullptr;
+      return false;
+    }
+    shm_info.shmaddr = (char *)shmat(shm_info.shmid, nullptr, 0);
+    if (shm_info.shmaddr == (char *)-1) {
+      shmctl(shm_info.shmid, IPC_RMID, nullptr);
+      XDestroyImage(image);
+      image = nullptr;
+      return false;
+    }
+    image->data = shm_info.shmaddr;
+    shm_info.readOnly = False;
+    // Attaching fails asynchronously, e.g. on remote displays, so the error
+    // is caught by a temporary handler.
+    shm_attach_failed = false;
+    auto old_handler = XSetErrorHandler(shm_attach_error_handler);
+    bool attached = XShmAttach(display, &shm_info);
+    XSync(display, False);
+    XSetErrorHandler(old_handler);
+    // The segment is freed once both sides have detached
+    shmctl(shm_info.shmid, IPC_RMID, nullptr);
+    if (attached && !shm_attach_failed) {
+      return true;
+    }
+    shmdt(shm_info.shmaddr);
+    image->data = nullptr;
+    XDestroyImage(image);
+    image = nullptr;
+    return false;
   }
 
-  CXImage(Display *display,
-          Visual *visual,
-          void *fast_data,
-          int width,
-          int height)
-      : width(width), height(height) {
-    image = XCreateImage(display, visual, 24, ZPixmap, 0, (char *)fast_data,
-                         width, height, 32, 0);
-    TI_ASSERT((void *)image->data == fast_data);
+  void invalidate() {
+    std::fill(damage_begin.begin(), damage_begin.end(), 0);
+    std::fill(damage_end.begin(), damage_end.end(), width);
   }
 
   void set_data(const Array2D<Vector4> &color) {
-    auto p = image_data.data();
-    for (int j = 0; j < height; j++) {
+    // Bands of rows are converted column by column, so that both the
+    // column-major canvas and the row-major image are read and written in
+    // short contiguous runs.
+    for (int band = 0; band < (int)damage_begin.size(); band++) {
+      const int j_begin = band * kDamageBandHeight;
+      const int j_end = std::min(height, j_begin + kDamageBandHeight);
+      int &x_begin = damage_begin[band];
+      int &x_end = damage_end[band];
       for (int i = 0; i < width; i++) {
-        auto c = color[i][height - j - 1];
-        *p++ = uint8(clamp(int(c[2] * 255.0_f), 0, 255));
-        *p++ = uint8(clamp(int(c[1] * 255.0_f), 0, 255));
-        *p++ = uint8(clamp(int(c[0] * 255.0_f), 0, 255));
-        *p++ = 0;
+        const Vector4 *column = color[i];
+        bool changed = false;
+        for (int j = j_begin; j < j_end; j++) {
+          auto c = column[height - j - 1];
+          const uint32 pixel =
+              (uint32(clamp(int(c[0] * 255.0_f), 0, 255)) << 16) |
+              (uint32(clamp(int(c[1] * 255.0_f), 0, 255)) << 8) |
+              uint32(clamp(int(c[2] * 255.0_f), 0, 255));
+          uint32 &dest = pixels[j * width + i];
+          changed |= dest != pixel;
+          dest = pixel;
+        }
+        if (changed) {
+          x_begin = std::min(x_begin, i);
+          x_end = std::max(x_end, i + 1);
+        }
       }
     }
   }
 
+  // fast_gui buffers are already in the layout of the image, and are copied
+  // without any conversion.
+  void set_fast_data(const uint32 *data) {
+    for (int j = 0; j < height; j++) {
+      const uint32 *src = data + j * width;
+      uint32 *dest = pixels + j * width;
+      int begin = 0, end = width;
+      while (begin < end && src[begin] == dest[begin]) {
+        begin++;
+      }
+      while (end > begin && src[end - 1] == dest[end - 1]) {
+        end--;
+      }
+      if (begin < end) {
+        std::memcpy(dest + begin, src + begin, (end - begin) * sizeof(uint32));
+        const int band = j / kDamageBandHeight;
+        damage_begin[band] = std::min(damage_begin[band], begin);
+        damage_end[band] = std::max(damage_end[band], end);
+      }
+    }
+  }
+
+  // Pushes the damaged part of the image to |window|.
+  void present(Window window, GC gc) {
+    const int num_bands = (int)damage_begin.size();
+    bool pushed = false;
+    for (int band = 0; band < num_bands;) {
+      if (damage_begin[band] >= damage_end[band]) {
+        band++;
+        continue;
+      }
+      // A run of damaged bands is pushed as a single rectangle
+      const int first = band;
+      int x_begin = damage_begin[band], x_end = damage_end[band];
+      while (++band < num_bands && damage_begin[band] < damage_end[band]) {
+        x_begin = std::min(x_begin, damage_begin[band]);
+        x_end = std::max(x_end, damage_end[band]);
+      }
+      const int y_begin = first * kDamageBandHeight;
+      const int y_end = std::min(height, band * kDamageBandHeight);
+      if (use_shm) {
+        XShmPutImage(display, window, gc, image, x_begin, y_begin, x_begin,
+                     y_begin, x_end - x_begin, y_end - y_begin, False);
+      } else {
+        XPutImage(display, window, gc, image, x_begin, y_begin, x_begin,
+                  y_begin, x_end - x_begin, y_end - y_begin);
+      }
+      pushed = true;
+    }
+    std::fill(damage_begin.begin(), damage_begin.end(), width);
+    std::fill(damage_end.begin(), damage_end.end(), 0);
+    if (pushed && use_shm) {
+      // The server reads the segment asynchronously, so wait until it is
+      // done before the next frame writes into it.
+      XSync(display, False);
+    }
+  }
+
   ~CXImage() {
-    delete image;  // image->data is automatically released in image_data
+    if (use_shm) {
+      XShmDetach(display, &shm_info);
+      shmdt(shm_info.shmaddr);
+    }
+    // image->data is released by image_data or shmdt
+    image->data = nullptr;
+    XDestroyImage(image);
   }
 };
 
@@ -87,6 +247,7 @@ void GUI::process_event() {
     XNextEvent((Display *)display, &ev);
     switch (ev.type) {
       case Expose:
+        img->invalidate();
         break;
       case ClientMessage:
         // https://stackoverflow.com/questions/10792361/how-do-i-gracefully-exit-an-x11-event-loop
@@ -177,18 +338,27 @@ void GUI::create_window() {
   XSetWMProtocols((Display *)display, window, (Atom *)wmDeleteMessage.data(),
                   1);
   XMapWindow((Display *)display, window);
-  if (!fast_gui)
-    img = new CXImage((Display *)display, (Visual *)visual, width, height);
-  else
-    img = new CXImage((Display *)display, (Visual *)visual, (void *)fast_buf,
-                      width, height);
+  img = new CXImage((Display *)display, (Visual *)visual, width, height);
 }
 
 void GUI::redraw() {
   if (!fast_gui)
     img->set_data(buffer);
-  XPutImage((Display *)display, window, DefaultGC(display, 0), img->image, 0, 0,
-            0, 0, width, height);
+  else
+    img->set_fast_data((const uint32 *)fast_buf);
+  img->present(window, DefaultGC(display, 0));
+}
+
+void GUI::get_window_image(uint32 *data) {
+  XImage *image = XGetImage((Display *)display, window, 0, 0, width, height,
+                            AllPlanes, ZPixmap);
+  TI_ASSERT(image);
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i++) {
+      data[j * width + i] = XGetPixel(image, i, j) & 0xFFFFFF;
+    }
+  }
+  XDestroyImage(image);
 }
 
 void GUI::set_title(std::string title) {
@@ -197,8 +367,8 @@ void GUI::set_title(std::string title) {
 
 GUI::~GUI() {
   if (show_gui) {
-    XCloseDisplay((Display *)display);
     delete img;
+    XCloseDisplay((Display *)display);
   }
 }
 
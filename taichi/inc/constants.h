@@ -26,6 +26,11 @@ constexpr std::size_t taichi_result_buffer_runtime_query_id = 2;
 
 constexpr int taichi_listgen_max_element_size = 1024;
 
+// LLVM AD-stacks: header size in bytes, and the minimal size of the per-thread
+// region that overflowing entries spill into
+constexpr std::size_t taichi_ad_stack_header_size = 24;
+constexpr std::size_t taichi_ad_stack_heap_min_size = 64 * 1024;
+
 template <typename T, typename G>
 T taichi_union_cast_with_different_sizes(G g) {
   union {
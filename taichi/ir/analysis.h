@@ -105,7 +105,9 @@ std::pair<std::unordered_set<SNode *>, std::unordered_set<SNode *>>
 gather_snode_read_writes(IRNode *root);
 std::vector<Stmt *> gather_statements(IRNode *root,
                                       const std::function<bool(Stmt *)> &test);
-void gather_uniquely_accessed_bit_structs(IRNode *root, AnalysisManager *amgr);
+void gather_uniquely_accessed_bit_structs(IRNode *root,
+                                          const CompileConfig &config,
+                                          AnalysisManager *amgr);
 std::unordered_map<const SNode *, GlobalPtrStmt *>
 gather_uniquely_accessed_pointers(IRNode *root);
 std::unique_ptr<std::unordered_set<AtomicOpStmt *>> gather_used_atomics(
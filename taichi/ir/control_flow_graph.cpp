@@ -1,15 +1,134 @@
 #include "taichi/ir/control_flow_graph.h"
 
+#include <algorithm>
+#include <functional>
 #include <queue>
 #include <unordered_set>
 
 #include "taichi/ir/analysis.h"
 #include "taichi/ir/statements.h"
 #include "taichi/system/profiler.h"
+#include "taichi/util/bit.h"
 
 namespace taichi {
 namespace lang {
 
+namespace {
+
+using bit::Bitset;
+
+// Reverse postorder of a depth-first search from |entry| along |successors|,
+// followed by the nodes unreachable from |entry| in their original order.
+std::vector<int> reverse_postorder(
+    const std::vector<std::vector<int>> &successors,
+    int entry) {
+  const int num_nodes = successors.size();
+  std::vector<int> order;
+  std::vector<bool> visited(num_nodes, false);
+  // (node, index of the next successor to visit)
+  std::vector<std::pair<int, int>> stack;
+  stack.emplace_back(entry, 0);
+  visited[entry] = true;
+  while (!stack.empty()) {
+    const int node = stack.back().first;
+    const int next = stack.back().second++;
+    if (next < (int)successors[node].size()) {
+      const int succ = successors[node][next];
+      if (!visited[succ]) {
+        visited[succ] = true;
+        stack.emplace_back(succ, 0);
+      }
+    } else {
+      order.push_back(node);
+      stack.pop_back();
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  for (int i = 0; i < num_nodes; i++) {
+    if (!visited[i]) {
+      order.push_back(i);
+    }
+  }
+  return order;
+}
+
+/**
+ * Solve the dataflow equations
+ *   in[i] = union of out[j] for all j in predecessors[i],
+ *   out[i] = gen[i] | (in[i] & ~kill[i]),
+ * over bitsets of |universe_size| elements with the worklist algorithm,
+ * visiting the nodes in reverse postorder from |entry|. For a backward
+ * analysis, swap |predecessors| and |successors|.
+ *
+ * |killed(i, e)| tells if node i kills element e. It is only evaluated for
+ * the elements reaching node i, at most once each.
+ */
+void solve_dataflow(const std::vector<std::vector<int>> &predecessors,
+                    const std::vector<std::vector<int>> &successors,
+                    int entry,
+                    int universe_size,
+                    const std::vector<Bitset> &gen,
+                    const std::function<bool(int, int)> &killed,
+                    std::vector<Bitset> &in,
+                    std::vector<Bitset> &out) {
+  const int num_nodes = predecessors.size();
+  const auto order = reverse_postorder(successors, entry);
+  std::vector<int> priority(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    priority[order[i]] = i;
+  }
+  // The elements of |in| whose "killed" property is computed, and those of
+  // them not killed by the node.
+  std::vector<Bitset> known(num_nodes, Bitset(universe_size));
+  std::vector<Bitset> transparent(num_nodes, Bitset(universe_size));
+  in.assign(num_nodes, Bitset(universe_size));
+  out = gen;
+
+  std::priority_queue<int, std::vector<int>, std::greater<int>> to_visit;
+  std::vector<bool> in_queue(num_nodes, true);
+  for (int i = 0; i < num_nodes; i++) {
+    to_visit.push(i);
+  }
+  while (!to_visit.empty()) {
+    const int now = order[to_visit.top()];
+    to_visit.pop();
+    in_queue[now] = false;
+
+    in[now].reset();
+    for (auto prev : predecessors[now]) {
+      in[now] |= out[prev];
+    }
+    for (auto element : known[now].or_eq_get_update_list(in[now])) {
+      if (!killed(now, element)) {
+        transparent[now][element] = true;
+      }
+    }
+    Bitset new_out = in[now];
+    new_out &= transparent[now];
+    new_out |= gen[now];
+    if (new_out != out[now]) {
+      out[now] = std::move(new_out);
+      for (auto next : successors[now]) {
+        if (!in_queue[next]) {
+          to_visit.push(priority[next]);
+          in_queue[next] = true;
+        }
+      }
+    }
+  }
+}
+
+std::unordered_set<Stmt *> to_stmt_set(const Bitset &bits,
+                                       const std::vector<Stmt *> &stmts) {
+  std::unordered_set<Stmt *> result;
+  for (int i = bits.find_first_one(); i != -1; i = bits.lower_bound(i + 1)) {
+    result.insert(stmts[i]);
+  }
+  return result;
+}
+
+}  // namespace
+
 CFGNode::CFGNode(Block *block,
                  int begin_location,
                  int end_location,
@@ -562,6 +681,25 @@ CFGNode *ControlFlowGraph::back() const {
   return nodes.back().get();
 }
 
+void ControlFlowGraph::get_edges(std::vector<std::vector<int>> &prev,
+                                 std::vector<std::vector<int>> &next) const {
+  const int num_nodes = size();
+  std::unordered_map<CFGNode *, int> node_ids;
+  for (int i = 0; i < num_nodes; i++) {
+    node_ids[nodes[i].get()] = i;
+  }
+  prev.assign(num_nodes, {});
+  next.assign(num_nodes, {});
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto prev_node : nodes[i]->prev) {
+      prev[i].push_back(node_ids[prev_node]);
+    }
+    for (auto next_node : nodes[i]->next) {
+      next[i].push_back(node_ids[next_node]);
+    }
+  }
+}
+
 void ControlFlowGraph::print_graph_structure() const {
   const int num_nodes = size();
   std::cout << "Control Flow Graph with " << num_nodes
@@ -616,8 +754,6 @@ void ControlFlowGraph::print_graph_structure() const {
 void ControlFlowGraph::reaching_definition_analysis(bool after_lower_access) {
   TI_AUTO_PROF;
   const int num_nodes = size();
-  std::queue<CFGNode *> to_visit;
-  std::unordered_map<CFGNode *, bool> in_queue;
   TI_ASSERT(nodes[start_node]->empty());
   nodes[start_node]->reach_gen.clear();
   nodes[start_node]->reach_kill.clear();
@@ -643,52 +779,47 @@ void ControlFlowGraph::reaching_definition_analysis(bool after_lower_access) {
     if (i != start_node) {
       nodes[i]->reaching_definition_analysis(after_lower_access);
     }
-    nodes[i]->reach_in.clear();
-    nodes[i]->reach_out = nodes[i]->reach_gen;
-    to_visit.push(nodes[i].get());
-    in_queue[nodes[i].get()] = true;
   }
 
-  // The worklist algorithm.
-  while (!to_visit.empty()) {
-    auto now = to_visit.front();
-    to_visit.pop();
-    in_queue[now] = false;
-
-    now->reach_in.clear();
-    for (auto prev_node : now->prev) {
-      now->reach_in.insert(prev_node->reach_out.begin(),
-                           prev_node->reach_out.end());
-    }
-    auto old_out = std::move(now->reach_out);
-    now->reach_out = now->reach_gen;
-    for (auto stmt : now->reach_in) {
-      auto store_ptrs = irpass::analysis::get_store_destination(stmt);
-      bool killed;
-      if (store_ptrs.empty()) {  // the case of a global pointer
-        killed = now->reach_kill_variable(stmt);
-      } else {
-        killed = true;
-        for (auto store_ptr : store_ptrs) {
-          if (!now->reach_kill_variable(store_ptr)) {
-            killed = false;
-            break;
-          }
-        }
-      }
-      if (!killed) {
-        now->reach_out.insert(stmt);
+  // Number the definitions densely.
+  std::vector<Stmt *> stmts;
+  std::unordered_map<Stmt *, int> stmt_ids;
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto stmt : nodes[i]->reach_gen) {
+      if (stmt_ids.emplace(stmt, (int)stmts.size()).second) {
+        stmts.push_back(stmt);
       }
     }
-    if (now->reach_out != old_out) {
-      // changed
-      for (auto next_node : now->next) {
-        if (!in_queue[next_node]) {
-          to_visit.push(next_node);
-          in_queue[next_node] = true;
-        }
+  }
+  const int num_stmts = stmts.size();
+  std::vector<Bitset> gen(num_nodes, Bitset(num_stmts));
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto stmt : nodes[i]->reach_gen) {
+      gen[i][stmt_ids[stmt]] = true;
+    }
+  }
+  std::vector<std::vector<int>> prev, next;
+  get_edges(prev, next);
+
+  auto killed = [&](int node, int stmt_id) {
+    auto now = nodes[node].get();
+    auto stmt = stmts[stmt_id];
+    auto store_ptrs = irpass::analysis::get_store_destination(stmt);
+    if (store_ptrs.empty()) {  // the case of a global pointer
+      return now->reach_kill_variable(stmt);
+    }
+    for (auto store_ptr : store_ptrs) {
+      if (!now->reach_kill_variable(store_ptr)) {
+        return false;
       }
     }
+    return true;
+  };
+  std::vector<Bitset> in, out;
+  solve_dataflow(prev, next, start_node, num_stmts, gen, killed, in, out);
+  for (int i = 0; i < num_nodes; i++) {
+    nodes[i]->reach_in = to_stmt_set(in[i], stmts);
+    nodes[i]->reach_out = to_stmt_set(out[i], stmts);
   }
 }
 
@@ -697,8 +828,6 @@ void ControlFlowGraph::live_variable_analysis(
     const std::optional<LiveVarAnalysisConfig> &config_opt) {
   TI_AUTO_PROF;
   const int num_nodes = size();
-  std::queue<CFGNode *> to_visit;
-  std::unordered_map<CFGNode *, bool> in_queue;
   TI_ASSERT(nodes[final_node]->empty());
   nodes[final_node]->live_gen.clear();
   nodes[final_node]->live_kill.clear();
@@ -733,45 +862,42 @@ void ControlFlowGraph::live_variable_analysis(
       }
     }
   }
-  for (int i = num_nodes - 1; i >= 0; i--) {
-    // push into the queue in reversed order to make it slightly faster
+  for (int i = 0; i < num_nodes; i++) {
     if (i != final_node) {
       nodes[i]->live_variable_analysis(after_lower_access);
     }
-    nodes[i]->live_out.clear();
-    nodes[i]->live_in = nodes[i]->live_gen;
-    to_visit.push(nodes[i].get());
-    in_queue[nodes[i].get()] = true;
   }
 
-  // The worklist algorithm.
-  while (!to_visit.empty()) {
-    auto now = to_visit.front();
-    to_visit.pop();
-    in_queue[now] = false;
-
-    now->live_out.clear();
-    for (auto next_node : now->next) {
-      now->live_out.insert(next_node->live_in.begin(),
-                           next_node->live_in.end());
-    }
-    auto old_in = std::move(now->live_in);
-    now->live_in = now->live_gen;
-    for (auto stmt : now->live_out) {
-      if (!CFGNode::contain_variable(now->live_kill, stmt)) {
-        now->live_in.insert(stmt);
+  // Number the variables densely.
+  std::vector<Stmt *> vars;
+  std::unordered_map<Stmt *, int> var_ids;
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto var : nodes[i]->live_gen) {
+      if (var_ids.emplace(var, (int)vars.size()).second) {
+        vars.push_back(var);
       }
     }
-    if (now->live_in != old_in) {
-      // changed
-      for (auto prev_node : now->prev) {
-        if (!in_queue[prev_node]) {
-          to_visit.push(prev_node);
-          in_queue[prev_node] = true;
-        }
-      }
+  }
+  const int num_vars = vars.size();
+  std::vector<Bitset> gen(num_nodes, Bitset(num_vars));
+  for (int i = 0; i < num_nodes; i++) {
+    for (auto var : nodes[i]->live_gen) {
+      gen[i][var_ids[var]] = true;
     }
   }
+  std::vector<std::vector<int>> prev, next;
+  get_edges(prev, next);
+
+  auto killed = [&](int node, int var_id) {
+    return CFGNode::contain_variable(nodes[node]->live_kill, vars[var_id]);
+  };
+  // This is a backward analysis.
+  std::vector<Bitset> out, in;
+  solve_dataflow(next, prev, final_node, num_vars, gen, killed, out, in);
+  for (int i = 0; i < num_nodes; i++) {
+    nodes[i]->live_in = to_stmt_set(in[i], vars);
+    nodes[i]->live_out = to_stmt_set(out[i], vars);
+  }
 }
 
 void ControlFlowGraph::simplify_graph() {
@@ -38,10 +38,14 @@ class CFGNode {
 
   // Reaching definition analysis
   // https://en.wikipedia.org/wiki/Reaching_definition
+  // The analysis itself runs on bitsets; |reach_in| and |reach_out| are
+  // only filled in with the results.
   std::unordered_set<Stmt *> reach_gen, reach_kill, reach_in, reach_out;
 
   // Live variable analysis
   // https://en.wikipedia.org/wiki/Live_variable_analysis
+  // The analysis itself runs on bitsets; |live_in| and |live_out| are only
+  // filled in with the results.
   std::unordered_set<Stmt *> live_gen, live_kill, live_in, live_out;
 
   CFGNode(Block *block,
@@ -87,6 +91,10 @@ class ControlFlowGraph {
   // Erase an empty node.
   void erase(int node_id);
 
+  // Get the edges in the graph in terms of node indices.
+  void get_edges(std::vector<std::vector<int>> &prev,
+                 std::vector<std::vector<int>> &next) const;
+
  public:
   struct LiveVarAnalysisConfig {
     // This is mostly useful for SFG task-level dead store elimination. SFG may
@@ -110,8 +118,8 @@ class ControlFlowGraph {
   void print_graph_structure() const;
 
   /**
-   * Perform reaching definition analysis using the worklist algorithm,
-   * and store the results in CFGNodes.
+   * Perform reaching definition analysis using the worklist algorithm in
+   * reverse postorder, and store the results in CFGNodes.
    * https://en.wikipedia.org/wiki/Reaching_definition
    *
    * @param after_lower_access
@@ -120,8 +128,9 @@ class ControlFlowGraph {
   void reaching_definition_analysis(bool after_lower_access);
 
   /**
-   * Perform live variable analysis using the worklist algorithm,
-   * and store the results in CFGNodes.
+   * Perform live variable analysis using the worklist algorithm in
+   * reverse postorder of the reversed graph, and store the results in
+   * CFGNodes.
    * https://en.wikipedia.org/wiki/Live_variable_analysis
    *
    * @param after_lower_access
@@ -18,6 +18,8 @@ std::string snode_access_flag_name(SNodeAccessFlag type) {
     return "read_only";
   } else if (type == SNodeAccessFlag::mesh_local) {
     return "mesh_local";
+  } else if (type == SNodeAccessFlag::f64_accumulator) {
+    return "f64_accumulator";
   } else {
     TI_ERROR("Undefined SNode AccessType (value={})", int(type));
   }
@@ -121,6 +123,14 @@ bool StmtFieldManager::equal(StmtFieldManager &other) const {
   return true;
 }
 
+std::size_t StmtFieldManager::hash() const {
+  std::size_t result = fields.size();
+  for (auto &field : fields) {
+    result = result * 100000007UL + field->hash();
+  }
+  return result;
+}
+
 std::atomic<int> Stmt::instance_id_counter(0);
 
 Stmt::Stmt() : field_manager(this), fields_registered(false) {
@@ -13,6 +13,7 @@
 #include "taichi/ir/snode.h"
 #include "taichi/ir/mesh.h"
 #include "taichi/ir/type_factory.h"
+#include "taichi/system/small_object_allocator.h"
 #include "taichi/util/short_name.h"
 
 namespace taichi {
@@ -28,7 +29,12 @@ class SNode;
 class Kernel;
 struct CompileConfig;
 
-enum class SNodeAccessFlag : int { block_local, read_only, mesh_local };
+enum class SNodeAccessFlag : int {
+  block_local,
+  read_only,
+  mesh_local,
+  f64_accumulator
+};
 std::string snode_access_flag_name(SNodeAccessFlag type);
 
 class MemoryAccessOptions {
@@ -197,7 +203,9 @@ class IRVisitor {
 struct CompileConfig;
 class Kernel;
 
-class IRNode {
+// IR nodes are allocated from SmallObjectAllocator since a kernel creates,
+// clones and erases many of them during compilation.
+class IRNode : public SmallObject {
  public:
   Kernel *kernel;
 
@@ -303,6 +311,16 @@ struct LaneAttribute {
     return data[i];
   }
 
+  // Combines the hashes of the lanes. Only defined if T has hash().
+  template <typename U = T>
+  auto hash() const -> decltype(std::declval<const U &>().hash()) {
+    std::size_t result = data.size();
+    for (const auto &t : data) {
+      result = result * 100000007UL + t.hash();
+    }
+    return result;
+  }
+
   LaneAttribute slice(int begin, int end) {
     return LaneAttribute(
         std::vector<T>(data.begin() + begin, data.begin() + end));
@@ -383,15 +401,35 @@ struct LaneAttribute {
   }
 };
 
-class StmtField {
+class StmtField : public SmallObject {
  public:
   StmtField() = default;
 
   virtual bool equal(const StmtField *other) const = 0;
 
+  // Fields that are equal() must have the same hash.
+  virtual std::size_t hash() const = 0;
+
   virtual ~StmtField() = default;
 };
 
+template <typename T, typename = void>
+struct has_hash_method : std::false_type {};
+
+template <typename T>
+struct has_hash_method<T,
+                       std::void_t<decltype(std::declval<const T &>().hash())>>
+    : std::true_type {};
+
+template <typename T, typename = void>
+struct is_std_hashable : std::false_type {};
+
+template <typename T>
+struct is_std_hashable<
+    T,
+    std::void_t<decltype(std::hash<T>{}(std::declval<const T &>()))>>
+    : std::true_type {};
+
 template <typename T>
 class StmtFieldNumeric final : public StmtField {
  private:
@@ -423,6 +461,22 @@ class StmtFieldNumeric final : public StmtField {
       return false;
     }
   }
+
+  std::size_t hash() const override {
+    const T &v = std::holds_alternative<T *>(value) ? *std::get<T *>(value)
+                                                     : std::get<T>(value);
+    using V = std::decay_t<T>;
+    if constexpr (std::is_same<V, DataType>::value) {
+      // Types are uniquely owned by the TypeFactory.
+      return std::hash<const Type *>{}(v);
+    } else if constexpr (has_hash_method<V>::value) {
+      return v.hash();
+    } else if constexpr (is_std_hashable<V>::value) {
+      return std::hash<V>{}(v);
+    } else {
+      return 0;
+    }
+  }
 };
 
 class StmtFieldSNode final : public StmtField {
@@ -436,6 +490,10 @@ class StmtFieldSNode final : public StmtField {
   static int get_snode_id(SNode *snode);
 
   bool equal(const StmtField *other_generic) const override;
+
+  std::size_t hash() const override {
+    return (std::size_t)get_snode_id(snode);
+  }
 };
 
 class StmtFieldMemoryAccessOptions final : public StmtField {
@@ -448,6 +506,10 @@ class StmtFieldMemoryAccessOptions final : public StmtField {
   }
 
   bool equal(const StmtField *other_generic) const override;
+
+  std::size_t hash() const override {
+    return 0;
+  }
 };
 
 class StmtFieldManager {
@@ -475,6 +537,8 @@ class StmtFieldManager {
   }
 
   bool equal(StmtFieldManager &other) const;
+
+  std::size_t hash() const;
 };
 
 #define TI_STMT_DEF_FIELDS(...) TI_IO_DEF(__VA_ARGS__)
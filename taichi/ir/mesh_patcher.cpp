@@ -0,0 +1,749 @@
+#include "taichi/ir/mesh_patcher.h"
+
+#include <algorithm>
+#include <array>
+
+#include "taichi/system/threading.h"
+
+namespace taichi {
+namespace lang {
+namespace mesh {
+namespace {
+
+// Global relation from each element of one type to elements of another
+struct Csr {
+  std::vector<int> offset;
+  std::vector<int> value;
+
+  int size() const {
+    return (int)offset.size() - 1;
+  }
+
+  const int *begin(int i) const {
+    return value.data() + offset[i];
+  }
+
+  const int *end(int i) const {
+    return value.data() + offset[i + 1];
+  }
+
+  int degree(int i) const {
+    return offset[i + 1] - offset[i];
+  }
+};
+
+Csr make_fixed_csr(std::vector<int> value, int stride) {
+  Csr csr;
+  const int n = (int)value.size() / stride;
+  csr.offset.resize(n + 1);
+  for (int i = 0; i <= n; i++) {
+    csr.offset[i] = i * stride;
+  }
+  csr.value = std::move(value);
+  return csr;
+}
+
+void sort_unique(std::vector<int> &v) {
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+}
+
+// Number of lower-order elements of a higher-order element, which is the
+// stride of a high-to-low relation
+int fixed_relation_size(int from_order, int to_order) {
+  if (from_order == element_order(MeshElementType::Cell) &&
+      to_order == element_order(MeshElementType::Edge)) {
+    return 6;
+  }
+  return from_order + 1;
+}
+
+// Open-addressing hash map from global to local element indices of a patch,
+// reused by a thread across patches
+class LocalIndexMap {
+ public:
+  void clear() {
+    std::fill(keys_.begin(), keys_.end(), -1);
+    size_ = 0;
+  }
+
+  // Returns false if |key| is already present.
+  bool insert(int key, int value) {
+    if ((size_ + 1) * 2 > (int)keys_.size()) {
+      grow();
+    }
+    const auto slot = find_slot(key);
+    if (keys_[slot] == key) {
+      return false;
+    }
+    keys_[slot] = key;
+    values_[slot] = value;
+    size_++;
+    return true;
+  }
+
+  int find(int key) const {
+    if (keys_.empty()) {
+      return -1;
+    }
+    const auto slot = find_slot(key);
+    return keys_[slot] == key ? values_[slot] : -1;
+  }
+
+ private:
+  std::size_t find_slot(int key) const {
+    const std::size_t mask = keys_.size() - 1;
+    std::size_t slot = (uint32(key) * 2654435761u) >> (32 - bits_);
+    while (keys_[slot] != -1 && keys_[slot] != key) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void grow() {
+    auto keys = std::move(keys_);
+    auto values = std::move(values_);
+    bits_ = std::max(bits_ + 1, 6);
+    keys_.assign(std::size_t(1) << bits_, -1);
+    values_.resize(keys_.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      if (keys[i] != -1) {
+        const auto slot = find_slot(keys[i]);
+        keys_[slot] = keys[i];
+        values_[slot] = values[i];
+      }
+    }
+  }
+
+  int bits_{0};
+  int size_{0};
+  std::vector<int> keys_;
+  std::vector<int> values_;
+};
+
+class MeshPatcher {
+ public:
+  MeshPatcher(MeshTopology topology,
+              int num_vertices,
+              const std::vector<int> &indices,
+              int num_threads)
+      : top_order_(int(topology) - 1),
+        num_threads_(num_threads),
+        pool_(num_threads) {
+    const int k = int(topology);
+    TI_ERROR_IF(indices.empty() || indices.size() % k != 0,
+                "Mesh indices must be a non-empty array of {} vertex indices "
+                "per element",
+                k);
+    for (auto v : indices) {
+      TI_ERROR_IF(v < 0 || v >= num_vertices,
+                  "Mesh vertex index {} out of range [0, {})", v,
+                  num_vertices);
+    }
+    num_[0] = num_vertices;
+    num_[top_order_] = (int)indices.size() / k;
+    set_relation(top_order_, 0, make_fixed_csr(indices, k));
+    build_elements();
+  }
+
+  MeshPatches run(const std::vector<MeshRelationType> &relations,
+                  int patch_size) {
+    for (auto rel : relations) {
+      TI_ERROR_IF(from_end_element_order(rel) > top_order_ ||
+                      to_end_element_order(rel) > top_order_,
+                  "Relation {} is not available in this mesh",
+                  relation_type_name(rel));
+      get_relation(from_end_element_order(rel), to_end_element_order(rel));
+    }
+    relations_ = relations;
+    sort_unique_relations();
+
+    partition(patch_size);
+    assign_owners();
+    gather_ghosts();
+
+    MeshPatches result;
+    result.num_patches = num_patches_;
+    for (int o = 0; o <= top_order_; o++) {
+      result.elements[MeshElementType(o)] = build_element(o);
+    }
+    for (auto rel : relations_) {
+      result.relations[rel] = build_relation(
+          from_end_element_order(rel), to_end_element_order(rel), result);
+    }
+    return result;
+  }
+
+ private:
+  template <typename Func>
+  void parallel_for(int n, const Func &func) {
+    pool_.parallel_for(n, num_threads_, func);
+  }
+
+  void set_relation(int from, int to, Csr csr) {
+    rel_[from * 4 + to] = std::move(csr);
+    built_[from * 4 + to] = true;
+  }
+
+  const Csr &get_relation(int from, int to) {
+    const int id = from * 4 + to;
+    if (!built_[id]) {
+      if (from < to) {
+        set_relation(from, to, inverse(get_relation(to, from), num_[from]));
+      } else if (from == to) {
+        set_relation(from, to, adjacency(from));
+      } else {
+        TI_ERROR("High-to-low relation {} is not built",
+                 relation_type_name(relation_by_orders(from, to)));
+      }
+    }
+    return rel_[id];
+  }
+
+  void sort_unique_relations() {
+    std::sort(relations_.begin(), relations_.end());
+    relations_.erase(std::unique(relations_.begin(), relations_.end()),
+                     relations_.end());
+  }
+
+  // Builds the edges (and the faces of a tetrahedron mesh) together with all
+  // the high-to-low relations.
+  void build_elements() {
+    const int top = top_order_;
+    if (top == element_order(MeshElementType::Face)) {
+      // Triangle mesh
+      auto fe = build_sub_elements(1, {{0, 1}, {1, 2}, {2, 0}},
+                                   /*keep_orientation=*/false);
+      set_relation(2, 1, make_fixed_csr(std::move(fe), 3));
+    } else {
+      auto ce = build_sub_elements(
+          1, {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}},
+          /*keep_orientation=*/false);
+      set_relation(3, 1, make_fixed_csr(std::move(ce), 6));
+      // The i-th face is opposite to the i-th vertex, and the faces are
+      // oriented consistently with the cell they come from.
+      auto cf = build_sub_elements(
+          2, {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}},
+          /*keep_orientation=*/true);
+      set_relation(3, 2, make_fixed_csr(std::move(cf), 4));
+      // Faces to edges
+      const auto &fv = rel_[2 * 4 + 0];
+      std::vector<int> fe(num_[2] * 3);
+      parallel_for(num_[2], [&](int, int f) {
+        const int *v = fv.begin(f);
+        for (int j = 0; j < 3; j++) {
+          fe[f * 3 + j] = find_edge(v[j], v[(j + 1) % 3]);
+        }
+      });
+      set_relation(2, 1, make_fixed_csr(std::move(fe), 3));
+    }
+  }
+
+  // Deduplicates the sub-elements of the top-level elements, which are given
+  // by the local vertex indices |local|. Returns the relation from the
+  // top-level elements to the sub-elements, and sets the relation from the
+  // sub-elements to the vertices, which follows the first top-level element
+  // containing a sub-element if |keep_orientation|, or is sorted otherwise.
+  std::vector<int> build_sub_elements(
+      int order,
+      const std::vector<std::vector<int>> &local,
+      bool keep_orientation) {
+    const auto &top_v = rel_[top_order_ * 4 + 0];
+    const int num_local = (int)local.size();
+    const int k = (int)local[0].size();
+    const int num_refs = num_[top_order_] * num_local;
+    auto sorted_key = [&](int ref) {
+      std::array<int, 3> key{0, 0, 0};
+      const int *v = top_v.begin(ref / num_local);
+      for (int j = 0; j < k; j++) {
+        key[j] = v[local[ref % num_local][j]];
+      }
+      std::sort(key.begin(), key.begin() + k);
+      return key;
+    };
+
+    // Bucket the references to sub-elements by their smallest vertex
+    std::vector<int> first_ref(num_[0] + 1, 0);
+    for (int r = 0; r < num_refs; r++) {
+      first_ref[sorted_key(r)[0] + 1]++;
+    }
+    for (int v = 0; v < num_[0]; v++) {
+      first_ref[v + 1] += first_ref[v];
+    }
+    std::vector<int> refs(num_refs);
+    {
+      auto head = first_ref;
+      for (int r = 0; r < num_refs; r++) {
+        refs[head[sorted_key(r)[0]]++] = r;
+      }
+    }
+
+    // Sort each bucket by the other vertices, so that the lowest reference to
+    // a sub-element comes first, and count the distinct sub-elements
+    std::vector<int> first_id(num_[0] + 1, 0);
+    std::vector<std::vector<std::pair<uint64, int>>> scratch(num_threads_);
+    parallel_for(num_[0], [&](int thread_id, int v) {
+      auto &bucket = scratch[thread_id];
+      bucket.clear();
+      for (int i = first_ref[v]; i < first_ref[v + 1]; i++) {
+        const auto key = sorted_key(refs[i]);
+        bucket.emplace_back((uint64(key[1]) << 32) | uint64(key[2]), refs[i]);
+      }
+      std::sort(bucket.begin(), bucket.end());
+      int count = 0;
+      for (int i = 0; i < (int)bucket.size(); i++) {
+        if (i == 0 || bucket[i].first != bucket[i - 1].first) {
+          count++;
+        }
+        refs[first_ref[v] + i] = bucket[i].second;
+      }
+      first_id[v + 1] = count;
+    });
+    for (int v = 0; v < num_[0]; v++) {
+      first_id[v + 1] += first_id[v];
+    }
+    num_[order] = first_id[num_[0]];
+
+    std::vector<int> top_sub(num_refs);
+    std::vector<int> sub_v(num_[order] * k);
+    parallel_for(num_[0], [&](int, int v) {
+      int id = first_id[v] - 1;
+      std::array<int, 3> last_key{-1, -1, -1};
+      for (int i = first_ref[v]; i < first_ref[v + 1]; i++) {
+        const int r = refs[i];
+        const auto key = sorted_key(r);
+        if (key != last_key) {
+          id++;
+          for (int j = 0; j < k; j++) {
+            sub_v[id * k + j] =
+                keep_orientation
+                    ? top_v.begin(r / num_local)[local[r % num_local][j]]
+                    : key[j];
+          }
+          last_key = key;
+        }
+        top_sub[r] = id;
+      }
+    });
+    set_relation(order, 0, make_fixed_csr(std::move(sub_v), k));
+    if (order == 1) {
+      // Edges are numbered by their sorted vertices
+      edge_first_id_ = std::move(first_id);
+    }
+    return top_sub;
+  }
+
+  int find_edge(int a, int b) const {
+    if (a > b) {
+      std::swap(a, b);
+    }
+    const auto &ev = rel_[1 * 4 + 0];
+    int lo = edge_first_id_[a], hi = edge_first_id_[a + 1];
+    while (lo < hi) {
+      const int mid = (lo + hi) / 2;
+      if (ev.begin(mid)[1] < b) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    TI_ASSERT(lo < edge_first_id_[a + 1] && ev.begin(lo)[1] == b);
+    return lo;
+  }
+
+  static Csr inverse(const Csr &rel, int num_to) {
+    Csr inv;
+    inv.offset.assign(num_to + 1, 0);
+    for (auto x : rel.value) {
+      inv.offset[x + 1]++;
+    }
+    for (int i = 0; i < num_to; i++) {
+      inv.offset[i + 1] += inv.offset[i];
+    }
+    inv.value.resize(rel.value.size());
+    auto head = inv.offset;
+    for (int i = 0; i < rel.size(); i++) {
+      for (auto it = rel.begin(i); it != rel.end(i); ++it) {
+        inv.value[head[*it]++] = i;
+      }
+    }
+    return inv;
+  }
+
+  // Vertices sharing an edge, or higher-order elements sharing a
+  // lower-order element of the next order.
+  Csr adjacency(int order) {
+    const int bridge = order == 0 ? 1 : order - 1;
+    const auto &to_bridge = get_relation(order, bridge);
+    const auto &from_bridge = get_relation(bridge, order);
+    std::vector<std::vector<int>> scratch(num_threads_);
+    auto neighbors = [&](int thread_id, int x) -> std::vector<int> & {
+      auto &result = scratch[thread_id];
+      result.clear();
+      for (auto b = to_bridge.begin(x); b != to_bridge.end(x); ++b) {
+        for (auto y = from_bridge.begin(*b); y != from_bridge.end(*b); ++y) {
+          if (*y != x) {
+            result.push_back(*y);
+          }
+        }
+      }
+      sort_unique(result);
+      return result;
+    };
+
+    Csr adj;
+    adj.offset.assign(num_[order] + 1, 0);
+    parallel_for(num_[order], [&](int thread_id, int x) {
+      adj.offset[x + 1] = (int)neighbors(thread_id, x).size();
+    });
+    for (int i = 0; i < num_[order]; i++) {
+      adj.offset[i + 1] += adj.offset[i];
+    }
+    adj.value.resize(adj.offset.back());
+    parallel_for(num_[order], [&](int thread_id, int x) {
+      const auto &result = neighbors(thread_id, x);
+      std::copy(result.begin(), result.end(),
+                adj.value.begin() + adj.offset[x]);
+    });
+    return adj;
+  }
+
+  // Recursively bisects the dual graph of the top-level elements until the
+  // parts fit in a patch. A part is split in the middle of its breadth-first
+  // order from a pseudo-peripheral element, which keeps the halves compact.
+  // The parts of one level are split in parallel, and the patches are
+  // numbered in the order of the leaves so that nearby patches get nearby
+  // indices.
+  void partition(int patch_size) {
+    TI_ERROR_IF(patch_size <= 0, "Mesh patch size must be positive");
+    const int n = num_[top_order_];
+    const auto &dual = get_relation(top_order_, top_order_);
+
+    struct Part {
+      std::vector<int> elements;
+      uint64 path{0};  // Left-aligned branches taken from the root
+      int depth{0};
+    };
+    std::vector<Part> parts(1), leaves;
+    parts[0].elements.resize(n);
+    for (int i = 0; i < n; i++) {
+      parts[0].elements[i] = i;
+    }
+    // Index of the part containing each element in the current level, or -1
+    // if the element is in a leaf.
+    std::vector<int> part_of(n, 0);
+    // Only written by the part containing the element
+    std::vector<char> visited(n, 0);
+    while (!parts.empty()) {
+      std::vector<Part> children(parts.size() * 2);
+      parallel_for((int)parts.size(), [&](int, int id) {
+        const auto &part = parts[id].elements;
+        if ((int)part.size() <= patch_size) {
+          return;
+        }
+        std::vector<int> order;
+        order.reserve(part.size());
+        // Breadth-first order from |seed| followed by the components not
+        // connected to it. Returns the size of the component of |seed|.
+        auto bfs = [&](int seed) {
+          order.clear();
+          for (auto x : part) {
+            visited[x] = 0;
+          }
+          std::size_t seed_component_size = 0;
+          for (int i = -1; i < (int)part.size(); i++) {
+            const int s = i < 0 ? seed : part[i];
+            if (visited[s]) {
+              continue;
+            }
+            visited[s] = 1;
+            std::size_t head = order.size();
+            order.push_back(s);
+            for (; head < order.size(); head++) {
+              const int x = order[head];
+              for (auto y = dual.begin(x); y != dual.end(x); ++y) {
+                if (part_of[*y] == id && !visited[*y]) {
+                  visited[*y] = 1;
+                  order.push_back(*y);
+                }
+              }
+            }
+            if (i < 0) {
+              seed_component_size = order.size();
+            }
+          }
+          return seed_component_size;
+        };
+        bfs(order[bfs(part[0]) - 1]);
+
+        const int num_patches =
+            ((int)part.size() + patch_size - 1) / patch_size;
+        const int left_size = num_patches / 2 * patch_size;
+        for (int side = 0; side < 2; side++) {
+          auto &child = children[id * 2 + side];
+          child.elements.assign(
+              side == 0 ? order.begin() : order.begin() + left_size,
+              side == 0 ? order.begin() + left_size : order.end());
+          child.depth = parts[id].depth + 1;
+          TI_ASSERT(child.depth < 64);
+          child.path = parts[id].path | (uint64(side) << (64 - child.depth));
+        }
+      });
+
+      std::vector<Part> next;
+      for (int id = 0; id < (int)parts.size(); id++) {
+        if ((int)parts[id].elements.size() <= patch_size) {
+          for (auto x : parts[id].elements) {
+            part_of[x] = -1;
+          }
+          leaves.push_back(std::move(parts[id]));
+        } else {
+          next.push_back(std::move(children[id * 2]));
+          next.push_back(std::move(children[id * 2 + 1]));
+        }
+      }
+      parts = std::move(next);
+      parallel_for((int)parts.size(), [&](int, int id) {
+        for (auto x : parts[id].elements) {
+          part_of[x] = id;
+        }
+      });
+    }
+
+    std::sort(leaves.begin(), leaves.end(),
+              [](const Part &a, const Part &b) { return a.path < b.path; });
+    num_patches_ = (int)leaves.size();
+    patch_of_top_.resize(n);
+    for (int p = 0; p < num_patches_; p++) {
+      for (auto x : leaves[p].elements) {
+        patch_of_top_[x] = p;
+      }
+    }
+  }
+
+  // Each element is owned by the first patch containing a top-level element
+  // incident to it, and is numbered by its owner in the reordered index
+  // space.
+  void assign_owners() {
+    for (int o = 0; o <= top_order_; o++) {
+      auto &owner = owner_[o];
+      if (o == top_order_) {
+        owner = patch_of_top_;
+      } else {
+        const auto &up = get_relation(o, top_order_);
+        owner.assign(num_[o], 0);
+        parallel_for(num_[o], [&](int, int x) {
+          int patch = up.degree(x) ? num_patches_ : 0;
+          for (auto t = up.begin(x); t != up.end(x); ++t) {
+            patch = std::min(patch, patch_of_top_[*t]);
+          }
+          owner[x] = patch;
+        });
+      }
+
+      auto &owned_offsets = owned_offsets_[o];
+      owned_offsets.assign(num_patches_ + 1, 0);
+      for (auto p : owner) {
+        owned_offsets[p + 1]++;
+      }
+      for (int p = 0; p < num_patches_; p++) {
+        owned_offsets[p + 1] += owned_offsets[p];
+      }
+      auto head = owned_offsets;
+      auto &owned = owned_[o];
+      auto &g2r = g2r_[o];
+      owned.resize(num_[o]);
+      g2r.resize(num_[o]);
+      for (int x = 0; x < num_[o]; x++) {
+        g2r[x] = head[owner[x]]++;
+        owned[g2r[x]] = x;
+      }
+    }
+  }
+
+  // Ghost elements of a patch are the elements reachable from its owned
+  // elements through the relations, plus the lower-order elements of its
+  // higher-order ghost elements.
+  void gather_ghosts() {
+    for (int o = 0; o <= top_order_; o++) {
+      ghosts_[o].assign(num_patches_, {});
+    }
+    std::vector<std::array<LocalIndexMap, 4>> seen(num_threads_);
+    parallel_for(num_patches_, [&](int thread_id, int p) {
+      std::array<std::vector<int>, 4> candidates;
+      for (auto &s : seen[thread_id]) {
+        s.clear();
+      }
+      auto add = [&](int to, int y) {
+        if (owner_[to][y] != p && seen[thread_id][to].insert(y, 0)) {
+          candidates[to].push_back(y);
+        }
+      };
+      for (auto rel : relations_) {
+        const int from = from_end_element_order(rel);
+        const int to = to_end_element_order(rel);
+        const auto &csr = rel_[from * 4 + to];
+        for (int i = owned_offsets_[from][p]; i < owned_offsets_[from][p + 1];
+             i++) {
+          const int x = owned_[from][i];
+          for (auto y = csr.begin(x); y != csr.end(x); ++y) {
+            add(to, *y);
+          }
+        }
+      }
+      for (int from = top_order_; from >= 0; from--) {
+        std::sort(candidates[from].begin(), candidates[from].end());
+        ghosts_[from][p] = std::move(candidates[from]);
+        for (auto rel : relations_) {
+          const int to = to_end_element_order(rel);
+          if (from_end_element_order(rel) != from || to >= from) {
+            continue;
+          }
+          const auto &csr = rel_[from * 4 + to];
+          for (auto x : ghosts_[from][p]) {
+            for (auto y = csr.begin(x); y != csr.end(x); ++y) {
+              add(to, *y);
+            }
+          }
+        }
+      }
+    });
+  }
+
+  MeshPatchElement build_element(int o) {
+    MeshPatchElement e;
+    e.num = num_[o];
+    e.owned_offsets = owned_offsets_[o];
+    e.g2r = g2r_[o];
+    e.total_offsets.assign(num_patches_ + 1, 0);
+    for (int p = 0; p < num_patches_; p++) {
+      const int total = owned_offsets_[o][p + 1] - owned_offsets_[o][p] +
+                        (int)ghosts_[o][p].size();
+      e.max_num_per_patch = std::max(e.max_num_per_patch, total);
+      e.total_offsets[p + 1] = e.total_offsets[p] + total;
+    }
+    e.l2g.resize(e.total_offsets.back());
+    e.l2r.resize(e.total_offsets.back());
+    parallel_for(num_patches_, [&](int, int p) {
+      const int owned_begin = owned_offsets_[o][p];
+      const int owned_end = owned_offsets_[o][p + 1];
+      int i = e.total_offsets[p];
+      for (int j = owned_begin; j < owned_end; j++, i++) {
+        e.l2g[i] = owned_[o][j];
+        e.l2r[i] = j;
+      }
+      for (auto x : ghosts_[o][p]) {
+        e.l2g[i] = x;
+        e.l2r[i] = g2r_[o][x];
+        i++;
+      }
+    });
+    return e;
+  }
+
+  MeshPatchRelation build_relation(int from,
+                                   int to,
+                                   const MeshPatches &patches) {
+    MeshPatchRelation result;
+    const auto &csr = rel_[from * 4 + to];
+    const auto &from_element = patches.elements.at(MeshElementType(from));
+    const auto &to_element = patches.elements.at(MeshElementType(to));
+    std::vector<LocalIndexMap> local_index(num_threads_);
+    auto build_local_index = [&](int thread_id, int p) -> LocalIndexMap & {
+      auto &index = local_index[thread_id];
+      index.clear();
+      const int begin = to_element.total_offsets[p];
+      for (int i = begin; i < to_element.total_offsets[p + 1]; i++) {
+        index.insert(to_element.l2g[i], i - begin);
+      }
+      return index;
+    };
+    auto find = [](const LocalIndexMap &index, int x) {
+      const int i = index.find(x);
+      TI_ASSERT(i != -1);
+      return i;
+    };
+
+    if (from > to) {
+      const int k = fixed_relation_size(from, to);
+      result.value.resize(from_element.l2g.size() * k);
+      parallel_for(num_patches_, [&](int thread_id, int p) {
+        const auto &index = build_local_index(thread_id, p);
+        for (int i = from_element.total_offsets[p];
+             i < from_element.total_offsets[p + 1]; i++) {
+          const int x = from_element.l2g[i];
+          TI_ASSERT(csr.degree(x) == k);
+          for (int j = 0; j < k; j++) {
+            result.value[i * k + j] = find(index, csr.begin(x)[j]);
+          }
+        }
+      });
+      return result;
+    }
+
+    std::vector<int> value_offsets(num_patches_ + 1, 0);
+    parallel_for(num_patches_, [&](int, int p) {
+      int count = 0;
+      for (int i = owned_offsets_[from][p]; i < owned_offsets_[from][p + 1];
+           i++) {
+        count += csr.degree(owned_[from][i]);
+      }
+      value_offsets[p + 1] = count;
+    });
+    for (int p = 0; p < num_patches_; p++) {
+      value_offsets[p + 1] += value_offsets[p];
+    }
+    result.value.resize(value_offsets.back());
+    result.offset.resize(num_[from] + num_patches_);
+    parallel_for(num_patches_, [&](int thread_id, int p) {
+      const auto &index = build_local_index(thread_id, p);
+      const int base = owned_offsets_[from][p] + p;
+      int v = value_offsets[p];
+      int i = owned_offsets_[from][p];
+      for (; i < owned_offsets_[from][p + 1]; i++) {
+        result.offset[base + i - owned_offsets_[from][p]] = v;
+        const int x = owned_[from][i];
+        for (auto y = csr.begin(x); y != csr.end(x); ++y) {
+          result.value[v++] = find(index, *y);
+        }
+      }
+      result.offset[base + i - owned_offsets_[from][p]] = v;
+    });
+    return result;
+  }
+
+  const int top_order_;
+  const int num_threads_;
+  ThreadPool pool_;
+  std::array<int, 4> num_{0, 0, 0, 0};
+  std::array<Csr, 16> rel_;
+  std::array<bool, 16> built_{};
+  std::vector<int> edge_first_id_;
+  std::vector<MeshRelationType> relations_;
+
+  int num_patches_{0};
+  std::vector<int> patch_of_top_;
+  std::array<std::vector<int>, 4> owner_;
+  std::array<std::vector<int>, 4> owned_offsets_;
+  std::array<std::vector<int>, 4> owned_;  // global indices by reordered index
+  std::array<std::vector<int>, 4> g2r_;
+  std::array<std::vector<std::vector<int>>, 4> ghosts_;
+};
+
+}  // namespace
+
+MeshPatches build_mesh_patches(MeshTopology topology,
+                               int num_vertices,
+                               const std::vector<int> &indices,
+                               const std::vector<MeshRelationType> &relations,
+                               int patch_size,
+                               int num_threads) {
+  TI_AUTO_PROF;
+  MeshPatcher patcher(topology, num_vertices, indices,
+                      std::max(1, num_threads));
+  return patcher.run(relations, patch_size);
+}
+
+}  // namespace mesh
+}  // namespace lang
+}  // namespace taichi
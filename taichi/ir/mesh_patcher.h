@@ -0,0 +1,52 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "taichi/ir/mesh.h"
+
+namespace taichi {
+namespace lang {
+namespace mesh {
+
+// Patched index spaces of one element type, in the layout expected by
+// MeshMetadata (see python/taichi/lang/mesh.py). Within patch p, the
+// elements owned by the patch come first, followed by its ghost elements.
+struct MeshPatchElement {
+  int num{0};
+  int max_num_per_patch{0};
+  std::vector<int> owned_offsets;  // num_patches + 1
+  std::vector<int> total_offsets;  // num_patches + 1
+  std::vector<int> l2g;            // local to global
+  std::vector<int> l2r;            // local to reordered
+  std::vector<int> g2r;            // global to reordered
+};
+
+// Patch-local relation. For a high-to-low relation, |value| holds a fixed
+// number of entries for every (owned or ghost) element and |offset| is empty.
+// Otherwise |offset| holds owned_num + 1 entries per patch indexing |value|.
+struct MeshPatchRelation {
+  std::vector<int> value;
+  std::vector<int> offset;
+};
+
+struct MeshPatches {
+  int num_patches{0};
+  std::map<MeshElementType, MeshPatchElement> elements;
+  std::map<MeshRelationType, MeshPatchRelation> relations;
+};
+
+// Builds the edges (and faces) of a triangle or tetrahedron mesh given by
+// |indices| (3 or 4 vertex indices per element), partitions its elements
+// into patches of at most |patch_size| top-level elements, and builds the
+// patch-local |relations|, using |num_threads| threads.
+MeshPatches build_mesh_patches(MeshTopology topology,
+                               int num_vertices,
+                               const std::vector<int> &indices,
+                               const std::vector<MeshRelationType> &relations,
+                               int patch_size,
+                               int num_threads);
+
+}  // namespace mesh
+}  // namespace lang
+}  // namespace taichi
@@ -131,6 +131,30 @@ SNode &SNode::dynamic(const Axis &expr, int n, int chunk_size, bool packed) {
   return snode;
 }
 
+SNode &SNode::morton(bool val) {
+  TI_ERROR_IF(val && type != SNodeType::dense,
+              "Only dense SNodes can be stored in Morton order, got {}.",
+              type_name());
+  _morton = val;
+  return *this;
+}
+
+int SNode::morton_num_bits() const {
+  if (!_morton) {
+    return 0;
+  }
+  int num_axes = 0;
+  int num_bits = std::numeric_limits<int>::max();
+  for (int i = 0; i < taichi_max_num_indices; i++) {
+    if (extractors[i].active) {
+      num_axes++;
+      num_bits = std::min(num_bits, extractors[i].num_bits);
+    }
+  }
+  // Interleaving a single axis is the identity
+  return num_axes < 2 ? 0 : num_bits;
+}
+
 SNode &SNode::bit_struct(int num_bits, bool packed) {
   auto &snode = create_node({}, {}, SNodeType::bit_struct, packed);
   snode.physical_type =
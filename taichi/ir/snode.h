@@ -247,10 +247,14 @@ class SNode {
 
   SNode &dynamic(const Axis &expr, int n, int chunk_size, bool packed);
 
-  SNode &morton(bool val = true) {
-    _morton = val;
-    return *this;
-  }
+  // Stores the cells of a dense SNode in Morton (Z) order instead of
+  // row-major order. Not supported in packed mode.
+  SNode &morton(bool val = true);
+
+  // The number of low bits of each index that a Morton-ordered SNode
+  // interleaves, i.e., the cells are stored as a row-major grid of Z-order
+  // tiles of 2^morton_num_bits() cells per axis. 0 if nothing is interleaved.
+  int morton_num_bits() const;
 
   int child_id(SNode *c) {
     for (int i = 0; i < (int)ch.size(); i++) {
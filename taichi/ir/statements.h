@@ -533,6 +533,10 @@ class GlobalStoreStmt : public Stmt {
  public:
   Stmt *dest;
   Stmt *val;
+  // Only for stores to custom ints in bit_arrays: whether the physical word
+  // has to be updated atomically, i.e., whether other threads may store to
+  // other elements of the same word.
+  bool is_atomic{true};
 
   GlobalStoreStmt(Stmt *dest, Stmt *val) : dest(dest), val(val) {
     TI_STMT_REG_FIELDS;
@@ -542,7 +546,7 @@ class GlobalStoreStmt : public Stmt {
     return false;
   }
 
-  TI_STMT_DEF_FIELDS(ret_type, dest, val);
+  TI_STMT_DEF_FIELDS(ret_type, dest, val, is_atomic);
   TI_DEFINE_ACCEPT_AND_CLONE;
 };
 
@@ -729,6 +733,7 @@ class RangeForStmt : public Stmt {
   int num_cpu_threads;
   int block_dim;
   bool strictly_serialized;
+  MemoryAccessOptions mem_access_opt;
 
   RangeForStmt(Stmt *begin,
                Stmt *end,
@@ -756,7 +761,8 @@ class RangeForStmt : public Stmt {
                      bit_vectorize,
                      num_cpu_threads,
                      block_dim,
-                     strictly_serialized);
+                     strictly_serialized,
+                     mem_access_opt);
   TI_DEFINE_ACCEPT
 };
 
@@ -36,9 +36,15 @@ bool cfg_optimization(
     bool after_lower_access,
     const std::optional<ControlFlowGraph::LiveVarAnalysisConfig>
         &lva_config_opt = std::nullopt);
-bool alg_simp(IRNode *root, const CompileConfig &config);
+// The peephole passes alg_simp, binary_op_simplify and constant_fold only
+// visit the statements of |worklist|, if given, instead of all statements.
+bool alg_simp(IRNode *root,
+              const CompileConfig &config,
+              StmtWorklist *worklist = nullptr);
 bool demote_operations(IRNode *root, const CompileConfig &config);
-bool binary_op_simplify(IRNode *root, const CompileConfig &config);
+bool binary_op_simplify(IRNode *root,
+                        const CompileConfig &config,
+                        StmtWorklist *worklist = nullptr);
 bool whole_kernel_cse(IRNode *root);
 void variable_optimization(IRNode *root, bool after_lower_access);
 bool extract_constant(IRNode *root, const CompileConfig &config);
@@ -92,7 +98,8 @@ void auto_diff(IRNode *root,
 bool determine_ad_stack_size(IRNode *root, const CompileConfig &config);
 bool constant_fold(IRNode *root,
                    const CompileConfig &config,
-                   const ConstantFoldPass::Args &args);
+                   const ConstantFoldPass::Args &args,
+                   StmtWorklist *worklist = nullptr);
 void offload(IRNode *root, const CompileConfig &config);
 bool transform_statements(
     IRNode *root,
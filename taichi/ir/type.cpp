@@ -272,6 +272,34 @@ bool TypedConstant::equal_type_and_value(const TypedConstant &o) const {
   }
 }
 
+std::size_t TypedConstant::hash() const {
+  std::size_t value_hash;
+  if (dt->is_primitive(PrimitiveTypeID::f32)) {
+    value_hash = std::hash<float32>{}(val_f32);
+  } else if (dt->is_primitive(PrimitiveTypeID::i32)) {
+    value_hash = std::hash<int32>{}(val_i32);
+  } else if (dt->is_primitive(PrimitiveTypeID::i64)) {
+    value_hash = std::hash<int64>{}(val_i64);
+  } else if (dt->is_primitive(PrimitiveTypeID::f64)) {
+    value_hash = std::hash<float64>{}(val_f64);
+  } else if (dt->is_primitive(PrimitiveTypeID::i8)) {
+    value_hash = std::hash<int8>{}(val_i8);
+  } else if (dt->is_primitive(PrimitiveTypeID::i16)) {
+    value_hash = std::hash<int16>{}(val_i16);
+  } else if (dt->is_primitive(PrimitiveTypeID::u8)) {
+    value_hash = std::hash<uint8>{}(val_u8);
+  } else if (dt->is_primitive(PrimitiveTypeID::u16)) {
+    value_hash = std::hash<uint16>{}(val_u16);
+  } else if (dt->is_primitive(PrimitiveTypeID::u32)) {
+    value_hash = std::hash<uint32>{}(val_u32);
+  } else if (dt->is_primitive(PrimitiveTypeID::u64)) {
+    value_hash = std::hash<uint64>{}(val_u64);
+  } else {
+    TI_NOT_IMPLEMENTED
+  }
+  return std::hash<const Type *>{}(dt) * 100000007UL + value_hash;
+}
+
 int32 &TypedConstant::val_int32() {
   TI_ASSERT(get_data_type<int32>() == dt);
   return val_i32;
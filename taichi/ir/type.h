@@ -318,9 +318,15 @@ class BitArrayType : public Type {
       : physical_type_(physical_type),
         element_type_(element_type_),
         num_elements_(num_elements_) {
+    // Only the digits of custom floats are stored per element; their
+    // exponent, if any, is shared by the whole container.
+    auto digits_type = element_type_;
+    if (auto cft = element_type_->cast<CustomFloatType>()) {
+      digits_type = cft->get_digits_type();
+    }
     // TODO: avoid assertion?
-    TI_ASSERT(element_type_->is<CustomIntType>());
-    element_num_bits_ = element_type_->as<CustomIntType>()->get_num_bits();
+    TI_ASSERT(digits_type->is<CustomIntType>());
+    element_num_bits_ = digits_type->as<CustomIntType>()->get_num_bits();
   }
 
   std::string to_string() const override;
@@ -441,6 +447,8 @@ class TypedConstant {
 
   bool equal_type_and_value(const TypedConstant &o) const;
 
+  std::size_t hash() const;
+
   bool operator==(const TypedConstant &o) const {
     return equal_type_and_value(o);
   }
@@ -39,6 +39,18 @@
 namespace taichi {
 namespace lang {
 
+// The LLVM module of an AOT-compiled kernel, together with the names of the
+// functions that must be kept when it is dumped.
+class ModuleGenValue {
+ public:
+  ModuleGenValue(std::unique_ptr<llvm::Module> module,
+                 const std::vector<std::string> &name_list)
+      : module(std::move(module)), name_list(name_list) {
+  }
+  std::unique_ptr<llvm::Module> module;
+  std::vector<std::string> name_list;
+};
+
 inline constexpr char kLLVMPhysicalCoordinatesName[] = "PhysicalCoordinates";
 
 std::string type_name(llvm::Type *type);
@@ -8,6 +8,7 @@
 #include "taichi/util/str.h"
 #include "taichi/codegen/codegen.h"
 #include "taichi/ir/statements.h"
+#include "taichi/backends/cpu/aot_module_builder_impl.h"
 #include "taichi/backends/cpu/cpu_device.h"
 #include "taichi/backends/cuda/cuda_device.h"
 
@@ -417,6 +418,13 @@ void LlvmProgramImpl::materialize_runtime(MemoryPool *memory_pool,
   }
 }
 
+std::unique_ptr<AotModuleBuilder> LlvmProgramImpl::make_aot_module_builder() {
+  if (arch_is_cpu(config->arch)) {
+    return std::make_unique<cpu::AotModuleBuilderImpl>(this);
+  }
+  TI_NOT_IMPLEMENTED;
+}
+
 void LlvmProgramImpl::check_runtime_error(uint64 *result_buffer) {
   synchronize();
   auto tlctx = llvm_context_host.get();
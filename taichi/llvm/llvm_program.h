@@ -136,9 +136,7 @@ class LlvmProgramImpl : public ProgramImpl {
 
   void print_list_manager_info(void *list_manager, uint64 *result_buffer);
 
-  std::unique_ptr<AotModuleBuilder> make_aot_module_builder() override {
-    TI_NOT_IMPLEMENTED;
-  }
+  std::unique_ptr<AotModuleBuilder> make_aot_module_builder() override;
 
   virtual Device *get_compute_device() override {
     return device_.get();
@@ -138,14 +138,19 @@ void ExecutionQueue::enqueue(const TaskLaunchRecord &ker) {
     }
     async_func = &(compiled_funcs_.at(h));
   }
+  // Fused tasks share the hash of the memoized fusion result, so steady-state
+  // launches of the same task sequence hit this cache.
+  stat.add(needs_compile ? "async_compile_cache_misses"
+                         : "async_compile_cache_hits");
   if (needs_compile) {
-    // Later the IR passes will change |stmt|, so we must clone it.
-    auto cloned_stmt = ker.ir_handle.clone();
-    stmt = cloned_stmt->as<OffloadedStmt>();
-
     compilation_workers.enqueue(
-        [kernel_name, async_func, stmt, kernel, this]() {
+        [kernel_name, async_func, ir_handle = ker.ir_handle, kernel, this]() {
           TI_TIMELINE(kernel_name);
+          // Later the IR passes will change the task, so we must clone it.
+          // The template in IRBank is read-only, so this is done here rather
+          // than on the launching thread.
+          auto cloned_stmt = ir_handle.clone();
+          auto stmt = cloned_stmt->as<OffloadedStmt>();
           // Final lowering
           using namespace irpass;
 
@@ -160,9 +165,12 @@ void ExecutionQueue::enqueue(const TaskLaunchRecord &ker) {
               is_extension_supported(config.arch, Extension::bls) &&
                   config.make_block_local);
           auto func = this->compile_to_backend_(*kernel, stmt);
+          {
+            std::lock_guard<std::mutex> _(mut);
+            compiled_tasks_.push_back(std::move(cloned_stmt));
+          }
           async_func->set(func);
         });
-    ir_bank_->insert_to_trash_bin(std::move(cloned_stmt));
   }
 
   launch_worker.enqueue(
@@ -196,36 +204,106 @@ AsyncEngine::AsyncEngine(const CompileConfig *const config,
   ir_bank_.set_sfg(sfg.get());
 }
 
-void AsyncEngine::launch(Kernel *kernel, RuntimeContext &context) {
-  if (!kernel->lowered()) {
-    kernel->lower(/*to_executable=*/false);
+struct AsyncEngine::KernelPreparation {
+  std::vector<std::unique_ptr<IRNode>> tasks;
+  std::vector<uint64> hashes;
+  std::atomic<int> num_remaining;
+  std::promise<void> done;
+  std::shared_future<void> done_future;
+
+  explicit KernelPreparation(int num_tasks)
+      : tasks(num_tasks),
+        hashes(num_tasks),
+        num_remaining(num_tasks),
+        done_future(done.get_future()) {
+    if (num_tasks == 0) {
+      done.set_value();
+    }
   }
 
+  bool ready() const {
+    return done_future.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+};
+
+void AsyncEngine::prepare_kernel(Kernel *kernel, KernelMeta &kmeta) {
   auto block = dynamic_cast<Block *>(kernel->ir.get());
   TI_ASSERT(block);
 
   auto &offloads = block->statements;
-  auto &kmeta = kernel_metas_[kernel];
-  const bool kmeta_inited = !kmeta.ir_handle_cached.empty();
-  std::vector<TaskLaunchRecord> records;
-  for (std::size_t i = 0; i < offloads.size(); i++) {
-    if (!kmeta_inited) {
-      TI_ASSERT(kmeta.ir_handle_cached.size() == i);
-      IRHandle tmp_ir_handle(offloads[i].get(), 0);
+  auto prep = std::make_shared<KernelPreparation>((int)offloads.size());
+  kmeta.preparation = prep;
+  for (int i = 0; i < (int)offloads.size(); i++) {
+    const IRNode *offload = offloads[i].get();
+    queue.compilation_workers.enqueue([prep, i, offload, kernel]() {
+      TI_TIMELINE(kernel->name + "_prepare");
+      IRHandle tmp_ir_handle(offload, 0);
       auto cloned_offs = tmp_ir_handle.clone();
-      irpass::re_id(cloned_offs.get());
-      auto h = ir_bank_.get_hash(cloned_offs.get());
-      kmeta.ir_handle_cached.emplace_back(cloned_offs.get(), h);
-      ir_bank_.insert(std::move(cloned_offs), h);
+      prep->hashes[i] = IRBank::compute_hash(cloned_offs.get());
+      prep->tasks[i] = std::move(cloned_offs);
+      if (--prep->num_remaining == 0) {
+        prep->done.set_value();
+      }
+    });
+  }
+}
+
+void AsyncEngine::insert_pending_launches(bool blocking) {
+  while (!pending_launches_.empty()) {
+    auto &launch = pending_launches_.front();
+    auto &kmeta = kernel_metas_[launch.kernel];
+    if (!kmeta.prepared()) {
+      auto &prep = *kmeta.preparation;
+      if (!blocking && !prep.ready()) {
+        break;
+      }
+      prep.done_future.wait();
+      TI_ASSERT(kmeta.ir_handle_cached.empty());
+      for (std::size_t i = 0; i < prep.tasks.size(); i++) {
+        auto h = prep.hashes[i];
+        ir_bank_.set_hash(prep.tasks[i].get(), h);
+        kmeta.ir_handle_cached.emplace_back(prep.tasks[i].get(), h);
+        ir_bank_.insert(std::move(prep.tasks[i]), h);
+      }
+      kmeta.preparation = nullptr;
+    }
+    std::vector<TaskLaunchRecord> records;
+    records.reserve(kmeta.ir_handle_cached.size());
+    for (const auto &ir_handle : kmeta.ir_handle_cached) {
+      records.emplace_back(launch.context, launch.kernel, ir_handle);
     }
-    TaskLaunchRecord rec(context, kernel, kmeta.ir_handle_cached[i]);
-    records.push_back(rec);
+    sfg->insert_tasks(records, config_->async_listgen_fast_filtering);
+    pending_launches_.pop_front();
+  }
+}
+
+void AsyncEngine::launch(Kernel *kernel, RuntimeContext &context) {
+  if (!kernel->lowered()) {
+    kernel->lower(/*to_executable=*/false);
+  }
+
+  auto iter = kernel_metas_.find(kernel);
+  if (iter == kernel_metas_.end()) {
+    iter = kernel_metas_.emplace(kernel, KernelMeta()).first;
+    prepare_kernel(kernel, iter->second);
   }
-  sfg->insert_tasks(records, config_->async_listgen_fast_filtering);
+  pending_launches_.push_back({kernel, context});
+  insert_pending_launches(/*blocking=*/false);
   if ((config_->async_flush_every > 0) &&
       (sfg->num_pending_tasks() >= config_->async_flush_every)) {
     TI_TRACE("Async flushing {} tasks", sfg->num_pending_tasks());
     flush();
+  } else if ((config_->async_opt_every > 0) &&
+             (sfg->num_pending_tasks() - num_pending_tasks_optimized_ >=
+              config_->async_opt_every)) {
+    // Optimize the newly inserted tasks now, so that flush() only has to look
+    // at the tasks inserted after this point.
+    optimize();
+    sfg->mark_nodes_as_optimized();
+    // Allow for insertion of new edges upon the next launch.
+    sfg->unsort_node_edges();
+    num_pending_tasks_optimized_ = sfg->num_pending_tasks();
   }
 }
 
@@ -244,6 +322,25 @@ void AsyncEngine::flush() {
   TI_AUTO_PROF;
   TI_AUTO_TIMELINE;
 
+  insert_pending_launches(/*blocking=*/true);
+  optimize();
+  {
+    TI_TIMELINE("enqueue");
+    auto tasks = sfg->extract_to_execute();
+    TI_TRACE("Ended up with {} nodes", tasks.size());
+    for (auto &task : tasks) {
+      queue.enqueue(task);
+    }
+  }
+  // extract_to_execute() keeps the dirty flags; the retained nodes have been
+  // optimized.
+  sfg->mark_nodes_as_optimized();
+  num_pending_tasks_optimized_ = 0;
+  flush_counter_++;
+}
+
+void AsyncEngine::optimize() {
+  TI_AUTO_PROF;
   bool modified = true;
   sfg->reid_nodes();
   sfg->reid_pending_nodes();
@@ -291,15 +388,6 @@ void AsyncEngine::flush() {
     sfg->verify();
   }
   debug_sfg("final");
-  {
-    TI_TIMELINE("enqueue");
-    auto tasks = sfg->extract_to_execute();
-    TI_TRACE("Ended up with {} nodes", tasks.size());
-    for (auto &task : tasks) {
-      queue.enqueue(task);
-    }
-  }
-  flush_counter_++;
 }
 
 void AsyncEngine::debug_sfg(const std::string &stage) {
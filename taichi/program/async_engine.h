@@ -122,6 +122,9 @@ class ExecutionQueue {
     std::shared_future<FunctionType> f_;
   };
   std::unordered_map<uint64, AsyncCompiledFunc> compiled_funcs_;
+  // The offloaded tasks cloned (and then lowered) by |compilation_workers|.
+  // Guarded by |mut|.
+  std::vector<std::unique_ptr<IRNode>> compiled_tasks_;
 
   IRBank *ir_bank_;  // not owned
   BackendExecCompilationFunc compile_to_backend_;
@@ -144,10 +147,19 @@ class AsyncEngine {
     queue.clear_cache();
   }
 
+  // Non-blocking for kernels launched for the first time: their offloaded
+  // tasks are cloned and hashed on |queue.compilation_workers|, and the launch
+  // is inserted into |sfg| once that is done (at the latest, upon flush()).
   void launch(Kernel *kernel, RuntimeContext &context);
 
   // Flush the tasks only.
   void flush();
+
+  // Runs the SFG optimization passes on the pending tasks. Tasks that have
+  // not been modified since the last call are only revisited next to
+  // modified ones.
+  void optimize();
+
   // Flush the tasks and block waiting for the GPU device to complete.
   void synchronize();
 
@@ -156,6 +168,8 @@ class AsyncEngine {
  private:
   IRBank ir_bank_;
 
+  struct KernelPreparation;
+
   struct KernelMeta {
     // OffloadedCachedData holds some data that needs to be computed once for
     // each offloaded task of a kernel. Especially, it holds a cloned offloaded
@@ -166,9 +180,30 @@ class AsyncEngine {
     // This design allows us to do task cloning lazily. It turned out that doing
     // clone on every kernel launch is too expensive.
     std::vector<IRHandle> ir_handle_cached;
+    // Non-null while the offloaded tasks are being cloned and hashed.
+    std::shared_ptr<KernelPreparation> preparation;
+
+    bool prepared() const {
+      return preparation == nullptr;
+    }
   };
 
+  struct PendingLaunch {
+    Kernel *kernel;
+    RuntimeContext context;
+  };
+
+  // Clones and hashes the offloaded tasks of |kernel| in parallel.
+  void prepare_kernel(Kernel *kernel, KernelMeta &kmeta);
+
+  // Inserts the launches in |pending_launches_| into |sfg| in order, stopping
+  // at the first kernel that is still being prepared unless |blocking|.
+  void insert_pending_launches(bool blocking);
+
   std::unordered_map<const Kernel *, KernelMeta> kernel_metas_;
+  std::deque<PendingLaunch> pending_launches_;
+  // Number of pending tasks in |sfg| upon the last optimize()
+  int num_pending_tasks_optimized_{0};
   // How many times we have flushed
   int flush_counter_{0};
   // How many times we have synchronized
@@ -0,0 +1,85 @@
+#include "taichi/program/async_readback.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "taichi/common/logging.h"
+
+#if defined(TI_WITH_CUDA)
+#include "taichi/backends/cuda/cuda_context.h"
+#include "taichi/backends/cuda/cuda_driver.h"
+#endif
+
+namespace taichi {
+namespace lang {
+
+AsyncReadback::AsyncReadback(Arch arch, std::size_t size, int num_buffers)
+    : arch_(arch), size_(size), buffers_(num_buffers, nullptr) {
+  TI_ASSERT(num_buffers > 0);
+  if (arch_ == Arch::cuda) {
+#if defined(TI_WITH_CUDA)
+    auto context_guard = CUDAContext::get_instance().get_guard();
+    events_.resize(num_buffers, nullptr);
+    for (int i = 0; i < num_buffers; i++) {
+      CUDADriver::get_instance().mem_host_alloc(&buffers_[i], size_, 0);
+      CUDADriver::get_instance().event_create(&events_[i],
+                                              CU_EVENT_DISABLE_TIMING);
+    }
+#else
+    TI_ERROR("No CUDA support");
+#endif
+  } else {
+    TI_ERROR_IF(!arch_is_cpu(arch_), "Async readback is not supported on {}",
+                arch_name(arch_));
+    for (auto &buffer : buffers_) {
+      buffer = std::malloc(size_);
+    }
+  }
+}
+
+AsyncReadback::~AsyncReadback() {
+  if (arch_ == Arch::cuda) {
+#if defined(TI_WITH_CUDA)
+    auto context_guard = CUDAContext::get_instance().get_guard();
+    for (int i = 0; i < num_buffers(); i++) {
+      CUDADriver::get_instance().event_synchronize(events_[i]);
+      CUDADriver::get_instance().event_destroy(events_[i]);
+      CUDADriver::get_instance().mem_free_host(buffers_[i]);
+    }
+#endif
+  } else {
+    for (auto buffer : buffers_) {
+      std::free(buffer);
+    }
+  }
+}
+
+void AsyncReadback::enqueue(int i, intptr_t src) {
+  TI_ASSERT(0 <= i && i < num_buffers());
+  if (arch_ == Arch::cuda) {
+#if defined(TI_WITH_CUDA)
+    auto context_guard = CUDAContext::get_instance().get_guard();
+    // Kernels are launched on the default stream, so the copy starts after
+    // the kernels launched so far and the event is recorded after the copy.
+    CUDADriver::get_instance().memcpy_device_to_host_async(
+        buffers_[i], (void *)src, size_, nullptr);
+    CUDADriver::get_instance().event_record(events_[i], nullptr);
+#endif
+  } else {
+    std::memcpy(buffers_[i], (void *)src, size_);
+  }
+}
+
+intptr_t AsyncReadback::wait(int i) {
+  TI_ASSERT(0 <= i && i < num_buffers());
+  if (arch_ == Arch::cuda) {
+#if defined(TI_WITH_CUDA)
+    auto context_guard = CUDAContext::get_instance().get_guard();
+    CUDADriver::get_instance().event_synchronize(events_[i]);
+#endif
+  }
+  return (intptr_t)buffers_[i];
+}
+
+}  // namespace lang
+}  // namespace taichi
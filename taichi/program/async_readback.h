@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "taichi/program/arch.h"
+
+namespace taichi {
+namespace lang {
+
+// A ring of host buffers that device memory is read back into without
+// blocking the thread that launches kernels. On CUDA, the buffers are pinned
+// and each copy is enqueued behind the kernels launched so far, so wait()
+// returns once the copy has landed. On the CPU, kernels have completed when
+// they return, and the copies are done by enqueue() itself.
+class AsyncReadback {
+ public:
+  AsyncReadback(Arch arch, std::size_t size, int num_buffers);
+
+  ~AsyncReadback();
+
+  // Enqueues a copy of size() bytes at |src| into buffer |i|. The previous
+  // copy into the buffer must have been waited for.
+  void enqueue(int i, intptr_t src);
+
+  // Waits for the last copy into buffer |i| and returns the buffer. It can
+  // be called from any thread.
+  intptr_t wait(int i);
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  int num_buffers() const {
+    return (int)buffers_.size();
+  }
+
+ private:
+  Arch arch_;
+  std::size_t size_;
+  std::vector<void *> buffers_;
+  std::vector<void *> events_;
+};
+
+}  // namespace lang
+}  // namespace taichi
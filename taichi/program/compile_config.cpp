@@ -49,6 +49,7 @@ CompileConfig::CompileConfig() {
   max_block_dim = 0;
   cpu_max_num_threads = std::thread::hardware_concurrency();
   random_seed = 0;
+  random_generator = "xorshift";
 
   // LLVM backend options:
   print_struct_llvm_ir = false;
@@ -56,6 +56,9 @@ struct CompileConfig {
   int max_block_dim;
   int cpu_max_num_threads;
   int random_seed;
+  // "xorshift" (per-thread states) or "philox" (counter-based, reproducible
+  // regardless of the number of threads; LLVM backends only)
+  std::string random_generator;
 
   // LLVM backend options:
   bool print_struct_llvm_ir;
@@ -85,6 +88,9 @@ struct CompileConfig {
   std::string async_opt_intermediate_file;
   // Setting 0 effectively means do not automatically flush
   int async_flush_every{50};
+  // Optimize the pending tasks every N tasks, so that each flush only needs to
+  // look at the most recent ones. Setting 0 means only optimize upon flush
+  int async_opt_every{16};
   // Setting 0 effectively means unlimited
   int async_max_fuse_per_task{1};
 
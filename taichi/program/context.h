@@ -18,6 +18,9 @@ struct RuntimeContext {
   uint64 args[taichi_max_num_args_total];
   int32 extra_args[taichi_max_num_args_extra][taichi_max_num_indices];
   int32 cpu_thread_id;
+  // Index of the kernel launch, part of the key of counter-based random
+  // numbers
+  uint32 rand_epoch;
 
   static constexpr size_t extra_args_size = sizeof(extra_args);
 
@@ -6,12 +6,11 @@
 #include "taichi/ir/analysis.h"
 #include "taichi/program/kernel.h"
 #include "taichi/program/state_flow_graph.h"
+#include "taichi/util/statistics.h"
 
 TLANG_NAMESPACE_BEGIN
 
-namespace {
-
-uint64 hash(IRNode *stmt) {
+uint64 IRBank::compute_hash(IRNode *stmt) {
   TI_ASSERT(stmt);
   // TODO: upgrade this using IR comparisons
   std::string serialized;
@@ -32,12 +31,10 @@ uint64 hash(IRNode *stmt) {
   return ret;
 }
 
-}  // namespace
-
 uint64 IRBank::get_hash(IRNode *ir) {
   auto result_iterator = hash_bank_.find(ir);
   if (result_iterator == hash_bank_.end()) {
-    auto result = hash(ir);
+    auto result = compute_hash(ir);
     set_hash(ir, result);
     return result;
   }
@@ -74,8 +71,10 @@ IRHandle IRBank::fuse(IRHandle handle_a, IRHandle handle_b, Kernel *kernel) {
   auto &result = fuse_bank_[std::make_pair(handle_a, handle_b)];
   if (!result.empty()) {
     // assume the kernel is always the same when the ir handles are the same
+    stat.add("fusion_cache_hits");
     return result;
   }
+  stat.add("fusion_cache_misses");
 
   TI_TRACE("Begin uncached fusion: [{}(size={})] <- [{}(size={})]",
            handle_a.ir()->get_kernel()->name,
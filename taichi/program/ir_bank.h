@@ -10,6 +10,10 @@ class StateFlowGraph;
 
 class IRBank {
  public:
+  // Computes the hash of |ir| without caching it. |ir| is re-id'ed. Unlike the
+  // other member functions, this is safe to call from any thread.
+  static uint64 compute_hash(IRNode *ir);
+
   uint64 get_hash(IRNode *ir);
   void set_hash(IRNode *ir, uint64 hash);
 
@@ -0,0 +1,524 @@
+#include "taichi/program/iterative_solver.h"
+
+#include <cmath>
+#include <limits>
+
+namespace taichi {
+namespace lang {
+
+namespace {
+
+// Compressed sparse rows with sorted column indices
+template <typename Scalar>
+struct CsrMatrix {
+  int n{0};
+  std::vector<int64> row_offsets;
+  std::vector<int> cols;
+  std::vector<Scalar> values;
+};
+
+template <typename Scalar>
+class IterativeSolverImpl : public IterativeSolver {
+ public:
+  using Vector = std::vector<Scalar>;
+
+  IterativeSolverImpl(const std::string &method,
+                      const std::string &preconditioner,
+                      int max_iterations,
+                      float64 tolerance)
+      : method_(method),
+        preconditioner_(preconditioner),
+        max_iterations_(max_iterations),
+        tolerance_(tolerance) {
+    TI_ERROR_IF(method != "CG" && method != "BiCGSTAB" && method != "MINRES",
+                "Not supported iterative solver: {}", method);
+    TI_ERROR_IF(preconditioner != "none" && preconditioner != "Jacobi" &&
+                    preconditioner != "IC",
+                "Not supported preconditioner: {}", preconditioner);
+  }
+
+  void compute(const SparseMatrix &sm) override {
+    TI_ERROR_IF(sm.num_rows() != sm.num_cols(),
+                "Iterative solvers need a square matrix, got {}x{}",
+                sm.num_rows(), sm.num_cols());
+    if (!convert_matrix<int32>(sm) && !convert_matrix<int64>(sm)) {
+      TI_ERROR("The sparse matrix of type {} does not match the solver",
+               sm.get_data_type()->to_string());
+    }
+    matvec_ = nullptr;
+    resize(sm.num_rows());
+    if (preconditioner_ == "Jacobi") {
+      Vector diagonal(n_, 0);
+      for (int i = 0; i < n_; i++) {
+        for (int64 k = matrix_.row_offsets[i]; k < matrix_.row_offsets[i + 1];
+             k++) {
+          if (matrix_.cols[k] == i) {
+            diagonal[i] = matrix_.values[k];
+          }
+        }
+      }
+      set_jacobi(diagonal.data());
+    } else if (preconditioner_ == "IC") {
+      factorize_incomplete_cholesky();
+    }
+  }
+
+  void set_operator(int n,
+                    const MatVec &matvec,
+                    const void *diagonal) override {
+    TI_ERROR_IF(preconditioner_ == "IC",
+                "The IC preconditioner needs an assembled matrix");
+    TI_ERROR_IF(preconditioner_ == "Jacobi" && diagonal == nullptr,
+                "The Jacobi preconditioner needs the diagonal of the operator");
+    matrix_ = CsrMatrix<Scalar>();
+    matvec_ = matvec;
+    resize(n);
+    if (preconditioner_ == "Jacobi") {
+      set_jacobi((const Scalar *)diagonal);
+    }
+  }
+
+  bool solve(const void *b, void *x) override {
+    TI_ERROR_IF(n_ == 0 && !matvec_, "The solver has no operator");
+    num_iterations_ = 0;
+    residual_ = 0;
+    converged_ = false;
+    if (method_ == "CG") {
+      solve_cg((const Scalar *)b, (Scalar *)x);
+    } else if (method_ == "BiCGSTAB") {
+      solve_bicgstab((const Scalar *)b, (Scalar *)x);
+    } else {
+      solve_minres((const Scalar *)b, (Scalar *)x);
+    }
+    return converged_;
+  }
+
+ private:
+  template <typename StorageIndex>
+  bool convert_matrix(const SparseMatrix &sm) {
+    using EigenMatrix =
+        Eigen::SparseMatrix<Scalar, Eigen::ColMajor, StorageIndex>;
+    auto *matrix = dynamic_cast<const EigenSparseMatrix<EigenMatrix> *>(&sm);
+    if (matrix == nullptr) {
+      return false;
+    }
+    Eigen::SparseMatrix<Scalar, Eigen::RowMajor, StorageIndex> rows(
+        matrix->get_matrix());
+    rows.makeCompressed();
+    const int n = rows.rows();
+    matrix_.n = n;
+    matrix_.row_offsets.assign(rows.outerIndexPtr(),
+                               rows.outerIndexPtr() + n + 1);
+    matrix_.cols.assign(rows.innerIndexPtr(),
+                        rows.innerIndexPtr() + rows.nonZeros());
+    matrix_.values.assign(rows.valuePtr(), rows.valuePtr() + rows.nonZeros());
+    return true;
+  }
+
+  void resize(int n) {
+    n_ = n;
+    // Small vectors are not worth the synchronization
+    const int max_num_chunks = (n + kMinChunkSize - 1) / kMinChunkSize;
+    const int num_threads = sparse_thread_pool().num_threads();
+    num_chunks_ = std::max(1, std::min(num_threads * 4, max_num_chunks));
+    partial_sums_.resize(num_chunks_);
+    for (auto *v : {&r_, &z_, &p_, &q_, &s_, &t_, &u_, &w_, &w1_, &w2_}) {
+      v->assign(n, 0);
+    }
+  }
+
+  // Calls func(chunk, begin, end) on the chunks of [0, n) in parallel
+  template <typename Func>
+  void for_each_chunk(const Func &func) {
+    if (num_chunks_ == 1) {
+      func(0, 0, n_);
+      return;
+    }
+    sparse_thread_pool().parallel_for(num_chunks_, [&](int, int c) {
+      func(c, int((int64)n_ * c / num_chunks_),
+           int((int64)n_ * (c + 1) / num_chunks_));
+    });
+  }
+
+  // The partial sums are added in a fixed order, so that the result does not
+  // depend on the scheduling.
+  float64 dot(const Scalar *a, const Scalar *b) {
+    for_each_chunk([&](int c, int begin, int end) {
+      float64 sum = 0;
+      for (int i = begin; i < end; i++) {
+        sum += (float64)a[i] * b[i];
+      }
+      partial_sums_[c] = sum;
+    });
+    float64 sum = 0;
+    for (int c = 0; c < num_chunks_; c++) {
+      sum += partial_sums_[c];
+    }
+    return sum;
+  }
+
+  float64 norm(const Scalar *a) {
+    return std::sqrt(dot(a, a));
+  }
+
+  // y = alpha * x + beta * y
+  void axpby(float64 alpha, const Scalar *x, float64 beta, Scalar *y) {
+    for_each_chunk([&](int, int begin, int end) {
+      for (int i = begin; i < end; i++) {
+        y[i] = Scalar(alpha * x[i] + beta * y[i]);
+      }
+    });
+  }
+
+  void copy(const Scalar *x, Scalar *y) {
+    axpby(1, x, 0, y);
+  }
+
+  // y = A x
+  void apply(const Scalar *x, Scalar *y) {
+    if (matvec_) {
+      matvec_(x, y);
+      return;
+    }
+    for_each_chunk([&](int, int begin, int end) {
+      for (int i = begin; i < end; i++) {
+        float64 sum = 0;
+        for (int64 k = matrix_.row_offsets[i]; k < matrix_.row_offsets[i + 1];
+             k++) {
+          sum += (float64)matrix_.values[k] * x[matrix_.cols[k]];
+        }
+        y[i] = Scalar(sum);
+      }
+    });
+  }
+
+  // z = M^-1 r
+  void precondition(const Scalar *r, Scalar *z) {
+    if (preconditioner_ == "Jacobi") {
+      for_each_chunk([&](int, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+          z[i] = inv_diagonal_[i] * r[i];
+        }
+      });
+    } else if (preconditioner_ == "IC") {
+      solve_incomplete_cholesky(r, z);
+    } else {
+      copy(r, z);
+    }
+  }
+
+  void set_jacobi(const Scalar *diagonal) {
+    inv_diagonal_.resize(n_);
+    for (int i = 0; i < n_; i++) {
+      TI_ERROR_IF(diagonal[i] == 0,
+                  "The Jacobi preconditioner needs a nonzero diagonal, but "
+                  "A[{}, {}] is zero",
+                  i, i);
+      inv_diagonal_[i] = Scalar(1) / diagonal[i];
+    }
+  }
+
+  // Zero fill-in incomplete Cholesky factorization L L^T of the matrix. If a
+  // pivot breaks down, the factorization is retried with a growing diagonal
+  // shift.
+  void factorize_incomplete_cholesky() {
+    auto &lower = ic_factor_;
+    lower = CsrMatrix<Scalar>();
+    lower.n = n_;
+    lower.row_offsets.push_back(0);
+    float64 max_diagonal = 0;
+    for (int i = 0; i < n_; i++) {
+      for (int64 k = matrix_.row_offsets[i]; k < matrix_.row_offsets[i + 1];
+           k++) {
+        if (matrix_.cols[k] <= i) {
+          lower.cols.push_back(matrix_.cols[k]);
+          lower.values.push_back(matrix_.values[k]);
+        }
+      }
+      TI_ERROR_IF(lower.cols.empty() || lower.cols.back() != i,
+                  "The IC preconditioner needs a nonzero diagonal, but "
+                  "A[{}, {}] is missing",
+                  i, i);
+      max_diagonal =
+          std::max(max_diagonal, std::abs((float64)lower.values.back()));
+      lower.row_offsets.push_back(lower.cols.size());
+    }
+    const auto original = lower.values;
+    float64 shift = 0;
+    for (int attempt = 0; attempt < 32; attempt++) {
+      if (try_incomplete_cholesky(shift)) {
+        return;
+      }
+      lower.values = original;
+      shift = shift == 0 ? 1e-3 * max_diagonal : shift * 2;
+    }
+    TI_ERROR("Incomplete Cholesky factorization failed");
+  }
+
+  bool try_incomplete_cholesky(float64 shift) {
+    auto &lower = ic_factor_;
+    const auto &offsets = lower.row_offsets;
+    for (int i = 0; i < n_; i++) {
+      const int64 diag = offsets[i + 1] - 1;
+      float64 diag_value = (float64)lower.values[diag] + shift;
+      for (int64 k = offsets[i]; k < diag; k++) {
+        const int j = lower.cols[k];
+        // L_ij = (A_ij - sum_{m < j} L_im L_jm) / L_jj
+        float64 sum = lower.values[k];
+        int64 a = offsets[i], b = offsets[j];
+        const int64 b_end = offsets[j + 1] - 1;
+        while (a < k && b < b_end) {
+          if (lower.cols[a] < lower.cols[b]) {
+            a++;
+          } else if (lower.cols[a] > lower.cols[b]) {
+            b++;
+          } else {
+            sum -= (float64)lower.values[a++] * lower.values[b++];
+          }
+        }
+        lower.values[k] = Scalar(sum / lower.values[b_end]);
+        diag_value -= (float64)lower.values[k] * lower.values[k];
+      }
+      if (!(diag_value > 0)) {
+        return false;
+      }
+      lower.values[diag] = Scalar(std::sqrt(diag_value));
+    }
+    return true;
+  }
+
+  // Solves L L^T z = r. The triangular solves are sequential.
+  void solve_incomplete_cholesky(const Scalar *r, Scalar *z) {
+    const auto &lower = ic_factor_;
+    const auto &offsets = lower.row_offsets;
+    for (int i = 0; i < n_; i++) {
+      float64 sum = r[i];
+      const int64 diag = offsets[i + 1] - 1;
+      for (int64 k = offsets[i]; k < diag; k++) {
+        sum -= (float64)lower.values[k] * z[lower.cols[k]];
+      }
+      z[i] = Scalar(sum / lower.values[diag]);
+    }
+    // L^T is traversed by rows of L, scattering each solved value upwards
+    for (int i = n_ - 1; i >= 0; i--) {
+      const int64 diag = offsets[i + 1] - 1;
+      z[i] = z[i] / lower.values[diag];
+      for (int64 k = offsets[i]; k < diag; k++) {
+        z[lower.cols[k]] -= lower.values[k] * z[i];
+      }
+    }
+  }
+
+  // Returns false if b is zero, in which case x is set to zero.
+  bool initialize(const Scalar *b, Scalar *x, float64 &b_norm) {
+    b_norm = norm(b);
+    if (b_norm == 0) {
+      std::fill(x, x + n_, Scalar(0));
+      converged_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  bool check_convergence(float64 residual) {
+    residual_ = residual;
+    converged_ = residual <= tolerance_;
+    return converged_;
+  }
+
+  void solve_cg(const Scalar *b, Scalar *x) {
+    float64 b_norm;
+    if (!initialize(b, x, b_norm)) {
+      return;
+    }
+    // r = b - A x
+    apply(x, r_.data());
+    axpby(1, b, -1, r_.data());
+    if (check_convergence(norm(r_.data()) / b_norm)) {
+      return;
+    }
+    precondition(r_.data(), z_.data());
+    copy(z_.data(), p_.data());
+    float64 rz = dot(r_.data(), z_.data());
+    while (num_iterations_ < max_iterations_) {
+      num_iterations_++;
+      apply(p_.data(), q_.data());
+      const float64 alpha = rz / dot(p_.data(), q_.data());
+      axpby(alpha, p_.data(), 1, x);
+      axpby(-alpha, q_.data(), 1, r_.data());
+      if (check_convergence(norm(r_.data()) / b_norm)) {
+        return;
+      }
+      precondition(r_.data(), z_.data());
+      const float64 rz_new = dot(r_.data(), z_.data());
+      axpby(1, z_.data(), rz_new / rz, p_.data());
+      rz = rz_new;
+    }
+  }
+
+  void solve_bicgstab(const Scalar *b, Scalar *x) {
+    float64 b_norm;
+    if (!initialize(b, x, b_norm)) {
+      return;
+    }
+    // r = b - A x, with r_hat (in w_) the shadow residual
+    auto *r = r_.data(), *r_hat = w_.data(), *p = p_.data(), *v = q_.data();
+    auto *p_hat = z_.data(), *s = s_.data(), *s_hat = u_.data();
+    auto *t = t_.data();
+    apply(x, r);
+    axpby(1, b, -1, r);
+    if (check_convergence(norm(r) / b_norm)) {
+      return;
+    }
+    copy(r, r_hat);
+    std::fill(p, p + n_, Scalar(0));
+    std::fill(v, v + n_, Scalar(0));
+    float64 rho = 1, alpha = 1, omega = 1;
+    while (num_iterations_ < max_iterations_) {
+      num_iterations_++;
+      const float64 rho_new = dot(r_hat, r);
+      if (rho_new == 0) {
+        break;
+      }
+      // p = r + beta (p - omega v)
+      const float64 beta = (rho_new / rho) * (alpha / omega);
+      axpby(-omega, v, 1, p);
+      axpby(1, r, beta, p);
+      precondition(p, p_hat);
+      apply(p_hat, v);
+      alpha = rho_new / dot(r_hat, v);
+      // s = r - alpha v
+      copy(r, s);
+      axpby(-alpha, v, 1, s);
+      if (check_convergence(norm(s) / b_norm)) {
+        axpby(alpha, p_hat, 1, x);
+        return;
+      }
+      precondition(s, s_hat);
+      apply(s_hat, t);
+      const float64 tt = dot(t, t);
+      omega = tt == 0 ? 0 : dot(t, s) / tt;
+      axpby(alpha, p_hat, 1, x);
+      axpby(omega, s_hat, 1, x);
+      // r = s - omega t
+      copy(s, r);
+      axpby(-omega, t, 1, r);
+      if (check_convergence(norm(r) / b_norm) || omega == 0) {
+        return;
+      }
+      rho = rho_new;
+    }
+  }
+
+  // Preconditioned MINRES after Paige and Saunders. The residual is
+  // estimated in the M^-1 norm by the recurrence.
+  void solve_minres(const Scalar *b, Scalar *x) {
+    float64 b_norm;
+    if (!initialize(b, x, b_norm)) {
+      return;
+    }
+    auto *r1 = r_.data(), *r2 = s_.data(), *y = z_.data(), *v = p_.data();
+    auto *w = w_.data(), *w1 = w1_.data(), *w2 = w2_.data();
+    apply(x, r1);
+    axpby(1, b, -1, r1);
+    precondition(r1, y);
+    const float64 beta1_squared = dot(r1, y);
+    TI_ERROR_IF(beta1_squared < 0,
+                "The preconditioner is not positive definite");
+    const float64 beta1 = std::sqrt(beta1_squared);
+    if (beta1 == 0) {
+      check_convergence(0);
+      return;
+    }
+    copy(r1, r2);
+    std::fill(w, w + n_, Scalar(0));
+    std::fill(w2, w2 + n_, Scalar(0));
+    float64 old_beta = 0, beta = beta1, dbar = 0, epsilon = 0;
+    float64 phibar = beta1, cs = -1, sn = 0;
+    while (num_iterations_ < max_iterations_) {
+      num_iterations_++;
+      // v = y / beta, y = A v - (beta / old_beta) r1 - (alpha / beta) r2
+      axpby(1 / beta, y, 0, v);
+      apply(v, y);
+      if (num_iterations_ >= 2) {
+        axpby(-beta / old_beta, r1, 1, y);
+      }
+      const float64 alpha = dot(v, y);
+      axpby(-alpha / beta, r2, 1, y);
+      std::swap(r1, r2);
+      copy(y, r2);
+      precondition(r2, y);
+      old_beta = beta;
+      const float64 beta_squared = dot(r2, y);
+      TI_ERROR_IF(beta_squared < 0,
+                  "The preconditioner is not positive definite");
+      beta = std::sqrt(beta_squared);
+
+      // Apply the previous rotation, and compute the next one
+      const float64 old_epsilon = epsilon;
+      const float64 delta = cs * dbar + sn * alpha;
+      const float64 gbar = sn * dbar - cs * alpha;
+      epsilon = sn * beta;
+      dbar = -cs * beta;
+      const float64 gamma = std::max(std::hypot(gbar, beta),
+                                     std::numeric_limits<float64>::epsilon());
+      cs = gbar / gamma;
+      sn = beta / gamma;
+      const float64 phi = cs * phibar;
+      phibar = sn * phibar;
+
+      // w = (v - old_epsilon w1 - delta w2) / gamma, with (w1, w2) = (w2, w)
+      std::swap(w1, w2);
+      std::swap(w2, w);
+      copy(v, w);
+      axpby(-old_epsilon / gamma, w1, 1 / gamma, w);
+      axpby(-delta / gamma, w2, 1, w);
+      axpby(phi, w, 1, x);
+      if (check_convergence(phibar / beta1) || beta == 0) {
+        return;
+      }
+    }
+  }
+
+  static constexpr int kMinChunkSize = 4096;
+
+  std::string method_;
+  std::string preconditioner_;
+  int max_iterations_;
+  float64 tolerance_;
+
+  int n_{0};
+  int num_chunks_{1};
+  std::vector<float64> partial_sums_;
+
+  CsrMatrix<Scalar> matrix_;
+  MatVec matvec_;
+  Vector inv_diagonal_;
+  CsrMatrix<Scalar> ic_factor_;
+
+  // Work vectors
+  Vector r_, z_, p_, q_, s_, t_, u_, w_, w1_, w2_;
+};
+
+}  // namespace
+
+std::unique_ptr<IterativeSolver> make_iterative_solver(
+    DataType dtype,
+    const std::string &method,
+    const std::string &preconditioner,
+    int max_iterations,
+    float64 tolerance) {
+  if (dtype->is_primitive(PrimitiveTypeID::f64)) {
+    return std::make_unique<IterativeSolverImpl<float64>>(
+        method, preconditioner, max_iterations, tolerance);
+  } else if (dtype->is_primitive(PrimitiveTypeID::f32)) {
+    return std::make_unique<IterativeSolverImpl<float32>>(
+        method, preconditioner, max_iterations, tolerance);
+  } else {
+    TI_ERROR("Iterative solvers only support f32 and f64, got {}",
+             dtype->to_string());
+  }
+}
+
+}  // namespace lang
+}  // namespace taichi
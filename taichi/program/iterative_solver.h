@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+
+#include "taichi/program/sparse_matrix.h"
+
+namespace taichi {
+namespace lang {
+
+// Krylov subspace solvers for large sparse linear systems, running on the
+// CPU thread pool:
+//   - "CG" for symmetric positive definite systems,
+//   - "BiCGSTAB" for general systems,
+//   - "MINRES" for symmetric (possibly indefinite) systems,
+// with "none", "Jacobi" or "IC" (zero fill-in incomplete Cholesky)
+// preconditioning. The operator is either a SparseMatrix, or a user supplied
+// matrix-vector product (matrix-free).
+class IterativeSolver {
+ public:
+  // Computes y = A x, where x and y point to as many values of the data type
+  // of the solver as the operator has rows.
+  using MatVec = std::function<void(const void *x, void *y)>;
+
+  virtual ~IterativeSolver() = default;
+
+  // Uses |sm| as the operator and builds the preconditioner from it.
+  virtual void compute(const SparseMatrix &sm) = 0;
+
+  // Uses |matvec| as the operator of size |n|. The Jacobi preconditioner
+  // needs the |diagonal| of the operator (n values), which may be null
+  // otherwise. "IC" is not supported without a matrix.
+  virtual void set_operator(int n,
+                            const MatVec &matvec,
+                            const void *diagonal) = 0;
+
+  // Solves for |x| starting from its current values. Returns whether the
+  // relative residual reached the tolerance within the maximum number of
+  // iterations.
+  virtual bool solve(const void *b, void *x) = 0;
+
+  int num_iterations() const {
+    return num_iterations_;
+  }
+
+  // Residual norm of the last solve relative to the norm of b, or for MINRES,
+  // to the initial residual in the preconditioned norm
+  float64 residual() const {
+    return residual_;
+  }
+
+  bool info() const {
+    return converged_;
+  }
+
+ protected:
+  int num_iterations_{0};
+  float64 residual_{0};
+  bool converged_{false};
+};
+
+std::unique_ptr<IterativeSolver> make_iterative_solver(
+    DataType dtype,
+    const std::string &method,
+    const std::string &preconditioner,
+    int max_iterations,
+    float64 tolerance);
+
+}  // namespace lang
+}  // namespace taichi
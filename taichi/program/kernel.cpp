@@ -127,6 +127,7 @@ void Kernel::lower(bool to_executable) {
 }
 
 void Kernel::operator()(LaunchContextBuilder &ctx_builder) {
+  ctx_builder.get_context().rand_epoch = program->num_kernel_launches++;
   if (!program->config.async_mode || this->is_evaluator) {
     if (!compiled_) {
       compile();
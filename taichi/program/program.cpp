@@ -141,6 +141,14 @@ Program::Program(Arch desired_arch)
     }
   }
 
+  TI_ERROR_IF(config.random_generator != "xorshift" &&
+                  config.random_generator != "philox",
+              "Unknown random generator: {}", config.random_generator);
+  TI_ERROR_IF(config.random_generator == "philox" &&
+                  !arch_uses_llvm(config.arch),
+              "The philox random generator is not supported on arch={}",
+              arch_name(config.arch));
+
   stat.clear();
 
   Timelines::get_instance().set_enabled(config.timeline);
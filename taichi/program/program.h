@@ -103,6 +103,7 @@ class Program {
   Callable *current_callable{nullptr};
   CompileConfig config;
   bool sync{false};  // device/host synchronized?
+  uint32 num_kernel_launches{0};  // keys counter-based random numbers
 
   uint64 *result_buffer{nullptr};  // Note result_buffer is used by all backends
 
@@ -1,48 +1,245 @@
 #include "taichi/program/sparse_matrix.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <sstream>
 
 #include "Eigen/Dense"
 #include "Eigen/SparseLU"
+#include "taichi/program/program.h"
 
 namespace taichi {
 namespace lang {
 
+SparseThreadPool::SparseThreadPool()
+    : num_threads_(current_program
+                       ? current_program->config.cpu_max_num_threads
+                       : (int)std::thread::hardware_concurrency()) {
+  num_threads_ = std::max(1, num_threads_);
+}
+
 SparseMatrixBuilder::SparseMatrixBuilder(int rows,
                                          int cols,
-                                         int max_num_triplets)
-    : rows_(rows), cols_(cols), max_num_triplets_(max_num_triplets) {
-  data_.reserve(max_num_triplets * 3);
+                                         int max_num_triplets,
+                                         DataType dtype,
+                                         DataType index_dtype)
+    : max_num_triplets_(max_num_triplets),
+      rows_(rows),
+      cols_(cols),
+      dtype_(dtype),
+      index_dtype_(index_dtype) {
+  // Rejects unsupported types early
+  dispatch_sparse_matrix_type(dtype, index_dtype, [](auto) {});
+  triplet_size_ = dtype->is_primitive(PrimitiveTypeID::f64) ? 4 : 3;
+  data_.reset(new uint32[max_num_triplets_ * triplet_size_]);
   data_base_ptr_ = get_data_base_ptr();
 }
 
 void *SparseMatrixBuilder::get_data_base_ptr() {
-  return data_.data();
+  return data_.get();
 }
 
 void SparseMatrixBuilder::print_triplets() {
   fmt::print("n={}, m={}, num_triplets={} (max={})", rows_, cols_,
              num_triplets_, max_num_triplets_);
-  for (int64 i = 0; i < num_triplets_; i++) {
-    fmt::print("({}, {}) val={}", data_[i * 3], data_[i * 3 + 1],
-               taichi_union_cast<float32>(data_[i * 3 + 2]));
+  for (uint64 i = 0; i < std::min(num_triplets_, max_num_triplets_); i++) {
+    fmt::print("({}, {}) val={}", row(i), col(i), value<float64>(i));
   }
   fmt::print("\n");
 }
 
-SparseMatrix SparseMatrixBuilder::build() {
+template <typename Scalar>
+Scalar SparseMatrixBuilder::value(int triplet) const {
+  const uint32 *p = &data_[triplet * triplet_size_ + 2];
+  if (triplet_size_ == 4) {
+    float64 v;
+    std::memcpy(&v, p, sizeof(v));
+    return (Scalar)v;
+  } else {
+    return (Scalar)taichi_union_cast<float32>(*p);
+  }
+}
+
+std::unique_ptr<SparseMatrix> SparseMatrixBuilder::build() {
+  return build(dtype_, index_dtype_);
+}
+
+std::unique_ptr<SparseMatrix> SparseMatrixBuilder::build(
+    DataType dtype,
+    DataType index_dtype) {
+  return dispatch_sparse_matrix_type(
+      dtype, index_dtype, [this](auto tag) -> std::unique_ptr<SparseMatrix> {
+        using EigenMatrix = decltype(tag);
+        auto sm =
+            std::make_unique<EigenSparseMatrix<EigenMatrix>>(rows_, cols_);
+        build_matrix(sm->get_matrix());
+        return sm;
+      });
+}
+
+void SparseMatrixBuilder::build_into(SparseMatrix &sm) {
+  TI_ERROR_IF(sm.num_rows() != rows_ || sm.num_cols() != cols_,
+              "Cannot build a {}x{} sparse matrix into a {}x{} one", rows_,
+              cols_, sm.num_rows(), sm.num_cols());
+  dispatch_sparse_matrix_type(
+      sm.get_data_type(), sm.get_index_type(), [&](auto tag) {
+        using EigenMatrix = decltype(tag);
+        build_matrix(
+            static_cast<EigenSparseMatrix<EigenMatrix> &>(sm).get_matrix());
+      });
+}
+
+template <typename EigenMatrix>
+void SparseMatrixBuilder::build_matrix(EigenMatrix &matrix) {
   TI_ASSERT(built_ == false);
   built_ = true;
-  using T = Eigen::Triplet<float32>;
-  std::vector<T> triplets;
-  for (int i = 0; i < num_triplets_; i++) {
-    triplets.push_back(T(data_[i * 3], data_[i * 3 + 1],
-                         taichi_union_cast<float32>(data_[i * 3 + 2])));
+  TI_ERROR_IF(num_triplets_ > max_num_triplets_,
+              "{} triplets were inserted into a SparseMatrixBuilder with "
+              "max_num_triplets={}",
+              num_triplets_, max_num_triplets_);
+  // The indices are used to address host memory below
+  const int invalid = find_invalid_triplet();
+  TI_ERROR_IF(invalid >= 0,
+              "Triplet ({}, {}) is out of the bounds of a {}x{} "
+              "SparseMatrixBuilder",
+              (int32)row(invalid), (int32)col(invalid), rows_, cols_);
+  sort_triplets_by_column();
+  // The storage is overwritten as a compressed matrix
+  matrix.makeCompressed();
+  if (!fill_with_pattern(matrix)) {
+    build_with_new_pattern(matrix);
   }
-  SparseMatrix sm(rows_, cols_);
-  sm.get_matrix().setFromTriplets(triplets.begin(), triplets.end());
   clear();
-  return sm;
+}
+
+int SparseMatrixBuilder::find_invalid_triplet() const {
+  const int n = (int)num_triplets_;
+  std::atomic<int> first_invalid{n};
+  sparse_thread_pool().parallel_for(n, [&](int, int t) {
+    if (row(t) < (uint32)rows_ && col(t) < (uint32)cols_) {
+      return;
+    }
+    int current = first_invalid.load(std::memory_order_relaxed);
+    while (t < current && !first_invalid.compare_exchange_weak(
+                              current, t, std::memory_order_relaxed)) {
+    }
+  });
+  return first_invalid < n ? first_invalid.load() : -1;
+}
+
+void SparseMatrixBuilder::sort_triplets_by_column() {
+  const int n = (int)num_triplets_;
+  std::vector<std::atomic<int>> heads(cols_ + 1);
+  sparse_thread_pool().parallel_for(n, [&](int, int t) {
+    heads[col(t) + 1].fetch_add(1, std::memory_order_relaxed);
+  });
+  col_offsets_.resize(cols_ + 1);
+  col_offsets_[0] = 0;
+  for (int c = 0; c < cols_; c++) {
+    col_offsets_[c + 1] = col_offsets_[c] + heads[c + 1].load();
+    heads[c].store(col_offsets_[c]);
+  }
+  order_.resize(n);
+  sparse_thread_pool().parallel_for(n, [&](int, int t) {
+    order_[heads[col(t)].fetch_add(1, std::memory_order_relaxed)] = t;
+  });
+  // The scatter above is not deterministic. Sorting the columns by triplet
+  // index makes the order, and the summation order of duplicates, match the
+  // insertion order.
+  sparse_thread_pool().parallel_for(cols_, [&](int, int c) {
+    std::sort(order_.begin() + col_offsets_[c],
+              order_.begin() + col_offsets_[c + 1]);
+  });
+}
+
+template <typename EigenMatrix>
+bool SparseMatrixBuilder::fill_with_pattern(EigenMatrix &matrix) {
+  using Scalar = typename EigenMatrix::Scalar;
+  if ((int)pattern_outer_.size() != cols_ + 1) {
+    return false;
+  }
+  const int64 nnz = pattern_outer_.back();
+  matrix.resizeNonZeros(nnz);
+  auto *values = matrix.valuePtr();
+  std::fill(values, values + nnz, Scalar(0));
+  // Every entry of the pattern must be hit by some triplet, otherwise the
+  // matrix built from scratch would have fewer nonzeros.
+  std::vector<char> hit(nnz, 0);
+  std::atomic<bool> matched{true};
+  sparse_thread_pool().parallel_for(cols_, [&](int, int c) {
+    if (!matched.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const int *begin = pattern_inner_.data() + pattern_outer_[c];
+    const int *end = pattern_inner_.data() + pattern_outer_[c + 1];
+    int num_hits = 0;
+    for (int i = col_offsets_[c]; i < col_offsets_[c + 1]; i++) {
+      const int t = order_[i];
+      const int *it = std::lower_bound(begin, end, (int)row(t));
+      if (it == end || *it != (int)row(t)) {
+        matched.store(false, std::memory_order_relaxed);
+        return;
+      }
+      const auto k = it - pattern_inner_.data();
+      num_hits += !hit[k];
+      hit[k] = 1;
+      values[k] += value<Scalar>(t);
+    }
+    if (num_hits != end - begin) {
+      matched.store(false, std::memory_order_relaxed);
+    }
+  });
+  if (!matched) {
+    return false;
+  }
+  std::copy(pattern_outer_.begin(), pattern_outer_.end(),
+            matrix.outerIndexPtr());
+  std::copy(pattern_inner_.begin(), pattern_inner_.end(),
+            matrix.innerIndexPtr());
+  return true;
+}
+
+template <typename EigenMatrix>
+void SparseMatrixBuilder::build_with_new_pattern(EigenMatrix &matrix) {
+  using Scalar = typename EigenMatrix::Scalar;
+  // Sort each column by row and count the distinct rows
+  pattern_outer_.assign(cols_ + 1, 0);
+  sparse_thread_pool().parallel_for(cols_, [&](int, int c) {
+    auto begin = order_.begin() + col_offsets_[c];
+    auto end = order_.begin() + col_offsets_[c + 1];
+    std::stable_sort(begin, end,
+                     [&](int a, int b) { return row(a) < row(b); });
+    int count = 0;
+    for (auto it = begin; it != end; ++it) {
+      count += it == begin || row(*it) != row(*(it - 1));
+    }
+    pattern_outer_[c + 1] = count;
+  });
+  for (int c = 0; c < cols_; c++) {
+    pattern_outer_[c + 1] += pattern_outer_[c];
+  }
+
+  // Sum up the duplicates
+  const int64 nnz = pattern_outer_.back();
+  matrix.resizeNonZeros(nnz);
+  auto *inner = matrix.innerIndexPtr();
+  auto *values = matrix.valuePtr();
+  sparse_thread_pool().parallel_for(cols_, [&](int, int c) {
+    int64 k = pattern_outer_[c] - 1;
+    for (int i = col_offsets_[c]; i < col_offsets_[c + 1]; i++) {
+      const int t = order_[i];
+      if (i == col_offsets_[c] || row(t) != row(order_[i - 1])) {
+        k++;
+        inner[k] = row(t);
+        values[k] = 0;
+      }
+      values[k] += value<Scalar>(t);
+    }
+  });
+  std::copy(pattern_outer_.begin(), pattern_outer_.end(),
+            matrix.outerIndexPtr());
+  pattern_inner_.assign(inner, inner + nnz);
 }
 
 void SparseMatrixBuilder::clear() {
@@ -50,82 +247,375 @@ void SparseMatrixBuilder::clear() {
   num_triplets_ = 0;
 }
 
-SparseMatrix::SparseMatrix(Eigen::SparseMatrix<float32> &matrix) {
-  this->matrix_ = matrix;
+void SparseMatrix::check_same_type(const SparseMatrix &sm) const {
+  TI_ERROR_IF(dtype_ != sm.dtype_ || index_dtype_ != sm.index_dtype_,
+              "Mismatched sparse matrix types: ({}, {}) and ({}, {})",
+              dtype_->to_string(), index_dtype_->to_string(),
+              sm.dtype_->to_string(), sm.index_dtype_->to_string());
+}
+
+namespace {
+
+template <typename Scalar>
+DataType scalar_data_type() {
+  return std::is_same_v<Scalar, float64> ? PrimitiveType::f64
+                                         : PrimitiveType::f32;
+}
+
+template <typename StorageIndex>
+DataType index_data_type() {
+  return std::is_same_v<StorageIndex, int64> ? PrimitiveType::i64
+                                             : PrimitiveType::i32;
+}
+
+// Below this many nonzeros, the serial Eigen operations are faster.
+constexpr int64 kMinParallelNonZeros = 1 << 15;
+
+// Returns |m| if it is compressed, otherwise a compressed copy in |storage|.
+template <typename EigenMatrix>
+const EigenMatrix &compressed(const EigenMatrix &m, EigenMatrix &storage) {
+  if (m.isCompressed()) {
+    return m;
+  }
+  storage = m;
+  storage.makeCompressed();
+  return storage;
+}
+
+}  // namespace
+
+template <typename EigenMatrix>
+EigenSparseMatrix<EigenMatrix>::EigenSparseMatrix(int rows, int cols)
+    : SparseMatrix(rows,
+                   cols,
+                   scalar_data_type<Scalar>(),
+                   index_data_type<typename EigenMatrix::StorageIndex>()),
+      matrix_(rows, cols) {
+}
+
+template <typename EigenMatrix>
+EigenSparseMatrix<EigenMatrix>::EigenSparseMatrix(EigenMatrix matrix)
+    : EigenSparseMatrix(matrix.rows(), matrix.cols()) {
+  matrix_ = std::move(matrix);
 }
 
-SparseMatrix::SparseMatrix(int rows, int cols) : matrix_(rows, cols) {
+template <typename EigenMatrix>
+const EigenMatrix &EigenSparseMatrix<EigenMatrix>::other(
+    const SparseMatrix &sm) const {
+  check_same_type(sm);
+  return static_cast<const EigenSparseMatrix &>(sm).matrix_;
 }
 
-const std::string SparseMatrix::to_string() const {
+template <typename EigenMatrix>
+std::string EigenSparseMatrix<EigenMatrix>::to_string() const {
   Eigen::IOFormat clean_fmt(4, 0, ", ", "\n", "[", "]");
   // Note that the code below first converts the sparse matrix into a dense one.
   // https://stackoverflow.com/questions/38553335/how-can-i-print-in-console-a-formatted-sparse-matrix-with-eigen
+  using DenseMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
   std::ostringstream ostr;
-  ostr << Eigen::MatrixXf(matrix_).format(clean_fmt);
+  ostr << DenseMatrix(matrix_).format(clean_fmt);
   return ostr.str();
 }
 
-const int SparseMatrix::num_rows() const {
-  return matrix_.rows();
+template <typename EigenMatrix>
+float64 EigenSparseMatrix<EigenMatrix>::get_element(int row, int col) const {
+  return matrix_.coeff(row, col);
 }
-const int SparseMatrix::num_cols() const {
-  return matrix_.cols();
+
+template <typename EigenMatrix>
+void EigenSparseMatrix<EigenMatrix>::set_element(int row,
+                                                 int col,
+                                                 float64 value) {
+  invalidate_row_major();
+  matrix_.coeffRef(row, col) = (Scalar)value;
 }
 
-Eigen::SparseMatrix<float32> &SparseMatrix::get_matrix() {
-  return matrix_;
+template <typename EigenMatrix>
+template <typename Op>
+EigenMatrix EigenSparseMatrix<EigenMatrix>::merge(const EigenMatrix &other,
+                                                  bool union_pattern,
+                                                  const Op &op) const {
+  TI_ERROR_IF(other.rows() != rows_ || other.cols() != cols_,
+              "Mismatched sparse matrix shapes: ({}, {}) and ({}, {})", rows_,
+              cols_, other.rows(), other.cols());
+  EigenMatrix a_storage, b_storage;
+  const EigenMatrix &a = compressed(matrix_, a_storage);
+  const EigenMatrix &b = compressed(other, b_storage);
+  const auto *a_outer = a.outerIndexPtr();
+  const auto *a_inner = a.innerIndexPtr();
+  const auto *a_values = a.valuePtr();
+  const auto *b_outer = b.outerIndexPtr();
+  const auto *b_inner = b.innerIndexPtr();
+  const auto *b_values = b.valuePtr();
+
+  // Walks column c of both matrices, calling emit(row, a, b) for every row of
+  // the result pattern
+  auto merge_column = [&](int c, const auto &emit) {
+    StorageIndex i = a_outer[c], j = b_outer[c];
+    const StorageIndex i_end = a_outer[c + 1], j_end = b_outer[c + 1];
+    while (i < i_end || j < j_end) {
+      if (j == j_end || (i < i_end && a_inner[i] < b_inner[j])) {
+        if (union_pattern) {
+          emit(a_inner[i], a_values[i], Scalar(0));
+        }
+        i++;
+      } else if (i == i_end || b_inner[j] < a_inner[i]) {
+        if (union_pattern) {
+          emit(b_inner[j], Scalar(0), b_values[j]);
+        }
+        j++;
+      } else {
+        emit(a_inner[i], a_values[i], b_values[j]);
+        i++;
+        j++;
+      }
+    }
+  };
+
+  const bool parallel = a.nonZeros() + b.nonZeros() >= kMinParallelNonZeros;
+  auto for_each_column = [&](const auto &func) {
+    if (parallel) {
+      sparse_thread_pool().parallel_for(cols_, [&](int, int c) { func(c); });
+    } else {
+      for (int c = 0; c < cols_; c++) {
+        func(c);
+      }
+    }
+  };
+
+  EigenMatrix result(rows_, cols_);
+  auto *outer = result.outerIndexPtr();
+  outer[0] = 0;
+  for_each_column([&](int c) {
+    StorageIndex count = 0;
+    merge_column(c, [&](StorageIndex, Scalar, Scalar) { count++; });
+    outer[c + 1] = count;
+  });
+  for (int c = 0; c < cols_; c++) {
+    outer[c + 1] += outer[c];
+  }
+  result.resizeNonZeros(outer[cols_]);
+  auto *inner = result.innerIndexPtr();
+  auto *values = result.valuePtr();
+  for_each_column([&](int c) {
+    StorageIndex k = outer[c];
+    merge_column(c, [&](StorageIndex row, Scalar x, Scalar y) {
+      inner[k] = row;
+      values[k] = op(x, y);
+      k++;
+    });
+  });
+  return result;
 }
 
-const Eigen::SparseMatrix<float32> &SparseMatrix::get_matrix() const {
-  return matrix_;
+template <typename EigenMatrix>
+const typename EigenSparseMatrix<EigenMatrix>::RowMajorMatrix &
+EigenSparseMatrix<EigenMatrix>::row_major() const {
+  std::lock_guard<std::mutex> _(row_major_mutex_);
+  if (!row_major_) {
+    row_major_ = std::make_unique<RowMajorMatrix>(matrix_);
+    row_major_->makeCompressed();
+    // Splits the rows into blocks with about the same number of nonzeros
+    const auto *outer = row_major_->outerIndexPtr();
+    const int64 nnz = row_major_->nonZeros();
+    const int num_blocks = std::max(
+        1, std::min(rows_, sparse_thread_pool().num_threads() * 8));
+    row_blocks_.resize(num_blocks + 1);
+    for (int i = 0; i <= num_blocks; i++) {
+      const auto target = (StorageIndex)(nnz * i / num_blocks);
+      row_blocks_[i] =
+          (int)(std::lower_bound(outer, outer + rows_, target) - outer);
+    }
+    row_blocks_[num_blocks] = rows_;
+  }
+  return *row_major_;
 }
 
-SparseMatrix operator+(const SparseMatrix &sm1, const SparseMatrix &sm2) {
-  Eigen::SparseMatrix<float32> res(sm1.matrix_ + sm2.matrix_);
-  return SparseMatrix(res);
+template <typename EigenMatrix>
+template <typename T>
+Eigen::Matrix<T, Eigen::Dynamic, 1> EigenSparseMatrix<EigenMatrix>::spmv(
+    const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>> &b) const {
+  TI_ERROR_IF(b.size() != cols_,
+              "Mismatched sizes in sparse matrix-vector product: ({}, {}) and "
+              "{}",
+              rows_, cols_, b.size());
+  if (matrix_.nonZeros() < kMinParallelNonZeros) {
+    return (matrix_ * b.template cast<Scalar>()).template cast<T>();
+  }
+  const RowMajorMatrix &m = row_major();
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> b_cast;
+  const Scalar *x;
+  if constexpr (std::is_same_v<T, Scalar>) {
+    x = b.data();
+  } else {
+    b_cast = b.template cast<Scalar>();
+    x = b_cast.data();
+  }
+  const auto *outer = m.outerIndexPtr();
+  const auto *inner = m.innerIndexPtr();
+  const auto *values = m.valuePtr();
+  Eigen::Matrix<T, Eigen::Dynamic, 1> y(rows_);
+  sparse_thread_pool().parallel_for(
+      (int)row_blocks_.size() - 1, [&](int, int block) {
+        for (int r = row_blocks_[block]; r < row_blocks_[block + 1]; r++) {
+          Scalar sum = 0;
+          for (StorageIndex k = outer[r]; k < outer[r + 1]; k++) {
+            sum += values[k] * x[inner[k]];
+          }
+          y[r] = (T)sum;
+        }
+      });
+  return y;
 }
 
-SparseMatrix operator-(const SparseMatrix &sm1, const SparseMatrix &sm2) {
-  Eigen::SparseMatrix<float32> res(sm1.matrix_ - sm2.matrix_);
-  return SparseMatrix(res);
+template <typename EigenMatrix>
+std::unique_ptr<SparseMatrix> EigenSparseMatrix<EigenMatrix>::add(
+    const SparseMatrix &sm) const {
+  return std::make_unique<EigenSparseMatrix>(
+      merge(other(sm), /*union_pattern=*/true,
+            [](Scalar x, Scalar y) { return x + y; }));
 }
 
-SparseMatrix operator*(float scale, const SparseMatrix &sm) {
-  Eigen::SparseMatrix<float32> res(scale * sm.matrix_);
-  return SparseMatrix(res);
+template <typename EigenMatrix>
+std::unique_ptr<SparseMatrix> EigenSparseMatrix<EigenMatrix>::sub(
+    const SparseMatrix &sm) const {
+  return std::make_unique<EigenSparseMatrix>(
+      merge(other(sm), /*union_pattern=*/true,
+            [](Scalar x, Scalar y) { return x - y; }));
 }
 
-SparseMatrix operator*(const SparseMatrix &sm, float scale) {
-  return scale * sm;
+template <typename EigenMatrix>
+std::unique_ptr<SparseMatrix> EigenSparseMatrix<EigenMatrix>::scale(
+    float64 scale) const {
+  return std::make_unique<EigenSparseMatrix>(
+      EigenMatrix((Scalar)scale * matrix_));
 }
 
-SparseMatrix operator*(const SparseMatrix &sm1, const SparseMatrix &sm2) {
-  Eigen::SparseMatrix<float32> res(sm1.matrix_.cwiseProduct(sm2.matrix_));
-  return SparseMatrix(res);
+template <typename EigenMatrix>
+std::unique_ptr<SparseMatrix> EigenSparseMatrix<EigenMatrix>::mul(
+    const SparseMatrix &sm) const {
+  return std::make_unique<EigenSparseMatrix>(
+      merge(other(sm), /*union_pattern=*/false,
+            [](Scalar x, Scalar y) { return x * y; }));
 }
 
-SparseMatrix SparseMatrix::matmul(const SparseMatrix &sm) {
-  Eigen::SparseMatrix<float32> res(matrix_ * sm.matrix_);
-  return SparseMatrix(res);
+template <typename EigenMatrix>
+std::unique_ptr<SparseMatrix> EigenSparseMatrix<EigenMatrix>::matmul(
+    const SparseMatrix &sm) const {
+  const EigenMatrix &rhs = other(sm);
+  TI_ERROR_IF(cols_ != rhs.rows(),
+              "Mismatched sparse matrix shapes: ({}, {}) and ({}, {})", rows_,
+              cols_, rhs.rows(), rhs.cols());
+  if (matrix_.nonZeros() + rhs.nonZeros() < kMinParallelNonZeros) {
+    return std::make_unique<EigenSparseMatrix>(EigenMatrix(matrix_ * rhs));
+  }
+  // Column j of the result accumulates the columns of this matrix selected by
+  // the nonzeros of column j of |rhs| (Gustavson's algorithm). Each thread
+  // owns a dense accumulator, and a marker recording the last column in which
+  // each row was seen.
+  EigenMatrix a_storage, b_storage;
+  const EigenMatrix &a = compressed(matrix_, a_storage);
+  const EigenMatrix &b = compressed(rhs, b_storage);
+  const int cols = (int)b.cols();
+  const auto pool = sparse_thread_pool();
+  struct Workspace {
+    std::vector<Scalar> acc;
+    std::vector<int64> marker;
+    std::vector<StorageIndex> rows;
+  };
+  std::vector<Workspace> workspaces(pool.num_threads());
+  for (auto &ws : workspaces) {
+    ws.marker.assign(rows_, -1);
+  }
+
+  // Calls visit(row, value, first) for each product term of column j, where
+  // |first| tells whether |row| is new in the column
+  auto for_each_term = [&](Workspace &ws, int64 mark, int j,
+                           const auto &visit) {
+    for (auto k = b.outerIndexPtr()[j]; k < b.outerIndexPtr()[j + 1]; k++) {
+      const auto col = b.innerIndexPtr()[k];
+      const Scalar b_value = b.valuePtr()[k];
+      for (auto i = a.outerIndexPtr()[col]; i < a.outerIndexPtr()[col + 1];
+           i++) {
+        const auto row = a.innerIndexPtr()[i];
+        const bool first = ws.marker[row] != mark;
+        ws.marker[row] = mark;
+        visit(row, a.valuePtr()[i] * b_value, first);
+      }
+    }
+  };
+
+  EigenMatrix result(rows_, cols);
+  auto *outer = result.outerIndexPtr();
+  outer[0] = 0;
+  pool.parallel_for(cols, [&](int thread_id, int j) {
+    StorageIndex count = 0;
+    for_each_term(workspaces[thread_id], j, j,
+                  [&](StorageIndex, Scalar, bool first) { count += first; });
+    outer[j + 1] = count;
+  });
+  for (int j = 0; j < cols; j++) {
+    outer[j + 1] += outer[j];
+  }
+  result.resizeNonZeros(outer[cols]);
+  auto *inner = result.innerIndexPtr();
+  auto *values = result.valuePtr();
+  pool.parallel_for(cols, [&](int thread_id, int j) {
+    auto &ws = workspaces[thread_id];
+    ws.acc.resize(rows_);
+    ws.rows.clear();
+    // Marks of the first pass are in [0, cols)
+    for_each_term(ws, (int64)cols + j, j,
+                  [&](StorageIndex row, Scalar value, bool first) {
+                    if (first) {
+                      ws.rows.push_back(row);
+                      ws.acc[row] = value;
+                    } else {
+                      ws.acc[row] += value;
+                    }
+                  });
+    std::sort(ws.rows.begin(), ws.rows.end());
+    StorageIndex k = outer[j];
+    for (auto row : ws.rows) {
+      inner[k] = row;
+      values[k] = ws.acc[row];
+      k++;
+    }
+  });
+  return std::make_unique<EigenSparseMatrix>(std::move(result));
 }
 
-Eigen::VectorXf SparseMatrix::mat_vec_mul(
-    const Eigen::Ref<const Eigen::VectorXf> &b) {
-  return matrix_ * b;
+template <typename EigenMatrix>
+std::unique_ptr<SparseMatrix> EigenSparseMatrix<EigenMatrix>::transpose()
+    const {
+  return std::make_unique<EigenSparseMatrix>(EigenMatrix(matrix_.transpose()));
 }
 
-SparseMatrix SparseMatrix::transpose() {
-  Eigen::SparseMatrix<float32> res(matrix_.transpose());
-  return SparseMatrix(res);
+template <typename EigenMatrix>
+Eigen::VectorXf EigenSparseMatrix<EigenMatrix>::mat_vec_mul(
+    const Eigen::Ref<const Eigen::VectorXf> &b) const {
+  return spmv<float32>(b);
 }
 
-float32 SparseMatrix::get_element(int row, int col) {
-  return matrix_.coeff(row, col);
+template <typename EigenMatrix>
+Eigen::VectorXd EigenSparseMatrix<EigenMatrix>::mat_vec_mul(
+    const Eigen::Ref<const Eigen::VectorXd> &b) const {
+  return spmv<float64>(b);
 }
 
-void SparseMatrix::set_element(int row, int col, float32 value) {
-  matrix_.coeffRef(row, col) = value;
+template class EigenSparseMatrix<EigenSparseMatrixF32I32>;
+template class EigenSparseMatrix<EigenSparseMatrixF32I64>;
+template class EigenSparseMatrix<EigenSparseMatrixF64I32>;
+template class EigenSparseMatrix<EigenSparseMatrixF64I64>;
+
+std::unique_ptr<SparseMatrix> make_sparse_matrix(int rows,
+                                                 int cols,
+                                                 DataType dtype,
+                                                 DataType index_dtype) {
+  return dispatch_sparse_matrix_type(
+      dtype, index_dtype, [&](auto tag) -> std::unique_ptr<SparseMatrix> {
+        return std::make_unique<EigenSparseMatrix<decltype(tag)>>(rows, cols);
+      });
 }
 
 }  // namespace lang
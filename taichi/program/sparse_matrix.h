@@ -1,7 +1,11 @@
 #pragma once
 
+#include <mutex>
+
 #include "taichi/common/core.h"
 #include "taichi/inc/constants.h"
+#include "taichi/ir/type.h"
+#include "taichi/system/threading.h"
 #include "Eigen/Sparse"
 
 namespace taichi {
@@ -9,57 +13,276 @@ namespace lang {
 
 class SparseMatrix;
 
+// The parallel loops of sparse matrix assembly, operations and solvers run on
+// the shared thread pool, with as many threads as cpu_max_num_threads in the
+// config of the current program, or one per core if there is no program.
+class SparseThreadPool {
+ public:
+  SparseThreadPool();
+
+  int num_threads() const {
+    return num_threads_;
+  }
+
+  // Calls func(thread_id, i) for i in [0, n), where thread_id is less than
+  // num_threads().
+  template <typename Func>
+  void parallel_for(int n, const Func &func) const {
+    SharedThreadPool::get_instance().parallel_for(n, num_threads_, func);
+  }
+
+ private:
+  int num_threads_;
+};
+
+inline SparseThreadPool sparse_thread_pool() {
+  return SparseThreadPool();
+}
+
+// Triplets are written by insert_triplet() (f32 values, 3 words each) or
+// insert_triplet_f64() (f64 values, 4 words each) in the runtime, depending
+// on |dtype|.
 class SparseMatrixBuilder {
  public:
-  SparseMatrixBuilder(int rows, int cols, int max_num_triplets);
+  SparseMatrixBuilder(int rows,
+                      int cols,
+                      int max_num_triplets,
+                      DataType dtype = PrimitiveType::f32,
+                      DataType index_dtype = PrimitiveType::i32);
 
   void *get_data_base_ptr();
 
   void print_triplets();
 
-  SparseMatrix build();
+  // Builds a matrix of the data and index types of the builder.
+  std::unique_ptr<SparseMatrix> build();
+
+  std::unique_ptr<SparseMatrix> build(DataType dtype, DataType index_dtype);
+
+  // Builds the matrix into |sm| in place, whose shape must match the builder.
+  // If the sparsity pattern is unchanged, only the values of |sm| change, so
+  // a solver can reuse its analysis of the pattern.
+  void build_into(SparseMatrix &sm);
 
   void clear();
 
+  DataType get_data_type() const {
+    return dtype_;
+  }
+
+  DataType get_index_type() const {
+    return index_dtype_;
+  }
+
  private:
+  uint32 row(int triplet) const {
+    return data_[triplet * triplet_size_];
+  }
+
+  uint32 col(int triplet) const {
+    return data_[triplet * triplet_size_ + 1];
+  }
+
+  template <typename Scalar>
+  Scalar value(int triplet) const;
+
+  template <typename EigenMatrix>
+  void build_matrix(EigenMatrix &matrix);
+
+  // Returns the first triplet whose row or column is out of bounds, or -1.
+  int find_invalid_triplet() const;
+
+  // Stable counting sort of the triplets by column into |order_|
+  void sort_triplets_by_column();
+
+  // Fills the values of |matrix| if the triplets have exactly the sparsity
+  // pattern of the last built matrix.
+  template <typename EigenMatrix>
+  bool fill_with_pattern(EigenMatrix &matrix);
+
+  // Builds |matrix| from scratch, and records its sparsity pattern.
+  template <typename EigenMatrix>
+  void build_with_new_pattern(EigenMatrix &matrix);
+
+  // The first three members are accessed by the runtime, which drops the
+  // triplets beyond |max_num_triplets_| but still counts them.
   uint64 num_triplets_{0};
   void *data_base_ptr_{nullptr};
-  std::vector<uint32> data_;
+  uint64 max_num_triplets_{0};
+  // Not initialized, so that the pages are only committed when written to.
+  std::unique_ptr<uint32[]> data_;
   int rows_{0};
   int cols_{0};
-  uint64 max_num_triplets_{0};
+  DataType dtype_;
+  DataType index_dtype_;
+  int triplet_size_{3};
   bool built_{false};
+
+  // Triplet indices sorted by column, and where each column starts
+  std::vector<int> order_;
+  std::vector<int> col_offsets_;
+  // Sparsity pattern of the last built matrix in compressed column storage
+  std::vector<int64> pattern_outer_;
+  std::vector<int> pattern_inner_;
 };
 
+// A sparse matrix of f32 or f64 values with i32 or i64 storage indices. The
+// operands of binary operations must have the same data and index types.
 class SparseMatrix {
  public:
-  SparseMatrix() = delete;
-  SparseMatrix(int rows, int cols);
-  SparseMatrix(Eigen::SparseMatrix<float32> &matrix);
-
-  const int num_rows() const;
-  const int num_cols() const;
-  const std::string to_string() const;
-  Eigen::SparseMatrix<float32> &get_matrix();
-  const Eigen::SparseMatrix<float32> &get_matrix() const;
-  float32 get_element(int row, int col);
-  void set_element(int row, int col, float32 value);
-
-  friend SparseMatrix operator+(const SparseMatrix &sm1,
-                                const SparseMatrix &sm2);
-  friend SparseMatrix operator-(const SparseMatrix &sm1,
-                                const SparseMatrix &sm2);
-  friend SparseMatrix operator*(float scale, const SparseMatrix &sm);
-  friend SparseMatrix operator*(const SparseMatrix &sm, float scale);
-  friend SparseMatrix operator*(const SparseMatrix &sm1,
-                                const SparseMatrix &sm2);
-  SparseMatrix matmul(const SparseMatrix &sm);
-  Eigen::VectorXf mat_vec_mul(const Eigen::Ref<const Eigen::VectorXf> &b);
-
-  SparseMatrix transpose();
+  SparseMatrix(int rows, int cols, DataType dtype, DataType index_dtype)
+      : rows_(rows), cols_(cols), dtype_(dtype), index_dtype_(index_dtype) {
+  }
+
+  virtual ~SparseMatrix() = default;
+
+  int num_rows() const {
+    return rows_;
+  }
+
+  int num_cols() const {
+    return cols_;
+  }
+
+  DataType get_data_type() const {
+    return dtype_;
+  }
+
+  DataType get_index_type() const {
+    return index_dtype_;
+  }
+
+  virtual std::string to_string() const = 0;
+  virtual float64 get_element(int row, int col) const = 0;
+  virtual void set_element(int row, int col, float64 value) = 0;
+
+  virtual std::unique_ptr<SparseMatrix> add(const SparseMatrix &sm) const = 0;
+  virtual std::unique_ptr<SparseMatrix> sub(const SparseMatrix &sm) const = 0;
+  virtual std::unique_ptr<SparseMatrix> scale(float64 scale) const = 0;
+  // Element-wise product
+  virtual std::unique_ptr<SparseMatrix> mul(const SparseMatrix &sm) const = 0;
+  virtual std::unique_ptr<SparseMatrix> matmul(
+      const SparseMatrix &sm) const = 0;
+  virtual std::unique_ptr<SparseMatrix> transpose() const = 0;
+
+  virtual Eigen::VectorXf mat_vec_mul(
+      const Eigen::Ref<const Eigen::VectorXf> &b) const = 0;
+  virtual Eigen::VectorXd mat_vec_mul(
+      const Eigen::Ref<const Eigen::VectorXd> &b) const = 0;
+
+ protected:
+  void check_same_type(const SparseMatrix &sm) const;
+
+  int rows_{0};
+  int cols_{0};
+  DataType dtype_;
+  DataType index_dtype_;
+};
+
+template <typename EigenMatrix>
+class EigenSparseMatrix : public SparseMatrix {
+ public:
+  using Scalar = typename EigenMatrix::Scalar;
+  using StorageIndex = typename EigenMatrix::StorageIndex;
+
+  EigenSparseMatrix(int rows, int cols);
+  explicit EigenSparseMatrix(EigenMatrix matrix);
+
+  // The matrix may be modified through the returned reference.
+  EigenMatrix &get_matrix() {
+    invalidate_row_major();
+    return matrix_;
+  }
+
+  const EigenMatrix &get_matrix() const {
+    return matrix_;
+  }
+
+  std::string to_string() const override;
+  float64 get_element(int row, int col) const override;
+  void set_element(int row, int col, float64 value) override;
+
+  std::unique_ptr<SparseMatrix> add(const SparseMatrix &sm) const override;
+  std::unique_ptr<SparseMatrix> sub(const SparseMatrix &sm) const override;
+  std::unique_ptr<SparseMatrix> scale(float64 scale) const override;
+  std::unique_ptr<SparseMatrix> mul(const SparseMatrix &sm) const override;
+  std::unique_ptr<SparseMatrix> matmul(const SparseMatrix &sm) const override;
+  std::unique_ptr<SparseMatrix> transpose() const override;
+
+  Eigen::VectorXf mat_vec_mul(
+      const Eigen::Ref<const Eigen::VectorXf> &b) const override;
+  Eigen::VectorXd mat_vec_mul(
+      const Eigen::Ref<const Eigen::VectorXd> &b) const override;
 
  private:
-  Eigen::SparseMatrix<float32, Eigen::ColMajor> matrix_;
+  using RowMajorMatrix =
+      Eigen::SparseMatrix<Scalar, Eigen::RowMajor, StorageIndex>;
+
+  const EigenMatrix &other(const SparseMatrix &sm) const;
+
+  // Merges the columns of the two matrices in parallel. The result has the
+  // union of the patterns if |union_pattern|, otherwise their intersection.
+  template <typename Op>
+  EigenMatrix merge(const EigenMatrix &other,
+                    bool union_pattern,
+                    const Op &op) const;
+
+  template <typename T>
+  Eigen::Matrix<T, Eigen::Dynamic, 1> spmv(
+      const Eigen::Ref<const Eigen::Matrix<T, Eigen::Dynamic, 1>> &b) const;
+
+  // Row-major copy of the matrix for parallel SpMV, built on demand
+  const RowMajorMatrix &row_major() const;
+
+  void invalidate_row_major() {
+    std::lock_guard<std::mutex> _(row_major_mutex_);
+    row_major_.reset();
+  }
+
+  EigenMatrix matrix_;
+
+  mutable std::mutex row_major_mutex_;
+  mutable std::unique_ptr<RowMajorMatrix> row_major_;
+  // Row blocks of the row-major copy with similar numbers of nonzeros
+  mutable std::vector<int> row_blocks_;
 };
+
+using EigenSparseMatrixF32I32 =
+    Eigen::SparseMatrix<float32, Eigen::ColMajor, int32>;
+using EigenSparseMatrixF32I64 =
+    Eigen::SparseMatrix<float32, Eigen::ColMajor, int64>;
+using EigenSparseMatrixF64I32 =
+    Eigen::SparseMatrix<float64, Eigen::ColMajor, int32>;
+using EigenSparseMatrixF64I64 =
+    Eigen::SparseMatrix<float64, Eigen::ColMajor, int64>;
+
+// Calls |func| with a value of the Eigen matrix type for the given data and
+// index types.
+template <typename Func>
+auto dispatch_sparse_matrix_type(DataType dtype,
+                                 DataType index_dtype,
+                                 const Func &func) {
+  const bool is_f64 = dtype->is_primitive(PrimitiveTypeID::f64);
+  const bool is_i64 = index_dtype->is_primitive(PrimitiveTypeID::i64);
+  TI_ERROR_IF(!is_f64 && !dtype->is_primitive(PrimitiveTypeID::f32),
+              "SparseMatrix only supports f32 and f64, got {}",
+              dtype->to_string());
+  TI_ERROR_IF(!is_i64 && !index_dtype->is_primitive(PrimitiveTypeID::i32),
+              "SparseMatrix only supports i32 and i64 indices, got {}",
+              index_dtype->to_string());
+  if (is_f64) {
+    return is_i64 ? func(EigenSparseMatrixF64I64())
+                  : func(EigenSparseMatrixF64I32());
+  } else {
+    return is_i64 ? func(EigenSparseMatrixF32I64())
+                  : func(EigenSparseMatrixF32I32());
+  }
+}
+
+std::unique_ptr<SparseMatrix> make_sparse_matrix(int rows,
+                                                 int cols,
+                                                 DataType dtype,
+                                                 DataType index_dtype);
+
 }  // namespace lang
 }  // namespace taichi
@@ -1,15 +1,15 @@
 #include "sparse_solver.h"
 
+#include <algorithm>
 #include <unordered_map>
 
-#define MAKE_SOLVER(type, order)                                              \
-  {                                                                           \
-    {#type, #order}, []() -> std::unique_ptr<SparseSolver> {                  \
-      using T =                                                               \
-          Eigen::Simplicial##type<Eigen::SparseMatrix<float32>, Eigen::Lower, \
-                                  Eigen::order##Ordering<int>>;               \
-      return std::make_unique<EigenSparseSolver<T>>();                        \
-    }                                                                         \
+#define MAKE_SOLVER(type, order)                                         \
+  {                                                                      \
+    {#type, #order}, []() -> std::unique_ptr<SparseSolver> {             \
+      using T = Eigen::Simplicial##type<EigenMatrix, Eigen::Lower,       \
+                                        Eigen::order##Ordering<Index>>; \
+      return std::make_unique<EigenSparseSolver<T>>();                   \
+    }                                                                    \
   }
 
 namespace {
@@ -27,27 +27,89 @@ namespace taichi {
 namespace lang {
 
 template <class EigenSolver>
-bool EigenSparseSolver<EigenSolver>::compute(const SparseMatrix &sm) {
-  solver_.compute(sm.get_matrix());
-  if (solver_.info() != Eigen::Success) {
+const typename EigenSparseSolver<EigenSolver>::EigenMatrix &
+EigenSparseSolver<EigenSolver>::get_matrix(const SparseMatrix &sm) {
+  auto *matrix = dynamic_cast<const EigenSparseMatrix<EigenMatrix> *>(&sm);
+  TI_ERROR_IF(matrix == nullptr,
+              "The sparse matrix of type ({}, {}) does not match the solver",
+              sm.get_data_type()->to_string(),
+              sm.get_index_type()->to_string());
+  return matrix->get_matrix();
+}
+
+template <class EigenSolver>
+void EigenSparseSolver<EigenSolver>::analyze(const EigenMatrix &matrix) {
+  solver_.analyzePattern(matrix);
+  num_analyses_++;
+  if (matrix.isCompressed()) {
+    const auto *outer = matrix.outerIndexPtr();
+    pattern_outer_.assign(outer, outer + matrix.outerSize() + 1);
+    pattern_inner_.assign(matrix.innerIndexPtr(),
+                          matrix.innerIndexPtr() + matrix.nonZeros());
+  } else {
+    // Not worth comparing, analyze it again next time
+    pattern_outer_.clear();
+    pattern_inner_.clear();
+  }
+}
+
+template <class EigenSolver>
+bool EigenSparseSolver<EigenSolver>::is_analyzed(
+    const EigenMatrix &matrix) const {
+  if (pattern_outer_.empty() || !matrix.isCompressed() ||
+      (int64)pattern_outer_.size() != (int64)matrix.outerSize() + 1 ||
+      (int64)pattern_inner_.size() != (int64)matrix.nonZeros()) {
     return false;
-  } else
-    return true;
+  }
+  return std::equal(pattern_outer_.begin(), pattern_outer_.end(),
+                    matrix.outerIndexPtr()) &&
+         std::equal(pattern_inner_.begin(), pattern_inner_.end(),
+                    matrix.innerIndexPtr());
+}
+
+template <class EigenSolver>
+bool EigenSparseSolver<EigenSolver>::compute(const SparseMatrix &sm) {
+  factorize(sm);
+  return info();
 }
+
 template <class EigenSolver>
 void EigenSparseSolver<EigenSolver>::analyze_pattern(const SparseMatrix &sm) {
-  solver_.analyzePattern(sm.get_matrix());
+  analyze(get_matrix(sm));
 }
 
 template <class EigenSolver>
 void EigenSparseSolver<EigenSolver>::factorize(const SparseMatrix &sm) {
-  solver_.factorize(sm.get_matrix());
+  const auto &matrix = get_matrix(sm);
+  if (!is_analyzed(matrix)) {
+    analyze(matrix);
+  }
+  solver_.factorize(matrix);
 }
 
 template <class EigenSolver>
 Eigen::VectorXf EigenSparseSolver<EigenSolver>::solve(
     const Eigen::Ref<const Eigen::VectorXf> &b) {
-  return solver_.solve(b);
+  return Vector(solver_.solve(b.cast<Scalar>())).template cast<float32>();
+}
+
+template <class EigenSolver>
+Eigen::VectorXd EigenSparseSolver<EigenSolver>::solve(
+    const Eigen::Ref<const Eigen::VectorXd> &b) {
+  return Vector(solver_.solve(b.cast<Scalar>())).template cast<float64>();
+}
+
+template <class EigenSolver>
+void EigenSparseSolver<EigenSolver>::solve_in_place(const void *b, void *x) {
+  const auto n = solver_.rows();
+  Eigen::Map<const Vector> b_map((const Scalar *)b, n);
+  Eigen::Map<Vector> x_map((Scalar *)x, n);
+  if (b == x) {
+    // Eigen's solvers don't support aliasing
+    x_map = Vector(solver_.solve(b_map));
+  } else {
+    x_map = solver_.solve(b_map);
+  }
 }
 
 template <class EigenSolver>
@@ -55,8 +117,13 @@ bool EigenSparseSolver<EigenSolver>::info() {
   return solver_.info() == Eigen::Success;
 }
 
-std::unique_ptr<SparseSolver> make_sparse_solver(const std::string &solver_type,
-                                                 const std::string &ordering) {
+namespace {
+
+template <typename EigenMatrix>
+std::unique_ptr<SparseSolver> make_eigen_sparse_solver(
+    const std::string &solver_type,
+    const std::string &ordering) {
+  using Index = typename EigenMatrix::StorageIndex;
   using key_type = std::pair<std::string, std::string>;
   using func_type = std::unique_ptr<SparseSolver> (*)();
   static const std::unordered_map<key_type, func_type, pair_hash>
@@ -73,11 +140,22 @@ std::unique_ptr<SparseSolver> make_sparse_solver(const std::string &solver_type,
     auto solver_func = solver_factory.at(solver_key);
     return solver_func();
   } else if (solver_type == "LU") {
-    using LU = Eigen::SparseLU<Eigen::SparseMatrix<float32>>;
+    using LU = Eigen::SparseLU<EigenMatrix>;
     return std::make_unique<EigenSparseSolver<LU>>();
   } else
     TI_ERROR("Not supported sparse solver type: {}", solver_type);
 }
 
+}  // namespace
+
+std::unique_ptr<SparseSolver> make_sparse_solver(DataType dtype,
+                                                 DataType index_dtype,
+                                                 const std::string &solver_type,
+                                                 const std::string &ordering) {
+  return dispatch_sparse_matrix_type(dtype, index_dtype, [&](auto tag) {
+    return make_eigen_sparse_solver<decltype(tag)>(solver_type, ordering);
+  });
+}
+
 }  // namespace lang
 }  // namespace taichi
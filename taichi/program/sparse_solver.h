@@ -5,20 +5,53 @@
 namespace taichi {
 namespace lang {
 
+// The symbolic analysis (ordering and elimination tree) of a sparsity pattern
+// is reused by compute() and factorize() as long as the pattern of the
+// matrices does not change, e.g. when SparseMatrixBuilder::build_into()
+// refills the same matrix every frame.
 class SparseSolver {
  public:
   virtual ~SparseSolver() = default;
+  // Analyzes the pattern of |sm| if it is not the analyzed one, and
+  // factorizes |sm|.
   virtual bool compute(const SparseMatrix &sm) = 0;
   virtual void analyze_pattern(const SparseMatrix &sm) = 0;
   virtual void factorize(const SparseMatrix &sm) = 0;
   virtual Eigen::VectorXf solve(const Eigen::Ref<const Eigen::VectorXf> &b) = 0;
+  virtual Eigen::VectorXd solve(const Eigen::Ref<const Eigen::VectorXd> &b) = 0;
+  // |b| and |x| point to as many values of the data type of the solver as
+  // the factorized matrix has rows. |x| may alias |b|.
+  virtual void solve_in_place(const void *b, void *x) = 0;
   virtual bool info() = 0;
+
+  // Number of symbolic analyses done so far
+  int num_analyses() const {
+    return num_analyses_;
+  }
+
+ protected:
+  int num_analyses_{0};
 };
 
 template <class EigenSolver>
 class EigenSparseSolver : public SparseSolver {
  private:
+  using EigenMatrix = typename EigenSolver::MatrixType;
+  using Scalar = typename EigenMatrix::Scalar;
+  using StorageIndex = typename EigenMatrix::StorageIndex;
+  using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+  const EigenMatrix &get_matrix(const SparseMatrix &sm);
+
+  void analyze(const EigenMatrix &matrix);
+
+  // Whether |matrix| has the pattern of the last analysis
+  bool is_analyzed(const EigenMatrix &matrix) const;
+
   EigenSolver solver_;
+  // Sparsity pattern of the last analysis, empty if none
+  std::vector<StorageIndex> pattern_outer_;
+  std::vector<StorageIndex> pattern_inner_;
 
  public:
   virtual ~EigenSparseSolver() = default;
@@ -27,10 +60,16 @@ class EigenSparseSolver : public SparseSolver {
   virtual void factorize(const SparseMatrix &sm) override;
   virtual Eigen::VectorXf solve(
       const Eigen::Ref<const Eigen::VectorXf> &b) override;
+  virtual Eigen::VectorXd solve(
+      const Eigen::Ref<const Eigen::VectorXd> &b) override;
+  virtual void solve_in_place(const void *b, void *x) override;
   virtual bool info() override;
 };
 
-std::unique_ptr<SparseSolver> make_sparse_solver(const std::string &solver_type,
+// The solver only accepts matrices of the given data and index types.
+std::unique_ptr<SparseSolver> make_sparse_solver(DataType dtype,
+                                                 DataType index_dtype,
+                                                 const std::string &solver_type,
                                                  const std::string &ordering);
 
 }  // namespace lang
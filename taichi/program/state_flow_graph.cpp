@@ -431,6 +431,11 @@ bool StateFlowGraph::optimize_listgen() {
 
   for (auto &record : listgen_nodes) {
     auto &listgens = record.second;
+    if (std::none_of(listgens.begin(), listgens.end(),
+                     [](const Node *n) { return n->dirty; })) {
+      // Already optimized in a previous round.
+      continue;
+    }
 
     // Thanks to the dependency edges, the order of nodes in listgens is
     // UNIQUE. (Consider the list state of the SNode.)
@@ -509,6 +514,7 @@ bool StateFlowGraph::optimize_listgen() {
           ir_bank_->insert(std::move(new_ir), new_handle.hash());
           clear_node->rec.ir_handle = new_handle;
           clear_node->meta = get_task_meta(ir_bank_, clear_node->rec);
+          mark_as_modified(clear_node);
         }
 
         TI_DEBUG("Common list generation {} and (to erase) {}",
@@ -584,6 +590,13 @@ std::unordered_set<int> StateFlowGraph::fuse_range(int begin, int end) {
   std::vector<Bitset> has_path, has_path_reverse;
   std::tie(has_path, has_path_reverse) = compute_transitive_closure(begin, end);
 
+  // Pairs of clean nodes have been considered in a previous round, so we only
+  // fuse pairs with at least one dirty node.
+  Bitset dirty(n);
+  for (int i = 0; i < n; i++) {
+    dirty[i] = nodes[i]->dirty;
+  }
+
   // Classify tasks by TaskFusionMeta.
   std::vector<TaskFusionMeta> fusion_meta(n);
   // It seems that std::set is slightly faster than std::unordered_set here.
@@ -625,6 +638,8 @@ std::unordered_set<int> StateFlowGraph::fuse_range(int begin, int end) {
     rec_a.ir_handle =
         ir_bank_->fuse(rec_a.ir_handle, rec_b.ir_handle, rec_a.kernel);
     rec_b.ir_handle = IRHandle();
+    node_a->dirty = true;
+    dirty[a] = true;
 
     // Convert to the index in nodes_.
     indices_to_delete.insert(b + begin + first_pending_task_index_);
@@ -741,6 +756,9 @@ std::unordered_set<int> StateFlowGraph::fuse_range(int begin, int end) {
           // Fuse no more than remaining_fuses tasks into task a,
           // otherwise do_fuse may be very slow
           Bitset current_mask = (mask & ~(has_path[a] | has_path_reverse[a]));
+          if (!dirty[a]) {
+            current_mask &= dirty;
+          }
           int b = a + 1;
           int remaining_fuses = initial_remaining_fuses_per_task;
           while ((b != -1) && (remaining_fuses > 0)) {
@@ -774,7 +792,8 @@ std::unordered_set<int> StateFlowGraph::fuse_range(int begin, int end) {
             for (int &j = start_index[i];
                  (j < (int)indices.size()) && (remaining_fuses > 0); j++) {
               const int b = indices[j];
-              if (!fused[b] && !has_path[a][b] && !has_path[b][a]) {
+              if (!fused[b] && (dirty[a] || dirty[b]) && !has_path[a][b] &&
+                  !has_path[b][a]) {
                 do_fuse(a, b);
                 remaining_fuses--;
               }
@@ -797,7 +816,8 @@ std::unordered_set<int> StateFlowGraph::fuse_range(int begin, int end) {
       for (auto &edge : nodes[i]->output_edges.get_all_edges()) {
         if (edge.second->pending()) {
           const int j = edge.second->pending_node_id - begin;
-          if (j >= 0 && j < nodes.size() && edge_fusible(i, j)) {
+          if (j >= 0 && j < nodes.size() && (dirty[i] || dirty[j]) &&
+              edge_fusible(i, j)) {
             do_fuse(i, j);
             // Iterators of nodes[i]->output_edges may be invalidated
             break;
@@ -822,8 +842,15 @@ bool StateFlowGraph::fuse() {
   // times with (end - begin) <= 2 * kMaxFusionDistance.
   std::unordered_set<int> indices_to_delete;
   const int n = num_pending_tasks();
+  const int first_dirty = first_dirty_pending_task();
+  if (first_dirty == n) {
+    return false;
+  }
   if (true) {
-    indices_to_delete = fuse_range(0, n);
+    // Tasks optimized in previous rounds are only fused with dirty ones if
+    // they are at most kMaxFusionDistance tasks before the first dirty task.
+    indices_to_delete =
+        fuse_range(std::max(0, first_dirty - kMaxFusionDistance), n);
   } else {
     // TODO: fuse by range
     for (int i = 0; i < n; i += kMaxFusionDistance * 2) {
@@ -856,17 +883,24 @@ void StateFlowGraph::rebuild_graph(bool sort) {
   if (sort)
     topo_sort_nodes();
   std::vector<TaskLaunchRecord> tasks;
+  std::vector<bool> dirty;
   tasks.reserve(nodes_.size());
+  dirty.reserve(nodes_.size());
   int num_executed_tasks = 0;
   for (int i = 1; i < (int)nodes_.size(); i++) {
     if (!nodes_[i]->rec.empty()) {
       tasks.push_back(nodes_[i]->rec);
+      dirty.push_back(nodes_[i]->dirty);
       if (nodes_[i]->executed())
         num_executed_tasks++;
     }
   }
   clear();
   insert_tasks(tasks, false);
+  TI_ASSERT(nodes_.size() == tasks.size() + 1);
+  for (int i = 1; i < (int)nodes_.size(); i++) {
+    nodes_[i]->dirty = dirty[i - 1];
+  }
   for (int i = 1; i <= num_executed_tasks; i++) {
     nodes_[i]->mark_executed();
   }
@@ -1206,6 +1240,8 @@ void StateFlowGraph::delete_nodes(
 
   for (auto &i : indices_to_delete) {
     TI_ASSERT(nodes_[i]->pending());
+    // Paths through the deleted node disappear.
+    mark_as_modified(nodes_[i].get());
     nodes_[i]->disconnect_all();
     nodes_to_delete.insert(nodes_[i].get());
   }
@@ -1242,6 +1278,16 @@ bool StateFlowGraph::optimize_dead_store() {
 
   auto nodes = get_pending_tasks();
   for (auto &task : nodes) {
+    // Whether a store is dead depends on the task itself and the tasks it
+    // has output edges to. If none of them is dirty, the result would be the
+    // same as in the previous round.
+    bool needs_dse = task->dirty;
+    for (auto &edge : task->output_edges.get_all_edges()) {
+      needs_dse = needs_dse || edge.second->dirty;
+    }
+    if (!needs_dse) {
+      continue;
+    }
     // Dive into this task and erase dead stores
     std::set<const SNode *> store_eliminable_snodes;
     // Try to find unnecessary output state
@@ -1296,6 +1342,7 @@ bool StateFlowGraph::optimize_dead_store() {
         modified = true;
         task->rec.ir_handle = new_handle;
         task->meta = get_task_meta(ir_bank_, task->rec);
+        mark_as_modified(task);
       }
       bool first_compute = !dse_result.second;
       if (first_compute && modified) {
@@ -1476,6 +1523,12 @@ bool StateFlowGraph::demote_activation() {
     TI_ASSERT(nodes.size() > 0);
     if (nodes.size() <= 1)
       continue;
+    if (!task.first.second->dirty &&
+        std::none_of(nodes.begin(), nodes.end(),
+                     [](const Node *n) { return n->dirty; })) {
+      // Already optimized in a previous round.
+      continue;
+    }
 
     // Starting from the second task in the list, activations may be demoted
     auto new_handle = ir_bank_->demote_activation(nodes[0]->rec.ir_handle);
@@ -1484,11 +1537,13 @@ bool StateFlowGraph::demote_activation() {
       TI_ASSERT(!nodes[1]->executed());
       nodes[1]->rec.ir_handle = new_handle;
       nodes[1]->meta = get_task_meta(ir_bank_, nodes[1]->rec);
+      mark_as_modified(nodes[1]);
       // Copy nodes[1] replacement result to later nodes
       for (int j = 2; j < (int)nodes.size(); j++) {
         TI_ASSERT(!nodes[j]->executed());
         nodes[j]->rec.ir_handle = new_handle;
         nodes[j]->meta = nodes[1]->meta;
+        mark_as_modified(nodes[j]);
       }
       // For every "demote_activation" call, we only optimize for a single key
       // in std::map<std::pair<IRHandle, Node *>, std::vector<Node *>> tasks
@@ -1514,7 +1569,76 @@ void StateFlowGraph::mark_list_as_dirty(SNode *snode) {
   }
 }
 
-void StateFlowGraph::benchmark_rebuild_graph() {
+void StateFlowGraph::mark_as_modified(Node *node) {
+  node->dirty = true;
+  for (auto &edge : node->input_edges.get_all_edges()) {
+    edge.second->dirty = true;
+  }
+  for (auto &edge : node->output_edges.get_all_edges()) {
+    edge.second->dirty = true;
+  }
+}
+
+void StateFlowGraph::mark_nodes_as_optimized() {
+  for (auto &node : nodes_) {
+    node->dirty = false;
+  }
+}
+
+void StateFlowGraph::unsort_node_edges() {
+  for (auto &node : nodes_) {
+    node->input_edges.unsort_edges();
+    node->output_edges.unsort_edges();
+  }
+}
+
+int StateFlowGraph::first_dirty_pending_task() const {
+  for (int i = first_pending_task_index_; i < (int)nodes_.size(); i++) {
+    if (nodes_[i]->dirty) {
+      return i - first_pending_task_index_;
+    }
+  }
+  return num_pending_tasks();
+}
+
+void StateFlowGraph::benchmark_rebuild_graph(int num_tasks_per_round) {
+  if (num_tasks_per_round > 0) {
+    // Incremental optimization: repeatedly append |num_tasks_per_round| tasks
+    // (taken cyclically from the current pending tasks) and optimize. The
+    // cost per round should stay flat as the graph grows.
+    std::vector<TaskLaunchRecord> templates;
+    for (auto *node : get_pending_tasks()) {
+      templates.push_back(node->rec);
+    }
+    TI_ASSERT(!templates.empty());
+    mark_nodes_as_optimized();
+    unsort_node_edges();
+    for (int k = 0; k < 100; k++) {
+      std::vector<TaskLaunchRecord> records;
+      for (int i = 0; i < num_tasks_per_round; i++) {
+        records.push_back(
+            templates[(k * num_tasks_per_round + i) % templates.size()]);
+      }
+      auto t = Time::get_time();
+      insert_tasks(records, /*filter_listgen=*/false);
+      reid_nodes();
+      reid_pending_nodes();
+      sort_node_edges();
+      while (fuse())
+        ;
+      while (optimize_dead_store())
+        ;
+      mark_nodes_as_optimized();
+      unsort_node_edges();
+      auto round_t = Time::get_time() - t;
+      TI_INFO(
+          "round {}: pending nodes = {} round time {:.4f} ms; per inserted "
+          "node {:.4f} us",
+          k, num_pending_tasks(), round_t * 1e3,
+          1e6 * round_t / num_tasks_per_round);
+    }
+    return;
+  }
   double total_time = 0;
   for (int k = 0; k < 100000; k++) {
     auto t = Time::get_time();
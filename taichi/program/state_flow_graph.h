@@ -170,6 +170,11 @@ class StateFlowGraph {
     // For executed tasks (including the initial node), pending_node_id is -1.
     int pending_node_id{0};
 
+    // Whether the node was inserted or affected by a modification since the
+    // last optimization round. Optimization passes only look for
+    // opportunities involving dirty nodes, see mark_nodes_as_optimized().
+    bool dirty{true};
+
     // Performance hits
     // * std::unordered_multimap: Slow on clang + libc++, see #1855
     // * std::unordered_map<., std::unordered_set<.>>: slow due to frequent
@@ -279,6 +284,17 @@ class StateFlowGraph {
 
   void delete_nodes(const std::unordered_set<int> &indices_to_delete);
 
+  // Marks |node| and its neighbors as dirty, after its task meta changed.
+  void mark_as_modified(Node *node);
+
+  // Called after a full optimization round. Until then, nodes stay dirty
+  // across rebuild_graph().
+  void mark_nodes_as_optimized();
+
+  // Reverts the edges of all nodes to their unsorted state, so that new tasks
+  // can be inserted after an optimization round.
+  void unsort_node_edges();
+
   void reid_nodes();
 
   void reid_pending_nodes();
@@ -307,10 +323,16 @@ class StateFlowGraph {
     return nodes_.size() - first_pending_task_index_;
   }
 
+  // Returns the index in get_pending_tasks() of the first dirty node, or
+  // num_pending_tasks() if there is none.
+  int first_dirty_pending_task() const;
+
   // Recursively mark as dirty the list state of "snode" and all its children
   void mark_list_as_dirty(SNode *snode);
 
-  void benchmark_rebuild_graph();
+  // Times rebuild_graph(), as well as optimization rounds triggered by
+  // inserting |num_tasks_per_round| copies of the pending tasks.
+  void benchmark_rebuild_graph(int num_tasks_per_round = 0);
 
   AsyncState get_async_state(SNode *snode, AsyncState::Type type);
 
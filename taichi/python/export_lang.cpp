@@ -15,6 +15,7 @@
 #include "taichi/ir/statements.h"
 #include "taichi/program/extension.h"
 #include "taichi/program/async_engine.h"
+#include "taichi/program/async_readback.h"
 #include "taichi/program/snode_expr_utils.h"
 #include "taichi/program/snode_rw_accessors_bank.h"
 #include "taichi/program/ndarray.h"
@@ -27,12 +28,18 @@
 #include "taichi/util/action_recorder.h"
 #include "taichi/system/timeline.h"
 #include "taichi/python/snode_registry.h"
+#include "taichi/program/iterative_solver.h"
 #include "taichi/program/sparse_matrix.h"
 #include "taichi/program/sparse_solver.h"
 #include "taichi/ir/mesh.h"
+#include "taichi/ir/mesh_patcher.h"
 
 #include "taichi/program/kernel_profiler.h"
 
+#ifdef TI_WITH_LLVM
+#include "taichi/backends/cpu/aot_module_loader.h"
+#endif
+
 #if defined(TI_WITH_CUDA)
 #include "taichi/backends/cuda/cuda_context.h"
 #endif
@@ -74,6 +81,59 @@ NdarrayRwAccessorsBank::Accessors get_ndarray_rw_accessors(Ndarray *ndarray) {
 TLANG_NAMESPACE_END
 
 TI_NAMESPACE_BEGIN
+#ifdef TI_WITH_LLVM
+// Fills a context of a CPU AOT module with the scalar arguments |args| of
+// |kernel|.
+RuntimeContext make_aot_context(const cpu::AotModuleLoader &loader,
+                                const cpu::AotCompiledKernel &kernel,
+                                const py::args &args) {
+  TI_ERROR_IF(args.size() != kernel.args.size(),
+              "AOT: kernel {} takes {} arguments, got {}", kernel.identifier,
+              kernel.args.size(), args.size());
+  auto ctx = loader.make_context();
+  for (int i = 0; i < (int)kernel.args.size(); i++) {
+    const auto &arg = kernel.args[i];
+    TI_ERROR_IF(arg.is_external_array,
+                "AOT: external array arguments are not supported here");
+    if (arg.dtype_name == "f32") {
+      ctx.set_arg(i, args[i].cast<float32>());
+    } else if (arg.dtype_name == "f64") {
+      ctx.set_arg(i, args[i].cast<float64>());
+    } else if (arg.dtype_name == "i32") {
+      ctx.set_arg(i, args[i].cast<int32>());
+    } else if (arg.dtype_name == "i64") {
+      ctx.set_arg(i, args[i].cast<int64>());
+    } else if (arg.dtype_name == "u32") {
+      ctx.set_arg(i, args[i].cast<uint32>());
+    } else if (arg.dtype_name == "u64") {
+      ctx.set_arg(i, args[i].cast<uint64>());
+    } else {
+      TI_ERROR("AOT: unsupported argument type {}", arg.dtype_name);
+    }
+  }
+  return ctx;
+}
+
+// Returns the return value of the last launched |kernel|, if it has one.
+py::object get_aot_ret(const cpu::AotModuleLoader &loader,
+                       const cpu::AotCompiledKernel &kernel) {
+  if (kernel.ret_dtype_names.empty()) {
+    return py::none();
+  }
+  const auto &dtype_name = kernel.ret_dtype_names[0];
+  if (dtype_name == "f32") {
+    return py::cast(loader.get_ret<float32>(0));
+  } else if (dtype_name == "f64") {
+    return py::cast(loader.get_ret<float64>(0));
+  } else if (dtype_name == "i32") {
+    return py::cast(loader.get_ret<int32>(0));
+  } else if (dtype_name == "i64") {
+    return py::cast(loader.get_ret<int64>(0));
+  }
+  TI_ERROR("AOT: unsupported return type {}", dtype_name);
+}
+#endif
+
 void export_lang(py::module &m) {
   using namespace taichi::lang;
 
@@ -164,6 +224,7 @@ void export_lang(py::module &m) {
       .def_readwrite("max_block_dim", &CompileConfig::max_block_dim)
       .def_readwrite("cpu_max_num_threads", &CompileConfig::cpu_max_num_threads)
       .def_readwrite("random_seed", &CompileConfig::random_seed)
+      .def_readwrite("random_generator", &CompileConfig::random_generator)
       .def_readwrite("verbose_kernel_launches",
                      &CompileConfig::verbose_kernel_launches)
       .def_readwrite("verbose", &CompileConfig::verbose)
@@ -202,6 +263,7 @@ void export_lang(py::module &m) {
       .def_readwrite("async_opt_intermediate_file",
                      &CompileConfig::async_opt_intermediate_file)
       .def_readwrite("async_flush_every", &CompileConfig::async_flush_every)
+      .def_readwrite("async_opt_every", &CompileConfig::async_opt_every)
       .def_readwrite("async_max_fuse_per_task",
                      &CompileConfig::async_max_fuse_per_task)
       .def_readwrite("quant_opt_store_fusion",
@@ -290,9 +352,11 @@ void export_lang(py::module &m) {
       .def("get_snode_num_dynamically_allocated",
            &Program::get_snode_num_dynamically_allocated)
       .def("benchmark_rebuild_graph",
-           [](Program *program) {
-             program->async_engine->sfg->benchmark_rebuild_graph();
-           })
+           [](Program *program, int num_tasks_per_round) {
+             program->async_engine->sfg->benchmark_rebuild_graph(
+                 num_tasks_per_round);
+           },
+           py::arg("num_tasks_per_round") = 0)
       .def("synchronize", &Program::synchronize)
       .def("async_flush", &Program::async_flush)
       .def("materialize_runtime", &Program::materialize_runtime)
@@ -307,6 +371,50 @@ void export_lang(py::module &m) {
       .def("add_kernel_template", &AotModuleBuilder::add_kernel_template)
       .def("dump", &AotModuleBuilder::dump);
 
+#ifdef TI_WITH_LLVM
+  py::class_<cpu::AotModuleLoader>(m, "AotModuleLoaderCpu")
+      .def(py::init<const std::string &, const std::string &>())
+      .def("launch",
+           [](cpu::AotModuleLoader *loader, const std::string &identifier,
+              py::args args) {
+             const auto &kernel = loader->get_kernel(identifier);
+             auto ctx = make_aot_context(*loader, kernel, args);
+             loader->launch(identifier, &ctx);
+             loader->check_runtime_error();
+             return get_aot_ret(*loader, kernel);
+           })
+      .def("launch_tmpl",
+           [](cpu::AotModuleLoader *loader, const std::string &identifier,
+              const std::string &key, py::args args) {
+             const auto &kernel = loader->get_kernel_tmpl(identifier, key);
+             auto ctx = make_aot_context(*loader, kernel, args);
+             loader->launch_tmpl(identifier, key, &ctx);
+             loader->check_runtime_error();
+             return get_aot_ret(*loader, kernel);
+           })
+      .def("get_field_value",
+           [](cpu::AotModuleLoader *loader, const std::string &identifier,
+              int i) -> float64 {
+             std::string dtype_name;
+             for (const auto &f : loader->aot_data().fields) {
+               if (f.field_name == identifier) {
+                 dtype_name = f.dtype_name;
+               }
+             }
+             auto *ptr = loader->get_field_ptr(identifier, i);
+             if (dtype_name == "f32") {
+               return *(float32 *)ptr;
+             } else if (dtype_name == "f64") {
+               return *(float64 *)ptr;
+             } else if (dtype_name == "i32") {
+               return *(int32 *)ptr;
+             } else if (dtype_name == "i64") {
+               return *(int64 *)ptr;
+             }
+             TI_NOT_IMPLEMENTED;
+           });
+#endif
+
   m.def("get_current_program", get_current_program,
         py::return_value_policy::reference);
 
@@ -335,6 +443,7 @@ void export_lang(py::module &m) {
                                const std::vector<int> &, bool))(&SNode::hash),
            py::return_value_policy::reference)
       .def("dynamic", &SNode::dynamic, py::return_value_policy::reference)
+      .def("morton", &SNode::morton, py::return_value_policy::reference)
       .def("bitmasked",
            (SNode & (SNode::*)(const std::vector<Axis> &,
                                const std::vector<int> &,
@@ -435,6 +544,17 @@ void export_lang(py::module &m) {
       .def_readonly("dtype", &Ndarray::dtype)
       .def_readonly("shape", &Ndarray::shape);
 
+  py::class_<AsyncReadback>(m, "AsyncReadback")
+      .def(py::init<Arch, std::size_t, int>())
+      .def("enqueue", &AsyncReadback::enqueue)
+      .def("wait",
+           [](AsyncReadback *readback, int i) {
+             py::gil_scoped_release release;
+             return readback->wait(i);
+           })
+      .def("size", &AsyncReadback::size)
+      .def("num_buffers", &AsyncReadback::num_buffers);
+
   py::class_<Kernel>(m, "Kernel")
       .def("get_ret_int", &Kernel::get_ret_int)
       .def("get_ret_float", &Kernel::get_ret_float)
@@ -974,6 +1094,7 @@ void export_lang(py::module &m) {
       .value("block_local", SNodeAccessFlag::block_local)
       .value("read_only", SNodeAccessFlag::read_only)
       .value("mesh_local", SNodeAccessFlag::mesh_local)
+      .value("f64_accumulator", SNodeAccessFlag::f64_accumulator)
       .export_values();
 
   m.def("insert_snode_access_flag", insert_snode_access_flag);
@@ -1114,48 +1235,97 @@ void export_lang(py::module &m) {
 
   py::class_<SparseMatrixBuilder>(m, "SparseMatrixBuilder")
       .def("print_triplets", &SparseMatrixBuilder::print_triplets)
-      .def("build", &SparseMatrixBuilder::build)
+      .def("build", py::overload_cast<DataType, DataType>(
+                        &SparseMatrixBuilder::build))
+      .def("build_into", &SparseMatrixBuilder::build_into)
+      .def("get_data_type", &SparseMatrixBuilder::get_data_type)
+      .def("get_index_type", &SparseMatrixBuilder::get_index_type)
       .def("get_addr", [](SparseMatrixBuilder *mat) { return uint64(mat); });
 
   m.def("create_sparse_matrix_builder",
-        [](int n, int m, uint64 max_num_entries) {
+        [](int n, int m, uint64 max_num_entries, DataType dtype,
+           DataType index_dtype) {
           TI_ERROR_IF(!arch_is_cpu(get_current_program().config.arch),
                       "SparseMatrix only supports CPU for now.");
-          return SparseMatrixBuilder(n, m, max_num_entries);
+          return SparseMatrixBuilder(n, m, max_num_entries, dtype,
+                                     index_dtype);
         });
 
   py::class_<SparseMatrix>(m, "SparseMatrix")
       .def("to_string", &SparseMatrix::to_string)
-      .def(py::self + py::self, py::return_value_policy::reference_internal)
-      .def(py::self - py::self, py::return_value_policy::reference_internal)
-      .def(float() * py::self, py::return_value_policy::reference_internal)
-      .def(py::self * float(), py::return_value_policy::reference_internal)
-      .def(py::self * py::self, py::return_value_policy::reference_internal)
-      .def("matmul", &SparseMatrix::matmul,
-           py::return_value_policy::reference_internal)
-      .def("mat_vec_mul", &SparseMatrix::mat_vec_mul)
-      .def("transpose", &SparseMatrix::transpose,
-           py::return_value_policy::reference_internal)
+      .def("__add__", &SparseMatrix::add)
+      .def("__sub__", &SparseMatrix::sub)
+      .def("__mul__", &SparseMatrix::scale)
+      .def("__rmul__", &SparseMatrix::scale)
+      .def("__mul__", &SparseMatrix::mul)
+      .def("matmul", &SparseMatrix::matmul)
+      .def("mat_vec_mul",
+           [](SparseMatrix *sm, const Eigen::Ref<const Eigen::VectorXf> &b) {
+             return sm->mat_vec_mul(b);
+           })
+      .def("mat_vec_mul",
+           [](SparseMatrix *sm, const Eigen::Ref<const Eigen::VectorXd> &b) {
+             return sm->mat_vec_mul(b);
+           })
+      .def("transpose", &SparseMatrix::transpose)
       .def("get_element", &SparseMatrix::get_element)
       .def("set_element", &SparseMatrix::set_element)
       .def("num_rows", &SparseMatrix::num_rows)
-      .def("num_cols", &SparseMatrix::num_cols);
+      .def("num_cols", &SparseMatrix::num_cols)
+      .def("get_data_type", &SparseMatrix::get_data_type)
+      .def("get_index_type", &SparseMatrix::get_index_type);
 
-  m.def("create_sparse_matrix", [](int n, int m) {
-    TI_ERROR_IF(!arch_is_cpu(get_current_program().config.arch),
-                "SparseMatrix only supports CPU for now.");
-    return SparseMatrix(n, m);
-  });
+  m.def("create_sparse_matrix",
+        [](int n, int m, DataType dtype, DataType index_dtype) {
+          TI_ERROR_IF(!arch_is_cpu(get_current_program().config.arch),
+                      "SparseMatrix only supports CPU for now.");
+          return make_sparse_matrix(n, m, dtype, index_dtype);
+        });
 
   py::class_<SparseSolver>(m, "SparseSolver")
       .def("compute", &SparseSolver::compute)
       .def("analyze_pattern", &SparseSolver::analyze_pattern)
       .def("factorize", &SparseSolver::factorize)
-      .def("solve", &SparseSolver::solve)
-      .def("info", &SparseSolver::info);
+      .def("solve",
+           [](SparseSolver *s, const Eigen::Ref<const Eigen::VectorXf> &b) {
+             return s->solve(b);
+           })
+      .def("solve",
+           [](SparseSolver *s, const Eigen::Ref<const Eigen::VectorXd> &b) {
+             return s->solve(b);
+           })
+      .def("solve_in_place",
+           [](SparseSolver *solver, uint64 b, uint64 x) {
+             solver->solve_in_place((const void *)b, (void *)x);
+           })
+      .def("info", &SparseSolver::info)
+      .def("num_analyses", &SparseSolver::num_analyses);
 
   m.def("make_sparse_solver", &make_sparse_solver);
 
+  py::class_<IterativeSolver>(m, "IterativeSolver")
+      .def("compute", &IterativeSolver::compute)
+      .def("set_operator",
+           [](IterativeSolver *solver, int n, py::function matvec,
+              uint64 diagonal) {
+             // |matvec| is called with the addresses of x and y
+             solver->set_operator(
+                 n,
+                 [matvec](const void *x, void *y) {
+                   matvec((uint64)x, (uint64)y);
+                 },
+                 (const void *)diagonal);
+           })
+      .def("solve",
+           [](IterativeSolver *solver, uint64 b, uint64 x) {
+             return solver->solve((const void *)b, (void *)x);
+           })
+      .def("num_iterations", &IterativeSolver::num_iterations)
+      .def("residual", &IterativeSolver::residual)
+      .def("info", &IterativeSolver::info);
+
+  m.def("make_iterative_solver", &make_iterative_solver);
+
   // Mesh Class
   // Mesh related.
   py::enum_<mesh::MeshTopology>(m, "MeshTopology", py::arithmetic())
@@ -1263,6 +1433,49 @@ void export_lang(py::module &m) {
           mesh_ptr.ptr->relations.insert(
               std::pair(type, mesh::MeshLocalRelation(value, offset)));
         });
+
+  // Returns the patches in the layout of the mesh metadata files loaded by
+  // ti.Mesh.load_meta().
+  m.def("build_mesh_patches",
+        [](mesh::MeshTopology topology, int num_vertices,
+           py::array_t<int, py::array::c_style | py::array::forcecast> indices,
+           const std::vector<mesh::MeshRelationType> &relations,
+           int patch_size, int num_threads) {
+          auto patches = mesh::build_mesh_patches(
+              topology, num_vertices,
+              std::vector<int>(indices.data(), indices.data() + indices.size()),
+              relations, patch_size, num_threads);
+          auto to_array = [](const std::vector<int> &v) {
+            return py::array_t<int>(v.size(), v.data());
+          };
+          py::list elements;
+          for (const auto &[type, e] : patches.elements) {
+            py::dict element;
+            element["order"] = mesh::element_order(type);
+            element["num"] = e.num;
+            element["max_num_per_patch"] = e.max_num_per_patch;
+            element["owned_offsets"] = to_array(e.owned_offsets);
+            element["total_offsets"] = to_array(e.total_offsets);
+            element["l2g_mapping"] = to_array(e.l2g);
+            element["l2r_mapping"] = to_array(e.l2r);
+            element["g2r_mapping"] = to_array(e.g2r);
+            elements.append(element);
+          }
+          py::list relation_list;
+          for (const auto &[type, r] : patches.relations) {
+            py::dict relation;
+            relation["from_order"] = mesh::from_end_element_order(type);
+            relation["to_order"] = mesh::to_end_element_order(type);
+            relation["value"] = to_array(r.value);
+            relation["offset"] = to_array(r.offset);
+            relation_list.append(relation);
+          }
+          py::dict data;
+          data["num_patches"] = patches.num_patches;
+          data["elements"] = elements;
+          data["relations"] = relation_list;
+          return data;
+        });
 }
 
 TI_NAMESPACE_END
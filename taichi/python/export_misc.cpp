@@ -150,6 +150,8 @@ void export_misc(py::module &m) {
   });
   m.def("print_profile_info",
         [&]() { Profiling::get_instance().print_profile_info(); });
+  m.def("print_profile_summary",
+        [&]() { Profiling::get_instance().print_profile_summary(); });
   m.def("clear_profile_info",
         [&]() { Profiling::get_instance().clear_profile_info(); });
   m.def("start_memory_monitoring", start_memory_monitoring);
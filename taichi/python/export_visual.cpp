@@ -24,8 +24,8 @@ void export_visual(py::module &m) {
       .value("Move", Type::move)
       .value("Press", Type::press)
       .value("Release", Type::release);
-  py::class_<GUI>(m, "GUI")
-      .def(py::init<std::string, Vector2i, bool, bool, bool, uintptr_t>())
+  py::class_<GUI> gui(m, "GUI");
+  gui.def(py::init<std::string, Vector2i, bool, bool, bool, uintptr_t>())
       .def_readwrite("frame_delta_limit", &GUI::frame_delta_limit)
       .def_readwrite("should_close", &GUI::should_close)
       .def("get_canvas", &GUI::get_canvas, py::return_value_policy::reference)
@@ -82,6 +82,11 @@ void export_visual(py::module &m) {
       .def("get_cursor_pos", &GUI::get_cursor_pos)
       .def_readwrite("title", &GUI::window_name)
       .def("update", &GUI::update);
+#if defined(TI_GUI_X11)
+  gui.def("get_window_image", [&](GUI *gui, std::size_t ptr) {
+    gui->get_window_image((uint32 *)ptr);
+  });
+#endif
   py::class_<Canvas>(m, "Canvas")
       .def("clear", static_cast<void (Canvas::*)(uint32)>(&Canvas::clear))
       .def("rect", &Canvas::rect, py::return_value_policy::reference)
@@ -29,14 +29,40 @@ i32 insert_triplet(RuntimeContext *context,
 
   int64 *num_triplets = base_ptr;
   auto data_base_ptr = *(int32 **)(base_ptr + 1);
+  auto max_num_triplets = base_ptr[2];
 
   auto triplet_id = atomic_add_i64(num_triplets, 1);
+  if (triplet_id >= max_num_triplets) {
+    // Reported when the matrix is built
+    return 0;
+  }
   data_base_ptr[triplet_id * 3] = i;
   data_base_ptr[triplet_id * 3 + 1] = j;
   data_base_ptr[triplet_id * 3 + 2] = taichi_union_cast<int32>(value);
   return 0;
 }
 
+i32 insert_triplet_f64(RuntimeContext *context,
+                       int64 base_ptr_,
+                       int i,
+                       int j,
+                       float64 value) {
+  auto base_ptr = (int64 *)base_ptr_;
+
+  int64 *num_triplets = base_ptr;
+  auto data_base_ptr = *(int32 **)(base_ptr + 1);
+  auto max_num_triplets = base_ptr[2];
+
+  auto triplet_id = atomic_add_i64(num_triplets, 1);
+  if (triplet_id >= max_num_triplets) {
+    return 0;
+  }
+  data_base_ptr[triplet_id * 4] = i;
+  data_base_ptr[triplet_id * 4 + 1] = j;
+  *(float64 *)(data_base_ptr + triplet_id * 4 + 2) = value;
+  return 0;
+}
+
 i32 test_internal_func_args(RuntimeContext *context,
                             float32 i,
                             float32 j,
@@ -528,6 +528,14 @@ struct RandState {
   i32 lock;
 };
 
+// A per-thread bump region holding the spilled entries of AD-stacks. It is
+// reset at the entry of every function that owns AD-stacks.
+struct AdStackHeap {
+  Ptr buffer;
+  u64 size;
+  u64 used;
+};
+
 void initialize_rand_state(RandState *state, u32 i) {
   state->x = 123456789 * i * 1000000007;
   state->y = 362436069;
@@ -562,6 +570,7 @@ struct LLVMRuntime {
   Ptr ambient_elements[taichi_max_num_snodes];
   Ptr temporaries;
   RandState *rand_states;
+  AdStackHeap *ad_stack_heaps;
   MemRequestQueue *mem_req_queue;
   Ptr allocate(std::size_t size);
   Ptr allocate_aligned(std::size_t size, std::size_t alignment);
@@ -928,6 +937,15 @@ void runtime_initialize(
       sizeof(RandState) * runtime->num_rand_states, taichi_page_size);
   for (int i = 0; i < runtime->num_rand_states; i++)
     initialize_rand_state(&runtime->rand_states[i], starting_rand_state + i);
+
+  // AD-stack heaps are indexed by linear_thread_idx, just like rand_states.
+  runtime->ad_stack_heaps = (AdStackHeap *)runtime->allocate_aligned(
+      sizeof(AdStackHeap) * runtime->num_rand_states, taichi_page_size);
+  for (int i = 0; i < runtime->num_rand_states; i++) {
+    runtime->ad_stack_heaps[i].buffer = nullptr;
+    runtime->ad_stack_heaps[i].size = 0;
+    runtime->ad_stack_heaps[i].used = 0;
+  }
 }
 
 void runtime_initialize_snodes(LLVMRuntime *runtime,
@@ -1676,6 +1694,81 @@ i32 rand_i32(RuntimeContext *context) {
 i64 rand_i64(RuntimeContext *context) {
   return rand_u64(context);
 }
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3", SC'11). Being counter-based, it has no state: the result only depends on
+// the counter and the key, so that no memory is shared between threads and the
+// random numbers do not depend on the scheduling. Returns the first two words
+// of the output block.
+u64 philox4x32(u32 c0, u32 c1, u32 c2, u32 c3, u32 k0, u32 k1) {
+  for (int round = 0; round < 10; round++) {
+    const u64 p0 = (u64)0xD2511F53u * c0;
+    const u64 p1 = (u64)0xCD9E8D57u * c2;
+    c0 = (u32)(p1 >> 32) ^ c1 ^ k0;
+    c2 = (u32)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (u32)p1;
+    c3 = (u32)p0;
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+  return ((u64)c1 << 32) | c0;
+}
+
+// The counter is (stream, call, task), where |stream| identifies the loop
+// iteration, |call| counts the random numbers drawn so far in the iteration,
+// and |task| is the index of the offloaded task in the kernel. The key is the
+// random seed and the index of the kernel launch.
+u64 philox_rand_u64(RuntimeContext *context,
+                    u64 stream,
+                    u32 call,
+                    u32 task,
+                    u32 seed) {
+  return philox4x32((u32)stream, (u32)(stream >> 32), call, task, seed,
+                    context->rand_epoch);
+}
+
+u32 philox_rand_u32(RuntimeContext *context,
+                    u64 stream,
+                    u32 call,
+                    u32 task,
+                    u32 seed) {
+  return (u32)philox_rand_u64(context, stream, call, task, seed);
+}
+
+f32 philox_rand_f32(RuntimeContext *context,
+                    u64 stream,
+                    u32 call,
+                    u32 task,
+                    u32 seed) {
+  // 24 bits, so that the result is never rounded up to 1
+  return (philox_rand_u32(context, stream, call, task, seed) >> 8) *
+         (1.0f / 16777216.0f);
+}
+
+f64 philox_rand_f64(RuntimeContext *context,
+                    u64 stream,
+                    u32 call,
+                    u32 task,
+                    u32 seed) {
+  return (philox_rand_u64(context, stream, call, task, seed) >> 11) *
+         (1.0 / 9007199254740992.0);
+}
+
+i32 philox_rand_i32(RuntimeContext *context,
+                    u64 stream,
+                    u32 call,
+                    u32 task,
+                    u32 seed) {
+  return philox_rand_u32(context, stream, call, task, seed);
+}
+
+i64 philox_rand_i64(RuntimeContext *context,
+                    u64 stream,
+                    u32 call,
+                    u32 task,
+                    u32 seed) {
+  return philox_rand_u64(context, stream, call, task, seed);
+}
 };
 
 struct printf_helper {
@@ -1722,29 +1815,101 @@ void taichi_printf(LLVMRuntime *runtime, const char *format, Args &&... args) {
 
 extern "C" {  // local stack operations
 
-Ptr stack_top_primal(Ptr stack, std::size_t element_size) {
-  auto n = *(u64 *)stack;
-  return stack + sizeof(u64) + (n - 1) * 2 * element_size;
+// An AD-stack is an AdStackHeader followed by |max_num_inline_elements|
+// inline (primal, adjoint) entries. Entries pushed beyond the inline segment
+// spill into the per-thread AdStackHeap, so an underestimated stack size costs
+// performance instead of corrupting the neighbouring memory.
+struct AdStackHeader {
+  u64 n;
+  Ptr spilled;
+  u64 spilled_capacity;
+};
+
+static_assert(sizeof(AdStackHeader) == taichi_ad_stack_header_size, "");
+
+void ad_stack_heap_reset(RuntimeContext *context) {
+  context->runtime->ad_stack_heaps[linear_thread_idx(context)].used = 0;
 }
 
-Ptr stack_top_adjoint(Ptr stack, std::size_t element_size) {
-  return stack_top_primal(stack, element_size) + element_size;
+Ptr ad_stack_heap_allocate(RuntimeContext *context, std::size_t size) {
+  auto runtime = context->runtime;
+  auto &heap = runtime->ad_stack_heaps[linear_thread_idx(context)];
+  size = taichi::iroundup(size, (std::size_t)16);
+  if (heap.used + size > heap.size) {
+    // The exhausted region is abandoned rather than freed: stacks that have
+    // spilled into it in the current task body still point there. Since the
+    // region grows geometrically, this wastes at most as much memory as the
+    // region in use.
+    auto new_size = max_u64(max_u64(heap.size * 2, size),
+                            taichi_ad_stack_heap_min_size);
+    heap.buffer = runtime->request_allocate_aligned(new_size, 16);
+    heap.size = new_size;
+    heap.used = 0;
+  }
+  auto ret = heap.buffer + heap.used;
+  heap.used += size;
+  return ret;
 }
 
-void stack_init(Ptr stack) {
-  *(u64 *)stack = 0;
+Ptr stack_top_primal(Ptr stack,
+                     std::size_t max_num_inline_elements,
+                     std::size_t element_size) {
+  auto header = (AdStackHeader *)stack;
+  auto i = header->n - 1;
+  if (i < max_num_inline_elements) {
+    return stack + sizeof(AdStackHeader) + i * 2 * element_size;
+  }
+  return header->spilled + (i - max_num_inline_elements) * 2 * element_size;
 }
 
-void stack_pop(Ptr stack) {
-  auto &n = *(u64 *)stack;
-  n--;
+Ptr stack_top_adjoint(Ptr stack,
+                      std::size_t max_num_inline_elements,
+                      std::size_t element_size) {
+  return stack_top_primal(stack, max_num_inline_elements, element_size) +
+         element_size;
+}
+
+// Called once per stack at the entry of the function owning it, after
+// ad_stack_heap_reset. The spilled segment then survives re-initializations
+// of the stack within the same invocation, e.g. in a loop body.
+void stack_init_spill(Ptr stack) {
+  auto header = (AdStackHeader *)stack;
+  header->spilled = nullptr;
+  header->spilled_capacity = 0;
+}
+
+void stack_init(Ptr stack) {
+  ((AdStackHeader *)stack)->n = 0;
 }
 
-void stack_push(Ptr stack, size_t max_num_elements, std::size_t element_size) {
-  u64 &n = *(u64 *)stack;
-  n += 1;
-  // TODO: assert n <= max_elements
-  std::memset(stack_top_primal(stack, element_size), 0, element_size * 2);
+void stack_pop(Ptr stack) {
+  auto header = (AdStackHeader *)stack;
+  header->n--;
+}
+
+void stack_push(RuntimeContext *context,
+                Ptr stack,
+                std::size_t max_num_inline_elements,
+                std::size_t element_size) {
+  auto header = (AdStackHeader *)stack;
+  header->n += 1;
+  if (header->n > max_num_inline_elements) {
+    auto num_spilled = header->n - max_num_inline_elements;
+    if (num_spilled > header->spilled_capacity) {
+      auto new_capacity = max_u64(header->spilled_capacity * 2,
+                                  max_u64(max_num_inline_elements, 1));
+      auto new_spilled =
+          ad_stack_heap_allocate(context, new_capacity * 2 * element_size);
+      if (header->spilled != nullptr) {
+        std::memcpy(new_spilled, header->spilled,
+                    header->spilled_capacity * 2 * element_size);
+      }
+      header->spilled = new_spilled;
+      header->spilled_capacity = new_capacity;
+    }
+  }
+  std::memset(stack_top_primal(stack, max_num_inline_elements, element_size),
+              0, element_size * 2);
 }
 
 #include "internal_functions.h"
@@ -11,6 +11,35 @@
 namespace taichi {
 namespace lang {
 
+namespace {
+
+// The LLVM counterpart of generate_morton_index() in transforms/utils.cpp.
+llvm::Value *decode_morton_index(llvm::IRBuilder<> *builder,
+                                 llvm::Value *l,
+                                 const std::vector<int> &num_bits,
+                                 int morton_bits,
+                                 int k) {
+  const int dim = (int)num_bits.size();
+  int high_begin = dim * morton_bits;
+  for (int i = dim - 1; i > k; i--) {
+    high_begin += num_bits[i] - morton_bits;
+  }
+  auto high = builder->CreateAnd(builder->CreateLShr(l, high_begin),
+                                 bit::pot_mask(num_bits[k] - morton_bits));
+  high = builder->CreateShl(high, morton_bits);
+  auto compact = builder->CreateAnd(builder->CreateLShr(l, dim - 1 - k),
+                                    bit::morton_mask(dim, morton_bits, 1));
+  for (int stride = 1; stride < morton_bits; stride *= 2) {
+    compact = builder->CreateOr(
+        compact, builder->CreateLShr(compact, stride * (dim - 1)));
+    compact = builder->CreateAnd(
+        compact, bit::morton_mask(dim, morton_bits, stride * 2));
+  }
+  return builder->CreateOr(high, compact);
+}
+
+}  // namespace
+
 StructCompilerLLVM::StructCompilerLLVM(Arch arch,
                                        const CompileConfig *config,
                                        TaichiLLVMContext *tlctx,
@@ -59,7 +88,8 @@ void StructCompilerLLVM::generate_types(SNode &snode) {
 
   llvm::Type *body_type = nullptr, *aux_type = nullptr;
   if (type == SNodeType::dense || type == SNodeType::bitmasked) {
-    TI_ASSERT(snode._morton == false);
+    TI_ERROR_IF(snode._morton && config_->packed,
+                "Morton-ordered SNodes are not supported in packed mode.");
     body_type = llvm::ArrayType::get(ch_type, snode.max_num_elements());
     if (type == SNodeType::bitmasked) {
       aux_type = llvm::ArrayType::get(llvm::Type::getInt32Ty(*llvm_ctx_),
@@ -106,11 +136,43 @@ void StructCompilerLLVM::generate_types(SNode &snode) {
     DataType container_primitive_type(snode.physical_type);
     body_type = tlctx_->get_data_type(container_primitive_type);
   } else if (type == SNodeType::bit_array) {
-    // A bit array SNode should have only one child
-    TI_ASSERT(snode.ch.size() == 1);
-    auto &ch = snode.ch[0];
+    // A bit array SNode should have only one child, besides the exponent
+    // shared by its elements if they are custom floats
+    SNode *ch = nullptr;
+    SNode *exp_snode = nullptr;
+    for (auto &c : snode.ch) {
+      if (!c->exponent_users.empty()) {
+        exp_snode = c.get();
+      } else {
+        TI_ERROR_IF(ch != nullptr, "A bit_array can only place one field.");
+        ch = c.get();
+      }
+    }
+    TI_ASSERT(ch != nullptr);
     Type *ch_type = ch->dt;
-    ch->dt->as<CustomIntType>()->set_physical_type(snode.physical_type);
+    CustomIntType *element_cit = nullptr;
+    if (auto cft = ch_type->cast<CustomFloatType>()) {
+      TI_ERROR_IF(cft->get_exponent_type() && !ch->owns_shared_exponent,
+                  "Custom floats with exponents in a bit_array must be "
+                  "placed with shared_exponent=True.");
+      element_cit = cft->get_digits_type()->as<CustomIntType>();
+    } else {
+      element_cit = ch_type->as<CustomIntType>();
+    }
+    element_cit->set_physical_type(snode.physical_type);
+    int total_bits =
+        element_cit->get_num_bits() * snode.num_cells_per_container;
+    if (exp_snode) {
+      // The shared exponent follows the digits of all the elements
+      auto exp_cit = exp_snode->dt->as<CustomIntType>();
+      exp_cit->set_physical_type(snode.physical_type);
+      exp_snode->bit_offset = total_bits;
+      total_bits += exp_cit->get_num_bits();
+    }
+    auto bit_array_size = data_type_bits(snode.physical_type);
+    TI_ERROR_IF(total_bits > bit_array_size,
+                "Bit array overflows: {} bits used out of {}.", total_bits,
+                bit_array_size);
     if (!arch_is_cpu(arch_)) {
       TI_ERROR_IF(data_type_bits(snode.physical_type) <= 16,
                   "bit_array physical type must be at least 32 bits on "
@@ -210,9 +272,20 @@ void StructCompilerLLVM::generate_refine_coordinates(SNode *snode) {
            tlctx_->get_constant(i), added);
     }
   } else {
+    const int morton_bits = snode->morton_num_bits();
+    std::vector<int> morton_num_bits;
+    for (int i = 0; i < taichi_max_num_indices; i++) {
+      if (snode->extractors[i].active) {
+        morton_num_bits.push_back(snode->extractors[i].num_bits);
+      }
+    }
+    int morton_axis = 0;
     for (int i = 0; i < taichi_max_num_indices; i++) {
       auto addition = tlctx_->get_constant(0);
-      if (snode->extractors[i].num_bits) {
+      if (morton_bits > 0 && snode->extractors[i].active) {
+        addition = decode_morton_index(&builder, l, morton_num_bits,
+                                       morton_bits, morton_axis++);
+      } else if (snode->extractors[i].num_bits) {
         auto mask = ((1 << snode->extractors[i].num_bits) - 1);
         addition = builder.CreateAnd(
             builder.CreateAShr(l, snode->extractors[i].acc_offset), mask);
@@ -1,5 +1,8 @@
 #include "taichi/system/profiler.h"
 
+#include <algorithm>
+#include <functional>
+
 TI_NAMESPACE_BEGIN
 
 // A profiler's records form a tree structure
@@ -270,6 +273,55 @@ void Profiling::print_profile_info() {
   }
 }
 
+void Profiling::print_profile_summary() {
+  std::lock_guard<std::mutex> _(mut);
+  struct Summary {
+    float64 total_time{0};
+    int64 num_samples{0};
+  };
+  std::unordered_map<std::string, Summary> summaries;
+  std::vector<std::string> path;
+  float64 total_time = 0;
+  std::function<void(const ProfilerRecordNode *)> collect =
+      [&](const ProfilerRecordNode *node) {
+        // Skip recursive scopes, whose time is already accounted for by the
+        // outermost one.
+        bool recursive =
+            std::find(path.begin(), path.end(), node->name) != path.end();
+        if (!recursive) {
+          auto &summary = summaries[node->name];
+          summary.total_time += node->total_time;
+          summary.num_samples += node->num_samples;
+        }
+        path.push_back(node->name);
+        for (auto &ch : node->childs) {
+          collect(ch.get());
+        }
+        path.pop_back();
+      };
+  for (auto p : profilers) {
+    for (auto &ch : p.second->root->childs) {
+      total_time += ch->total_time;
+      collect(ch.get());
+    }
+  }
+
+  std::vector<std::pair<std::string, Summary>> sorted(summaries.begin(),
+                                                      summaries.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+    return a.second.total_time > b.second.total_time;
+  });
+  fmt::print(fg(fmt::color::cyan), std::string(80, '>') + "\n");
+  fmt::print("{:>12} {:>7} {:>10}  {}\n", "total [ms]", "%", "samples",
+             "scope");
+  for (auto &kv : sorted) {
+    fmt::print("{:12.3f} {:6.2f}% {:10}  {}\n", kv.second.total_time * 1e3,
+               kv.second.total_time * 100.0 / std::max(total_time, 1e-9),
+               kv.second.num_samples, kv.first);
+  }
+  fmt::print(fg(fmt::color::cyan), std::string(80, '>') + "\n");
+}
+
 void Profiling::clear_profile_info() {
   std::lock_guard<std::mutex> _(mut);
   for (auto p : profilers) {
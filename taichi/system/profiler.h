@@ -44,6 +44,9 @@ class ScopedProfiler {
 class Profiling {
  public:
   void print_profile_info();
+  // Prints the total time of each scope name over all the call sites and
+  // threads, e.g. per compilation pass, sorted by the total time.
+  void print_profile_summary();
   void clear_profile_info();
   ProfilerRecords *get_this_thread_profiler();
   static Profiling &get_instance();
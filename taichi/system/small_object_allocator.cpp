@@ -0,0 +1,196 @@
+#include "taichi/system/small_object_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+TI_NAMESPACE_BEGIN
+
+namespace {
+
+constexpr std::size_t kGranularity = 16;
+constexpr std::size_t kMaxSize = 1024;
+constexpr std::size_t kNumSizeClasses = kMaxSize / kGranularity;
+constexpr std::size_t kChunkSize = 256 * 1024;
+// Free objects a thread keeps per size class before handing half of them over
+// to the shared free lists, e.g. on a thread that frees what others allocate
+constexpr std::size_t kMaxLocalFreeBytes = 64 * 1024;
+
+struct FreeNode {
+  FreeNode *next;
+};
+
+// Trivially destructible, so that it stays usable while threads exit.
+struct FreeLists {
+  FreeNode *heads[kNumSizeClasses];
+  std::size_t counts[kNumSizeClasses];
+  char *chunk_head;
+  char *chunk_tail;
+};
+
+std::size_t get_size_class(std::size_t size) {
+  return (size + kGranularity - 1) / kGranularity - 1;
+}
+
+// Number of free objects of size class |c| a thread keeps, and moves at once
+// from or to the shared free lists
+std::size_t local_capacity(std::size_t c) {
+  return std::max<std::size_t>(2,
+                                kMaxLocalFreeBytes / ((c + 1) * kGranularity));
+}
+
+std::atomic<std::size_t> total_chunk_bytes{0};
+
+// Free lists of the exited threads and the objects handed over by the live
+// ones, shared by all threads
+struct SharedFreeLists {
+  std::mutex mut;
+  FreeLists lists{};
+  // Allows checking for free objects without taking the lock
+  std::atomic<bool> maybe_nonempty{false};
+};
+
+SharedFreeLists &shared() {
+  // Leaked on purpose: objects may be freed during static destruction.
+  static auto *shared = new SharedFreeLists;
+  return *shared;
+}
+
+thread_local FreeLists local_lists{};
+thread_local bool thread_exited{false};
+
+void push(FreeLists &lists, std::size_t c, void *ptr) {
+  auto node = (FreeNode *)ptr;
+  node->next = lists.heads[c];
+  lists.heads[c] = node;
+  lists.counts[c]++;
+}
+
+// Moves up to |n| objects of size class |c| from |from| to |to|.
+void move_nodes(FreeLists &from, FreeLists &to, std::size_t c, std::size_t n) {
+  auto first = from.heads[c];
+  if (first == nullptr || n == 0) {
+    return;
+  }
+  auto last = first;
+  std::size_t moved = 1;
+  while (moved < n && last->next != nullptr) {
+    last = last->next;
+    moved++;
+  }
+  from.heads[c] = last->next;
+  from.counts[c] -= moved;
+  last->next = to.heads[c];
+  to.heads[c] = first;
+  to.counts[c] += moved;
+}
+
+void *allocate_from(FreeLists &lists, std::size_t c, bool steal_shared) {
+  if (lists.heads[c] == nullptr && steal_shared) {
+    auto &s = shared();
+    if (s.maybe_nonempty.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> _(s.mut);
+      move_nodes(s.lists, lists, c, local_capacity(c) / 2);
+      bool nonempty = false;
+      for (auto head : s.lists.heads) {
+        nonempty = nonempty || head != nullptr;
+      }
+      s.maybe_nonempty = nonempty;
+    }
+  }
+  if (auto node = lists.heads[c]) {
+    lists.heads[c] = node->next;
+    lists.counts[c]--;
+    return node;
+  }
+  const std::size_t size = (c + 1) * kGranularity;
+  if (lists.chunk_head + size > lists.chunk_tail) {
+    // The rest of the current chunk is abandoned.
+    lists.chunk_head = (char *)std::malloc(kChunkSize);
+    if (lists.chunk_head == nullptr) {
+      throw std::bad_alloc();
+    }
+    lists.chunk_tail = lists.chunk_head + kChunkSize;
+    total_chunk_bytes += kChunkSize;
+  }
+  auto ret = lists.chunk_head;
+  lists.chunk_head += size;
+  return ret;
+}
+
+// Hands the free lists of a thread over to the other threads when it exits.
+struct ThreadExitHandler {
+  ~ThreadExitHandler() {
+    auto &s = shared();
+    std::lock_guard<std::mutex> _(s.mut);
+    for (std::size_t c = 0; c < kNumSizeClasses; c++) {
+      move_nodes(local_lists, s.lists, c, local_lists.counts[c]);
+    }
+    s.maybe_nonempty = true;
+    thread_exited = true;
+  }
+
+  void touch() {
+  }
+};
+
+thread_local ThreadExitHandler thread_exit_handler;
+
+}  // namespace
+
+bool SmallObjectAllocator::enabled() {
+  static const bool enabled = [] {
+    auto env = std::getenv("TI_SMALL_OBJECT_ALLOCATOR");
+    return env == nullptr || std::atoi(env) != 0;
+  }();
+  return enabled;
+}
+
+void *SmallObjectAllocator::allocate(std::size_t size) {
+  if (size == 0 || size > kMaxSize || !enabled()) {
+    return ::operator new(size);
+  }
+  const auto c = get_size_class(size);
+  if (thread_exited) {
+    auto &s = shared();
+    std::lock_guard<std::mutex> _(s.mut);
+    return allocate_from(s.lists, c, /*steal_shared=*/false);
+  }
+  // Make sure the free lists are handed over when this thread exits.
+  thread_exit_handler.touch();
+  return allocate_from(local_lists, c, /*steal_shared=*/true);
+}
+
+void SmallObjectAllocator::deallocate(void *ptr, std::size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size == 0 || size > kMaxSize || !enabled()) {
+    ::operator delete(ptr);
+    return;
+  }
+  const auto c = get_size_class(size);
+  if (thread_exited) {
+    auto &s = shared();
+    std::lock_guard<std::mutex> _(s.mut);
+    push(s.lists, c, ptr);
+    s.maybe_nonempty = true;
+    return;
+  }
+  thread_exit_handler.touch();
+  push(local_lists, c, ptr);
+  if (local_lists.counts[c] > local_capacity(c)) {
+    auto &s = shared();
+    std::lock_guard<std::mutex> _(s.mut);
+    move_nodes(local_lists, s.lists, c, local_capacity(c) / 2);
+    s.maybe_nonempty = true;
+  }
+}
+
+std::size_t SmallObjectAllocator::chunk_bytes() {
+  return total_chunk_bytes;
+}
+
+TI_NAMESPACE_END
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+#include "taichi/common/core.h"
+
+TI_NAMESPACE_BEGIN
+
+// Allocates small objects (e.g. IR nodes) from per-thread free lists backed by
+// large chunks, so that building, cloning and destroying IR does not hit the
+// system allocator for every node. Freed objects are recycled for objects of
+// the same size class, possibly on another thread: a thread that has too
+// many free objects of a size class hands some of them over to a shared pool,
+// where the other threads take them from. The chunks are never returned to
+// the system.
+//
+// Set the environment variable TI_SMALL_OBJECT_ALLOCATOR=0 to fall back to
+// the system allocator, e.g. for comparison or for memory checkers.
+class SmallObjectAllocator {
+ public:
+  static void *allocate(std::size_t size);
+
+  // |size| must be the one passed to allocate().
+  static void deallocate(void *ptr, std::size_t size);
+
+  // Total size of the chunks allocated from the system so far
+  static std::size_t chunk_bytes();
+
+  static bool enabled();
+};
+
+// Inherit from this to allocate the instances with SmallObjectAllocator.
+// The class hierarchy must have a virtual destructor so that the size of the
+// most derived class is passed to operator delete.
+class SmallObject {
+ public:
+  static void *operator new(std::size_t size) {
+    return SmallObjectAllocator::allocate(size);
+  }
+
+  static void operator delete(void *ptr, std::size_t size) {
+    SmallObjectAllocator::deallocate(ptr, size);
+  }
+};
+
+TI_NAMESPACE_END
@@ -126,6 +126,21 @@ void ThreadPool::target() {
   }
 }
 
+SharedThreadPool::SharedThreadPool() {
+  grow(std::max(1, (int)std::thread::hardware_concurrency()));
+}
+
+SharedThreadPool &SharedThreadPool::get_instance() {
+  static SharedThreadPool instance;
+  return instance;
+}
+
+void SharedThreadPool::grow(int num_threads) {
+  pool_.reset();
+  num_threads_ = num_threads;
+  pool_ = std::make_unique<ThreadPool>(num_threads_);
+}
+
 ThreadPool::~ThreadPool() {
   {
     std::lock_guard<std::mutex> lg(mutex);
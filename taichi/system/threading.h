@@ -7,9 +7,12 @@
 
 #include "taichi/common/core.h"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 TI_NAMESPACE_BEGIN
@@ -54,9 +57,74 @@ class ThreadPool {
     return pool->run(splits, desired_num_threads, range_for_task_context, func);
   }
 
+  // Calls func(thread_id, i) for i in [0, n), in blocks of consecutive i's.
+  template <typename Func>
+  void parallel_for(int n, int desired_num_threads, const Func &func) {
+    if (n <= 0) {
+      return;
+    }
+    struct Context {
+      const Func *func;
+      int n;
+      int block_size;
+    } context{&func, n, std::max(1, n / (desired_num_threads * 16))};
+    run((n + context.block_size - 1) / context.block_size, desired_num_threads,
+        &context, [](void *p, int thread_id, int block) {
+          const auto *ctx = (const Context *)p;
+          const int end = std::min(ctx->n, (block + 1) * ctx->block_size);
+          for (int i = block * ctx->block_size; i < end; i++) {
+            (*ctx->func)(thread_id, i);
+          }
+        });
+  }
+
   void target();
 
   ~ThreadPool();
 };
 
+// A process-wide thread pool for the parallel loops run on the host outside
+// of kernels, e.g. by sparse matrices and by the GUI canvas. It starts with
+// one thread per core, and only grows.
+class SharedThreadPool {
+ public:
+  static SharedThreadPool &get_instance();
+
+  int num_threads() const {
+    std::lock_guard<std::mutex> _(mutex_);
+    return num_threads_;
+  }
+
+  // Calls func(thread_id, i) for i in [0, n), where thread_id is less than
+  // num_threads(). Loops started by different threads are serialized, and
+  // loops must not be nested.
+  template <typename Func>
+  void parallel_for(int n, const Func &func) {
+    std::lock_guard<std::mutex> _(mutex_);
+    pool_->parallel_for(n, num_threads_, func);
+  }
+
+  // Same as above, but on |num_threads| threads, so thread_id is less than
+  // |num_threads|. The pool grows if it has fewer threads.
+  template <typename Func>
+  void parallel_for(int n, int num_threads, const Func &func) {
+    num_threads = std::max(1, num_threads);
+    std::lock_guard<std::mutex> _(mutex_);
+    if (num_threads > num_threads_) {
+      grow(num_threads);
+    }
+    pool_->parallel_for(n, num_threads, func);
+  }
+
+ private:
+  SharedThreadPool();
+
+  // Recreates the threads. Must be called with |mutex_| held.
+  void grow(int num_threads);
+
+  int num_threads_{0};
+  std::unique_ptr<ThreadPool> pool_;
+  mutable std::mutex mutex_;
+};
+
 TI_NAMESPACE_END
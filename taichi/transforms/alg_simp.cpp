@@ -419,11 +419,17 @@ class AlgSimp : public BasicStmtVisitor {
     }
   }
 
-  static bool run(IRNode *node, bool fast_math) {
+  static bool run(IRNode *node, bool fast_math, StmtWorklist *worklist) {
     AlgSimp simplifier(fast_math);
     bool modified = false;
     while (true) {
-      node->accept(&simplifier);
+      if (worklist) {
+        for (auto *stmt : worklist->collect(node)) {
+          stmt->accept(&simplifier);
+        }
+      } else {
+        node->accept(&simplifier);
+      }
       if (simplifier.modifier.modify_ir())
         modified = true;
       else
@@ -435,9 +441,11 @@ class AlgSimp : public BasicStmtVisitor {
 
 namespace irpass {
 
-bool alg_simp(IRNode *root, const CompileConfig &config) {
+bool alg_simp(IRNode *root,
+              const CompileConfig &config,
+              StmtWorklist *worklist) {
   TI_AUTO_PROF;
-  return AlgSimp::run(root, config.fast_math);
+  return AlgSimp::run(root, config.fast_math, worklist);
 }
 
 }  // namespace irpass
@@ -169,11 +169,17 @@ class BinaryOpSimp : public BasicStmtVisitor {
            op == BinaryOpType::bit_xor;
   }
 
-  static bool run(IRNode *node, bool fast_math) {
+  static bool run(IRNode *node, bool fast_math, StmtWorklist *worklist) {
     BinaryOpSimp simplifier(fast_math);
     bool modified = false;
     while (true) {
-      node->accept(&simplifier);
+      if (worklist) {
+        for (auto *stmt : worklist->collect(node)) {
+          stmt->accept(&simplifier);
+        }
+      } else {
+        node->accept(&simplifier);
+      }
       if (simplifier.modifier.modify_ir()) {
         modified = true;
       } else
@@ -185,9 +191,11 @@ class BinaryOpSimp : public BasicStmtVisitor {
 
 namespace irpass {
 
-bool binary_op_simplify(IRNode *root, const CompileConfig &config) {
+bool binary_op_simplify(IRNode *root,
+                        const CompileConfig &config,
+                        StmtWorklist *worklist) {
   TI_AUTO_PROF;
-  return BinaryOpSimp::run(root, config.fast_math);
+  return BinaryOpSimp::run(root, config.fast_math, worklist);
 }
 
 }  // namespace irpass
@@ -223,7 +223,8 @@ void offload_to_executable(IRNode *ir,
 
   if (is_extension_supported(config.arch, Extension::quant) &&
       ir->get_config().quant_opt_atomic_demotion) {
-    irpass::analysis::gather_uniquely_accessed_bit_structs(ir, amgr.get());
+    irpass::analysis::gather_uniquely_accessed_bit_structs(ir, config,
+                                                           amgr.get());
   }
 
   irpass::remove_range_assumption(ir);
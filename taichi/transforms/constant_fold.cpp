@@ -220,7 +220,7 @@ class ConstantFold : public BasicStmtVisitor {
     modifier.erase(stmt);
   }
 
-  static bool run(IRNode *node, Program *program) {
+  static bool run(IRNode *node, Program *program, StmtWorklist *worklist) {
     ConstantFold folder(program);
     bool modified = false;
 
@@ -230,7 +230,13 @@ class ConstantFold : public BasicStmtVisitor {
     program->config.external_optimization_level = 0;
 
     while (true) {
-      node->accept(&folder);
+      if (worklist) {
+        for (auto *stmt : worklist->collect(node)) {
+          stmt->accept(&folder);
+        }
+      } else {
+        node->accept(&folder);
+      }
       if (folder.modifier.modify_ir()) {
         modified = true;
       } else {
@@ -250,7 +256,8 @@ namespace irpass {
 
 bool constant_fold(IRNode *root,
                    const CompileConfig &config,
-                   const ConstantFoldPass::Args &args) {
+                   const ConstantFoldPass::Args &args,
+                   StmtWorklist *worklist) {
   TI_AUTO_PROF;
   // @archibate found that `debug=True` will cause JIT kernels
   // to evaluate incorrectly (always return 0), so we simply
@@ -263,7 +270,7 @@ bool constant_fold(IRNode *root,
   }
   if (!config.advanced_optimization)
     return false;
-  return ConstantFold::run(root, args.program);
+  return ConstantFold::run(root, args.program, worklist);
 }
 
 }  // namespace irpass
@@ -94,12 +94,32 @@ void convert_to_range_for(OffloadedStmt *offloaded, bool packed) {
     for (int i = 0; i < (int)snodes.size(); i++) {
       auto snode = snodes[i];
       offset -= snode->total_num_bits;
+      // Morton-ordered SNodes are iterated in Morton order as well
+      const int morton_bits = snode->morton_num_bits();
+      Stmt *cell = nullptr;
+      std::vector<int> morton_num_bits;
+      if (morton_bits > 0) {
+        cell = body_header.push_back<BitExtractStmt>(
+            main_loop_var, offset, offset + snode->total_num_bits);
+        for (auto p : physical_indices) {
+          if (snode->extractors[p].active) {
+            morton_num_bits.push_back(snode->extractors[p].num_bits);
+          }
+        }
+      }
+      int morton_axis = 0;
       for (int j = 0; j < (int)physical_indices.size(); j++) {
         auto p = physical_indices[j];
         auto ext = snode->extractors[p];
-        Stmt *delta = body_header.push_back<BitExtractStmt>(
-            main_loop_var, ext.acc_offset + offset,
-            ext.acc_offset + offset + ext.num_bits);
+        Stmt *delta;
+        if (morton_bits > 0 && ext.active) {
+          delta = generate_morton_index(&body_header, cell, morton_num_bits,
+                                        morton_bits, morton_axis++);
+        } else {
+          delta = body_header.push_back<BitExtractStmt>(
+              main_loop_var, ext.acc_offset + offset,
+              ext.acc_offset + offset + ext.num_bits);
+        }
         start_bits[p] -= ext.num_bits;
         auto multiplier =
             body_header.push_back<ConstStmt>(TypedConstant(1 << start_bits[p]));
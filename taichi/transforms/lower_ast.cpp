@@ -214,6 +214,7 @@ class LowerAST : public IRVisitor {
             stmt->strictly_serialized);
         new_for->body->insert(std::make_unique<LoopIndexStmt>(new_for.get(), 0),
                               0);
+        new_for->mem_access_opt = stmt->mem_access_opt;
         new_for->body->local_var_to_stmt[stmt->loop_var_id[0]] =
             new_for->body->statements[0].get();
         fctx.push_back(std::move(new_for));
@@ -358,6 +359,7 @@ class LowerAST : public IRVisitor {
             BinaryOpType::div, loop_index, shape[i]);
       }
       new_for->body->insert(std::move(new_statements), 0);
+      new_for->mem_access_opt = stmt->mem_access_opt;
       fctx.push_back(std::move(new_for));
     }
     stmt->parent->replace_with(stmt, std::move(fctx.stmts));
@@ -21,11 +21,26 @@ void make_block_local_offload(OffloadedStmt *offload,
 
   std::size_t bls_offset_in_bytes = 0;
 
+  // On CPUs the BLS buffer is a thread-local array, which only pays off while
+  // it stays in the cache of the core running the block.
+  const bool cpu = arch_is_cpu(config.arch);
+  constexpr std::size_t kMaxCPUBLSSizeInBytes = 256 * 1024;
+
   for (auto &pad : pads->pads) {
     auto snode = pad.first;
     auto data_type = snode->dt.ptr_removed();
     auto dtype_size = data_type_size(data_type);
 
+    if (cpu && bls_offset_in_bytes + dtype_size * pad.second.pad_size_linear() >
+                   kMaxCPUBLSSizeInBytes) {
+      TI_WARN(
+          "(kernel={}) Not caching {} in BLS: the block-local buffer would "
+          "exceed {} KiB. Use smaller blocks for it to fit in the CPU cache.",
+          kernel_name, snode->get_node_type_name_hinted(),
+          kMaxCPUBLSSizeInBytes / 1024);
+      continue;
+    }
+
     bool bls_has_read = pad.second.total_flags & AccessFlag::read;
     bool bls_has_write = pad.second.total_flags & AccessFlag::write;
     bool bls_has_accumulate = pad.second.total_flags & AccessFlag::accumulate;
@@ -58,6 +73,87 @@ void make_block_local_offload(OffloadedStmt *offload,
     bls_offset_in_bytes +=
         (dtype_size - bls_offset_in_bytes % dtype_size) % dtype_size;
 
+    // Used by create_xlogue below on CPUs
+    auto create_cpu_xlogue =
+        [&](std::unique_ptr<Block> &block,
+            const std::function<void(
+                Block * element_block, std::vector<Stmt *> global_indices,
+                Stmt * bls_element_offset_bytes)> &operation) {
+          /*
+          On CPUs the whole block is processed by a single thread, which
+          therefore has to fill the entire BLS buffer by itself. Instead of
+          the block-stride loop, it walks the buffer in nested loops, one per
+          dimension:
+
+          for c_0 in range(pad.pad_size[0]):
+            ...
+              for c_{dim-1} in range(pad.pad_size[dim - 1]):
+                bls[sum_i c_i * bls_strides[i]] =
+                    x[BlockCorner[i] + pad.bounds[i].low + c_i, ...]
+
+          so that there is no % or / per element, and the innermost loop
+          reads consecutive elements of a row.
+          */
+          std::vector<Stmt *> bls_corners(dim);
+          for (int i = 0; i < dim; i++) {
+            Stmt *block_corner =
+                block->push_back<BlockCornerIndexStmt>(offload, i);
+            if (pad.second.coefficients[i] > 1) {
+              block_corner = block->push_back<BinaryOpStmt>(
+                  BinaryOpType::mul, block_corner,
+                  block->push_back<ConstStmt>(
+                      TypedConstant(pad.second.coefficients[i])));
+            }
+            bls_corners[i] = block->push_back<BinaryOpStmt>(
+                BinaryOpType::add, block_corner,
+                block->push_back<ConstStmt>(
+                    TypedConstant(pad.second.bounds[i].low)));
+          }
+
+          Block *element_block = block.get();
+          std::vector<Stmt *> global_indices(dim);
+          Stmt *bls_element_id = nullptr;
+          for (int i = 0; i < dim; i++) {
+            auto loop = element_block
+                            ->push_back<RangeForStmt>(
+                                element_block->push_back<ConstStmt>(
+                                    TypedConstant(0)),
+                                element_block->push_back<ConstStmt>(
+                                    TypedConstant(pad.second.pad_size[i])),
+                                std::make_unique<Block>(), /*vectorize=*/1,
+                                /*bit_vectorize=*/1, /*num_cpu_threads=*/1,
+                                /*block_dim=*/1,
+                                /*strictly_serialized=*/false)
+                            ->as<RangeForStmt>();
+            element_block = loop->body.get();
+            auto bls_coord = element_block->push_back<LoopIndexStmt>(loop, 0);
+            global_indices[i] = element_block->push_back<BinaryOpStmt>(
+                BinaryOpType::add, bls_corners[i], bls_coord);
+            auto inc = element_block->push_back<BinaryOpStmt>(
+                BinaryOpType::mul, bls_coord,
+                element_block->push_back<ConstStmt>(
+                    TypedConstant(bls_strides[i])));
+            if (!bls_element_id) {
+              bls_element_id = inc;
+            } else {
+              bls_element_id = element_block->push_back<BinaryOpStmt>(
+                  BinaryOpType::add, bls_element_id, inc);
+            }
+          }
+
+          Stmt *bls_element_offset_bytes =
+              element_block->push_back<BinaryOpStmt>(
+                  BinaryOpType::mul, bls_element_id,
+                  element_block->push_back<ConstStmt>(
+                      TypedConstant(dtype_size)));
+          bls_element_offset_bytes = element_block->push_back<BinaryOpStmt>(
+              BinaryOpType::add, bls_element_offset_bytes,
+              element_block->push_back<ConstStmt>(
+                  TypedConstant((int32)bls_offset_in_bytes)));
+
+          operation(element_block, global_indices, bls_element_offset_bytes);
+        };
+
     // This lambda is used for both BLS prologue and epilogue creation
     auto create_xlogue =
         [&](std::unique_ptr<Block> &block,
@@ -68,6 +164,10 @@ void make_block_local_offload(OffloadedStmt *offload,
             block = std::make_unique<Block>();
             block->parent_stmt = offload;
           }
+          if (cpu) {
+            create_cpu_xlogue(block, operation);
+            return;
+          }
           // Equivalent to CUDA threadIdx
           Stmt *thread_idx_stmt =
               block->push_back<LoopLinearIndexStmt>(offload);
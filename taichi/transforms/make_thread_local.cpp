@@ -126,7 +126,18 @@ void make_thread_local_offload(OffloadedStmt *offload) {
   // reduce buffer fragmentation.
   for (auto dest : valid_reduction_values) {
     auto data_type = dest.first->ret_type.ptr_removed();
-    auto dtype_size = data_type_size(data_type);
+    // Sums of low-precision reals can be accumulated in f64 upon request
+    // (ti.accumulate_in_f64), and are only rounded once per thread when merged
+    // into the destination.
+    auto acc_type = data_type;
+    if (auto global_ptr = dest.first->cast<GlobalPtrStmt>();
+        global_ptr && dest.second == AtomicOpType::add && is_real(data_type) &&
+        data_type_bits(data_type) < 64 &&
+        offload->mem_access_opt.has_flag(global_ptr->snodes[0],
+                                         SNodeAccessFlag::f64_accumulator)) {
+      acc_type = PrimitiveType::f64;
+    }
+    auto dtype_size = data_type_size(acc_type);
     // Step 1:
     // Create thread local storage
     {
@@ -140,14 +151,14 @@ void make_thread_local_offload(OffloadedStmt *offload) {
 
       auto tls_ptr = offload->tls_prologue->push_back<ThreadLocalPtrStmt>(
           tls_offset,
-          TypeFactory::create_vector_or_scalar_type(1, data_type, true));
+          TypeFactory::create_vector_or_scalar_type(1, acc_type, true));
 
       auto zero = offload->tls_prologue->insert(
           std::make_unique<ConstStmt>(dest.second == AtomicOpType::max
                                           ? get_min_value(data_type)
                                           : dest.second == AtomicOpType::min
                                                 ? get_max_value(data_type)
-                                                : TypedConstant(data_type, 0)),
+                                                : TypedConstant(acc_type, 0)),
           -1);
       // Zero-fill
       // TODO: do not use GlobalStore for TLS ptr.
@@ -160,9 +171,25 @@ void make_thread_local_offload(OffloadedStmt *offload) {
       auto tls_ptr = offload->body->insert(
           Stmt::make<ThreadLocalPtrStmt>(
               tls_offset,
-              TypeFactory::create_vector_or_scalar_type(1, data_type, true)),
+              TypeFactory::create_vector_or_scalar_type(1, acc_type, true)),
           0);
       dest.first->replace_with(tls_ptr);
+      if (acc_type != data_type) {
+        // Widen the values before accumulating them
+        auto atomics = irpass::analysis::gather_statements(
+            offload->body.get(), [&](Stmt *stmt) {
+              auto atomic = stmt->cast<AtomicOpStmt>();
+              return atomic && atomic->dest == tls_ptr;
+            });
+        for (auto stmt : atomics) {
+          auto atomic = stmt->as<AtomicOpStmt>();
+          auto cast = Stmt::make_typed<UnaryOpStmt>(UnaryOpType::cast_value,
+                                                    atomic->val);
+          cast->cast_type = acc_type;
+          cast->ret_type = acc_type;
+          atomic->val = atomic->insert_before_me(std::move(cast));
+        }
+      }
     }
 
     // Step 3:
@@ -174,9 +201,17 @@ void make_thread_local_offload(OffloadedStmt *offload) {
       }
       auto tls_ptr = offload->tls_epilogue->push_back<ThreadLocalPtrStmt>(
           tls_offset,
-          TypeFactory::create_vector_or_scalar_type(1, data_type, true));
+          TypeFactory::create_vector_or_scalar_type(1, acc_type, true));
       // TODO: do not use global load from TLS.
-      auto tls_load = offload->tls_epilogue->push_back<GlobalLoadStmt>(tls_ptr);
+      Stmt *tls_load =
+          offload->tls_epilogue->push_back<GlobalLoadStmt>(tls_ptr);
+      if (acc_type != data_type) {
+        auto cast = offload->tls_epilogue->push_back<UnaryOpStmt>(
+            UnaryOpType::cast_value, tls_load);
+        cast->as<UnaryOpStmt>()->cast_type = data_type;
+        cast->ret_type = data_type;
+        tls_load = cast;
+      }
       auto global_ptr = offload->tls_epilogue->insert(
           std::unique_ptr<Stmt>(
               (Stmt *)irpass::analysis::clone(dest.first).release()),
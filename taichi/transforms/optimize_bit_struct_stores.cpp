@@ -163,6 +163,31 @@ class DemoteAtomicBitStructStores : public BasicStmtVisitor {
     }
   }
 
+  void visit(GlobalStoreStmt *stmt) override {
+    auto get_ch = stmt->dest->cast<GetChStmt>();
+    if (!get_ch || get_ch->input_snode->type != SNodeType::bit_array)
+      return;
+    bool demote = false;
+    TI_ASSERT(current_offloaded);
+    if (current_offloaded->task_type == OffloadedTaskType::serial) {
+      demote = true;
+    } else if (current_offloaded->task_type == OffloadedTaskType::range_for ||
+               current_offloaded->task_type == OffloadedTaskType::struct_for) {
+      // Only kept for bit_arrays whose words are owned by the threads, see
+      // UniquelyAccessedBitStructGatherer
+      auto accessed_ptr_iterator =
+          current_iterator_->second.find(get_ch->input_snode);
+      if (accessed_ptr_iterator != current_iterator_->second.end() &&
+          accessed_ptr_iterator->second != nullptr) {
+        demote = true;
+      }
+    }
+    if (demote) {
+      stmt->is_atomic = false;
+      modified_ = true;
+    }
+  }
+
   void visit(OffloadedStmt *stmt) override {
     current_offloaded = stmt;
     if (stmt->task_type == OffloadedTaskType::range_for ||
@@ -7,6 +7,7 @@
 #include "taichi/ir/statements.h"
 #include "taichi/transforms/scalar_pointer_lowerer.h"
 #include "taichi/transforms/utils.h"
+#include "taichi/util/bit.h"
 
 namespace taichi {
 namespace lang {
@@ -93,8 +94,19 @@ void ScalarPointerLowerer::run() {
       strides.push_back(snode->extractors[k].shape);
     }
     // linearize
-    auto *linearized =
-        lowered_->push_back<LinearizeStmt>(lowered_indices, strides);
+    LinearizeStmt *linearized;
+    if (const int morton_bits = snode->morton_num_bits();
+        morton_bits > 0 && !packed_) {
+      std::vector<int> num_bits;
+      for (int stride : strides) {
+        num_bits.push_back(bit::log2int(stride));
+      }
+      linearized = generate_morton_linearized(lowered_, lowered_indices,
+                                              num_bits, morton_bits)
+                       ->as<LinearizeStmt>();
+    } else {
+      linearized = lowered_->push_back<LinearizeStmt>(lowered_indices, strides);
+    }
 
     last = handle_snode_at_level(i, linearized, last);
   }
@@ -6,7 +6,10 @@
 #include "taichi/transforms/simplify.h"
 #include "taichi/program/kernel.h"
 #include "taichi/program/program.h"
+#include <algorithm>
+#include <functional>
 #include <set>
+#include <typeindex>
 #include <unordered_set>
 #include <utility>
 
@@ -599,6 +602,47 @@ class Simplify : public IRVisitor {
 
 const PassID FullSimplifyPass::id = "FullSimplifyPass";
 
+std::size_t StmtWorklist::fingerprint(Stmt *stmt) {
+  constexpr std::size_t kPrime = 100000007UL;
+  std::size_t result = std::type_index(typeid(*stmt)).hash_code();
+  result = result * kPrime + std::hash<const Type *>{}(stmt->ret_type);
+  result = result * kPrime + stmt->field_manager.hash();
+  for (int i = 0; i < stmt->num_operands(); i++) {
+    auto *operand = stmt->operand(i);
+    result = result * kPrime + (operand ? operand->instance_id : -1);
+  }
+  return result;
+}
+
+std::vector<Stmt *> StmtWorklist::collect(IRNode *root) {
+  constexpr int kMaxDepth = 2;
+  // Distance from each statement to the closest changed statement among its
+  // operands (transitively). Operands precede their users in program order.
+  std::unordered_map<Stmt *, int> depth;
+  std::vector<Stmt *> result;
+  irpass::analysis::gather_statements(root, [&](Stmt *stmt) {
+    const auto fp = fingerprint(stmt);
+    auto iter = fingerprints_.find(stmt->instance_id);
+    int d = kMaxDepth + 1;
+    if (iter == fingerprints_.end() || iter->second != fp) {
+      fingerprints_[stmt->instance_id] = fp;
+      d = 0;
+    }
+    for (int i = 0; i < stmt->num_operands() && d > 0; i++) {
+      auto operand_depth = depth.find(stmt->operand(i));
+      if (operand_depth != depth.end()) {
+        d = std::min(d, operand_depth->second + 1);
+      }
+    }
+    depth[stmt] = d;
+    if (d <= kMaxDepth) {
+      result.push_back(stmt);
+    }
+    return false;
+  });
+  return result;
+}
+
 namespace irpass {
 
 bool simplify(IRNode *root, const CompileConfig &config) {
@@ -619,38 +663,60 @@ void full_simplify(IRNode *root,
                    const FullSimplifyPass::Args &args) {
   TI_AUTO_PROF;
   if (config.advanced_optimization) {
-    bool first_iteration = true;
+    // A worklist of the sub-passes: a pass is only rerun if some pass has
+    // modified the IR since it last ran without modifying the IR. The passes
+    // are deterministic, so skipping such a pass cannot miss any change.
+    // The peephole passes also keep a worklist of statements, so that they
+    // only revisit the statements that have changed since they last ran.
+    StmtWorklist binary_op_simplify_worklist;
+    StmtWorklist constant_fold_worklist;
+    StmtWorklist alg_simp_worklist;
+    struct SubPass {
+      std::function<bool()> run;
+      // The IR version at which this pass last found nothing to do
+      int clean_version{-1};
+    };
+    std::vector<SubPass> passes;
+    passes.push_back({[&] { return extract_constant(root, config); }});
+    passes.push_back({[&] { return unreachable_code_elimination(root); }});
+    passes.push_back({[&] {
+      return binary_op_simplify(root, config, &binary_op_simplify_worklist);
+    }});
+    if (config.constant_folding) {
+      passes.push_back({[&] {
+        return constant_fold(root, config, {args.program},
+                             &constant_fold_worklist);
+      }});
+    }
+    passes.push_back({[&] { return die(root); }});
+    passes.push_back(
+        {[&] { return alg_simp(root, config, &alg_simp_worklist); }});
+    passes.push_back(
+        {[&] { return loop_invariant_code_motion(root, config); }});
+    passes.push_back({[&] { return die(root); }});
+    passes.push_back({[&] { return simplify(root, config); }});
+    passes.push_back({[&] { return die(root); }});
+    passes.push_back({[&] { return whole_kernel_cse(root); }});
+    if (config.cfg_optimization) {
+      // This is the most time-consuming pass, and it is skipped whenever the
+      // IR is not modified since its last run.
+      passes.push_back(
+          {[&] { return cfg_optimization(root, args.after_lower_access); }});
+    }
+
+    int ir_version = 0;
     while (true) {
       bool modified = false;
-      if (extract_constant(root, config))
-        modified = true;
-      if (unreachable_code_elimination(root))
-        modified = true;
-      if (binary_op_simplify(root, config))
-        modified = true;
-      if (config.constant_folding &&
-          constant_fold(root, config, {args.program}))
-        modified = true;
-      if (die(root))
-        modified = true;
-      if (alg_simp(root, config))
-        modified = true;
-      if (loop_invariant_code_motion(root, config))
-        modified = true;
-      if (die(root))
-        modified = true;
-      if (simplify(root, config))
-        modified = true;
-      if (die(root))
-        modified = true;
-      if (whole_kernel_cse(root))
-        modified = true;
-      // Don't do this time-consuming optimization pass again if the IR is
-      // not modified.
-      if ((first_iteration || modified) && config.cfg_optimization &&
-          cfg_optimization(root, args.after_lower_access))
-        modified = true;
-      first_iteration = false;
+      for (auto &pass : passes) {
+        if (pass.clean_version == ir_version)
+          continue;
+        if (pass.run()) {
+          ir_version++;
+          modified = true;
+        } else {
+          pass.clean_version = ir_version;
+        }
+      }
       if (!modified)
         break;
     }
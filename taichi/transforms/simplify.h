@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include "taichi/ir/pass.h"
 
 namespace taichi {
@@ -15,5 +18,24 @@ class FullSimplifyPass : public Pass {
   };
 };
 
+// The statements that a peephole pass (alg_simp, binary_op_simplify and
+// constant_fold) has to revisit when it is rerun: the statements that are new
+// or have changed since the pass last saw them, and their users up to two
+// levels down, as the peephole rules look at most at the operands of the
+// operands of a statement. A statement changes when its type, its fields or
+// its operands change.
+class StmtWorklist {
+ public:
+  // Returns the non-container statements of |root| to revisit in program
+  // order, and marks all the statements of |root| as seen.
+  std::vector<Stmt *> collect(IRNode *root);
+
+ private:
+  static std::size_t fingerprint(Stmt *stmt);
+
+  // Stmt::instance_id -> fingerprint of the statement when last seen
+  std::unordered_map<int, std::size_t> fingerprints_;
+};
+
 }  // namespace lang
 }  // namespace taichi
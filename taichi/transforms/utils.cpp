@@ -1,4 +1,6 @@
 #include "taichi/ir/statements.h"
+#include "taichi/transforms/utils.h"
+#include "taichi/util/bit.h"
 
 namespace taichi {
 namespace lang {
@@ -10,5 +12,84 @@ Stmt *generate_mod_x_div_y(VecStatement *stmts, Stmt *num, int x, int y) {
   return stmts->push_back<BinaryOpStmt>(BinaryOpType::div, mod_x, const_y);
 }
 
+namespace {
+
+Stmt *push_binary_op(VecStatement *stmts,
+                     BinaryOpType op,
+                     Stmt *lhs,
+                     int rhs) {
+  auto const_rhs = stmts->push_back<ConstStmt>(TypedConstant(rhs));
+  return stmts->push_back<BinaryOpStmt>(op, lhs, const_rhs);
+}
+
+}  // namespace
+
+Stmt *generate_morton_linearized(VecStatement *stmts,
+                                 const std::vector<Stmt *> &indices,
+                                 const std::vector<int> &num_bits,
+                                 int morton_bits) {
+  const int dim = (int)indices.size();
+  int max_stride = 1;
+  while (max_stride < morton_bits) {
+    max_stride *= 2;
+  }
+  // The high bits of the indices select a Z-order tile in row-major order,
+  // and the interleaved low bits select the cell inside the tile.
+  std::vector<Stmt *> inputs;
+  std::vector<int> strides;
+  Stmt *interleaved = stmts->push_back<ConstStmt>(TypedConstant(0));
+  for (int k = 0; k < dim; k++) {
+    inputs.push_back(
+        stmts->push_back<BitExtractStmt>(indices[k], morton_bits, num_bits[k]));
+    strides.push_back(1 << (num_bits[k] - morton_bits));
+    Stmt *spread =
+        stmts->push_back<BitExtractStmt>(indices[k], 0, morton_bits);
+    for (int stride = max_stride / 2; stride >= 1; stride /= 2) {
+      auto shifted = push_binary_op(stmts, BinaryOpType::bit_shl, spread,
+                                    stride * (dim - 1));
+      spread =
+          stmts->push_back<BinaryOpStmt>(BinaryOpType::bit_or, spread, shifted);
+      spread = push_binary_op(stmts, BinaryOpType::bit_and, spread,
+                              bit::morton_mask(dim, morton_bits, stride));
+    }
+    // The first axis takes the most significant bit of each group of |dim|
+    // bits, as it does in row-major order.
+    spread = push_binary_op(stmts, BinaryOpType::bit_shl, spread, dim - 1 - k);
+    interleaved = stmts->push_back<BinaryOpStmt>(BinaryOpType::bit_or,
+                                                 interleaved, spread);
+  }
+  inputs.push_back(interleaved);
+  strides.push_back(1 << (dim * morton_bits));
+  return stmts->push_back<LinearizeStmt>(inputs, strides);
+}
+
+Stmt *generate_morton_index(VecStatement *stmts,
+                            Stmt *linearized,
+                            const std::vector<int> &num_bits,
+                            int morton_bits,
+                            int k) {
+  const int dim = (int)num_bits.size();
+  int high_begin = dim * morton_bits;
+  for (int i = dim - 1; i > k; i--) {
+    high_begin += num_bits[i] - morton_bits;
+  }
+  Stmt *high = stmts->push_back<BitExtractStmt>(
+      linearized, high_begin, high_begin + num_bits[k] - morton_bits);
+  high = push_binary_op(stmts, BinaryOpType::bit_shl, high, morton_bits);
+  Stmt *compact = push_binary_op(stmts, BinaryOpType::bit_shr, linearized,
+                                 dim - 1 - k);
+  compact = push_binary_op(stmts, BinaryOpType::bit_and, compact,
+                           bit::morton_mask(dim, morton_bits, 1));
+  for (int stride = 1; stride < morton_bits; stride *= 2) {
+    auto shifted = push_binary_op(stmts, BinaryOpType::bit_shr, compact,
+                                  stride * (dim - 1));
+    compact =
+        stmts->push_back<BinaryOpStmt>(BinaryOpType::bit_or, compact, shifted);
+    compact = push_binary_op(stmts, BinaryOpType::bit_and, compact,
+                             bit::morton_mask(dim, morton_bits, stride * 2));
+  }
+  return stmts->push_back<BinaryOpStmt>(BinaryOpType::bit_or, high, compact);
+}
+
 }  // namespace lang
 }  // namespace taichi
@@ -1,9 +1,27 @@
 #pragma once
 
+#include <vector>
+
 namespace taichi {
 namespace lang {
 
 Stmt *generate_mod_x_div_y(VecStatement *stmts, Stmt *num, int x, int y);
 
+// Linearizes the |indices| of a Morton-ordered SNode along its active axes,
+// where the k-th index has |num_bits[k]| bits and the low |morton_bits| bits of
+// all indices are interleaved. See SNode::morton_num_bits().
+Stmt *generate_morton_linearized(VecStatement *stmts,
+                                 const std::vector<Stmt *> &indices,
+                                 const std::vector<int> &num_bits,
+                                 int morton_bits);
+
+// The inverse of generate_morton_linearized(): the index along the k-th active
+// axis of the cell at |linearized|.
+Stmt *generate_morton_index(VecStatement *stmts,
+                            Stmt *linearized,
+                            const std::vector<int> &num_bits,
+                            int morton_bits,
+                            int k);
+
 }  // namespace lang
 }  // namespace taichi
@@ -9,46 +9,54 @@
 
 TLANG_NAMESPACE_BEGIN
 
-// A helper class to maintain WholeKernelCSE::visited
-class MarkUndone : public BasicStmtVisitor {
+// Replaces the operands eliminated by WholeKernelCSE in a single sweep.
+class ReplaceEliminatedOperands : public BasicStmtVisitor {
  private:
-  std::unordered_set<int> *const visited;
-  Stmt *const modified_operand;
+  const std::unordered_map<Stmt *, Stmt *> &replaced;
 
  public:
   using BasicStmtVisitor::visit;
 
-  MarkUndone(std::unordered_set<int> *visited, Stmt *modified_operand)
-      : visited(visited), modified_operand(modified_operand) {
+  explicit ReplaceEliminatedOperands(
+      const std::unordered_map<Stmt *, Stmt *> &replaced)
+      : replaced(replaced) {
     allow_undefined_visitor = true;
     invoke_default_visitor = true;
   }
 
-  void visit(Stmt *stmt) override {
-    if (stmt->has_operand(modified_operand)) {
-      visited->erase(stmt->instance_id);
+  void replace_operands(Stmt *stmt) {
+    for (int i = 0; i < stmt->num_operands(); i++) {
+      auto it = replaced.find(stmt->operand(i));
+      if (it != replaced.end()) {
+        stmt->set_operand(i, it->second);
+      }
     }
   }
 
-  void preprocess_container_stmt(Stmt *stmt) override {
-    if (stmt->has_operand(modified_operand)) {
-      visited->erase(stmt->instance_id);
-    }
+  void visit(Stmt *stmt) override {
+    replace_operands(stmt);
   }
 
-  static void run(std::unordered_set<int> *visited, Stmt *modified_operand) {
-    MarkUndone marker(visited, modified_operand);
-    modified_operand->get_ir_root()->accept(&marker);
+  void preprocess_container_stmt(Stmt *stmt) override {
+    replace_operands(stmt);
   }
 };
 
-// Whole Kernel Common Subexpression Elimination
+// Whole Kernel Common Subexpression Elimination, implemented as a scoped
+// hash-based global value numbering: every CSE-able statement is keyed on a
+// structural hash of its type, its (already numbered) operands and its
+// fields, so that finding an equivalent visible statement takes expected
+// constant time instead of a scan over all the statements of the same type.
 class WholeKernelCSE : public BasicStmtVisitor {
  private:
-  std::unordered_set<int> visited;
-  // each scope corresponds to an unordered_set
-  std::vector<std::unordered_map<std::type_index, std::unordered_set<Stmt *>>>
-      visible_stmts;
+  // Visible CSE-able statements keyed by their structural hash. Only
+  // statements without side effects are CSE-able, so an entry stays valid
+  // until the scope defining it is left.
+  std::unordered_map<std::size_t, std::vector<Stmt *>> value_table;
+  // Keys inserted into |value_table| by each scope on the stack
+  std::vector<std::vector<std::size_t>> scope_keys;
+  // Eliminated statement -> the visible statement replacing it
+  std::unordered_map<Stmt *, Stmt *> replaced;
   DelayedIRModifier modifier;
 
  public:
@@ -59,12 +67,24 @@ class WholeKernelCSE : public BasicStmtVisitor {
     invoke_default_visitor = true;
   }
 
-  bool is_done(Stmt *stmt) {
-    return visited.find(stmt->instance_id) != visited.end();
-  }
-
-  void set_done(Stmt *stmt) {
-    visited.insert(stmt->instance_id);
+  static std::size_t hash_statement(Stmt *stmt) {
+    constexpr std::size_t kPrime = 100000007UL;
+    std::size_t result = std::type_index(typeid(*stmt)).hash_code();
+    if (auto global_ptr = stmt->cast<GlobalPtrStmt>()) {
+      // See common_statement_eliminable(): the "activate" field is allowed to
+      // differ.
+      for (int i = 0; i < (int)global_ptr->snodes.size(); i++) {
+        result = result * kPrime +
+                 StmtFieldSNode::get_snode_id(global_ptr->snodes[i]);
+      }
+    } else if (!stmt->is<LoopUniqueStmt>()) {
+      // The "covers" field of LoopUniqueStmts is merged instead.
+      result = result * kPrime + stmt->field_manager.hash();
+    }
+    for (int i = 0; i < stmt->num_operands(); i++) {
+      result = result * kPrime + std::hash<Stmt *>{}(stmt->operand(i));
+    }
+    return result;
   }
 
   static bool common_statement_eliminable(Stmt *this_stmt, Stmt *prev_stmt) {
@@ -92,37 +112,63 @@ class WholeKernelCSE : public BasicStmtVisitor {
     return irpass::analysis::same_statements(this_stmt, prev_stmt);
   }
 
+  // Operands are visited before their usages, so replacing them here lets
+  // the usages of eliminated statements be numbered in the same sweep.
+  void replace_operands(Stmt *stmt) {
+    if (replaced.empty())
+      return;
+    for (int i = 0; i < stmt->num_operands(); i++) {
+      auto it = replaced.find(stmt->operand(i));
+      if (it != replaced.end()) {
+        stmt->set_operand(i, it->second);
+      }
+    }
+  }
+
   void visit(Stmt *stmt) override {
+    replace_operands(stmt);
     if (!stmt->common_statement_eliminable())
       return;
     // Generic visitor for all CSE-able statements.
-    if (is_done(stmt)) {
-      visible_stmts.back()[std::type_index(typeid(*stmt))].insert(stmt);
-      return;
-    }
-    for (auto &scope : visible_stmts) {
-      for (auto &prev_stmt : scope[std::type_index(typeid(*stmt))]) {
-        if (common_statement_eliminable(stmt, prev_stmt)) {
-          MarkUndone::run(&visited, stmt);
-          stmt->replace_with(prev_stmt);
+    const auto key = hash_statement(stmt);
+    auto it = value_table.find(key);
+    if (it != value_table.end()) {
+      for (auto &prev_stmt : it->second) {
+        if (typeid(*prev_stmt) == typeid(*stmt) &&
+            common_statement_eliminable(stmt, prev_stmt)) {
+          replaced[stmt] = prev_stmt;
           modifier.erase(stmt);
           return;
         }
       }
     }
-    visible_stmts.back()[std::type_index(typeid(*stmt))].insert(stmt);
-    set_done(stmt);
+    value_table[key].push_back(stmt);
+    scope_keys.back().push_back(key);
+  }
+
+  void preprocess_container_stmt(Stmt *stmt) override {
+    replace_operands(stmt);
   }
 
   void visit(Block *stmt_list) override {
-    visible_stmts.emplace_back();
+    scope_keys.emplace_back();
     for (auto &stmt : stmt_list->statements) {
       stmt->accept(this);
     }
-    visible_stmts.pop_back();
+    // Statements are inserted in a stack order, so the ones of this scope
+    // are at the back of their buckets.
+    for (auto key : scope_keys.back()) {
+      auto it = value_table.find(key);
+      it->second.pop_back();
+      if (it->second.empty()) {
+        value_table.erase(it);
+      }
+    }
+    scope_keys.pop_back();
   }
 
   void visit(IfStmt *if_stmt) override {
+    replace_operands(if_stmt);
     if (if_stmt->true_statements) {
       if (if_stmt->true_statements->statements.empty()) {
         if_stmt->set_true_statements(nullptr);
@@ -177,6 +223,13 @@ class WholeKernelCSE : public BasicStmtVisitor {
     bool modified = false;
     while (true) {
       node->accept(&eliminator);
+      if (!eliminator.replaced.empty()) {
+        // Usages visited before their operands are not covered by
+        // replace_operands().
+        ReplaceEliminatedOperands replacer(eliminator.replaced);
+        node->accept(&replacer);
+        eliminator.replaced.clear();
+      }
       if (eliminator.modifier.modify_ir())
         modified = true;
       else
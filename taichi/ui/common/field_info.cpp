@@ -22,6 +22,8 @@ DevicePtr get_device_ptr(taichi::lang::Program *program, SNode *snode) {
 
   SNode *dense_parent = snode->parent;
   SNode *root = dense_parent->parent;
+  TI_ERROR_IF(dense_parent->_morton,
+              "GGUI does not support fields stored in Morton order");
 
   int tree_id = root->get_snode_tree_id();
   DevicePtr root_ptr = program->get_snode_tree_device_ptr(tree_id);
@@ -98,6 +98,14 @@ Bitset Bitset::operator~() const {
   return result;
 }
 
+bool Bitset::operator==(const Bitset &other) const {
+  return vec_ == other.vec_;
+}
+
+bool Bitset::operator!=(const Bitset &other) const {
+  return !(*this == other);
+}
+
 int Bitset::find_first_one() const {
   return lower_bound(0);
 }
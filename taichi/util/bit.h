@@ -111,6 +111,21 @@ TI_FORCE_INLINE constexpr uint32 pot_mask(int x) {
   return (1u << x) - 1;
 }
 
+// Morton (Z-order) interleaving of |dim| coordinates of |num_bits| bits each
+// spreads a coordinate in steps of halving |stride|, moving its bit i to
+// (i & ~(stride - 1)) * dim + (i & (stride - 1)). Returns the positions its
+// bits occupy after the step of |stride|. With stride = 1 they are the final
+// positions i * dim, and with stride >= num_bits they are the original ones.
+TI_FORCE_INLINE constexpr uint32 morton_mask(int dim,
+                                            int num_bits,
+                                            int stride) {
+  uint32 mask = 0;
+  for (int i = 0; i < num_bits; i++) {
+    mask |= 1u << ((i & ~(stride - 1)) * dim + (i & (stride - 1)));
+  }
+  return mask;
+}
+
 TI_FORCE_INLINE constexpr uint32 log2int(uint64 value) {
   int ret = 0;
   value >>= 1;
@@ -185,6 +200,8 @@ class Bitset {
   Bitset operator|(const Bitset &other) const;
   Bitset &operator^=(const Bitset &other);
   Bitset operator~() const;
+  bool operator==(const Bitset &other) const;
+  bool operator!=(const Bitset &other) const;
 
   // Find the place of the first "1", or return -1 if it doesn't exist.
   int find_first_one() const;
@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include "taichi/ir/analysis.h"
+#include "taichi/ir/control_flow_graph.h"
+#include "taichi/ir/ir_builder.h"
+#include "taichi/ir/statements.h"
+#include "tests/cpp/program/test_program.h"
+
+namespace taichi {
+namespace lang {
+
+TEST(ControlFlowGraph, ReachingDefinitionAndLiveVariable) {
+  TestProgram test_prog;
+  test_prog.setup();
+
+  IRBuilder builder;
+  auto *x = builder.create_arg_load(0, get_data_type<int>(), false);
+  auto *var = builder.create_local_var(get_data_type<int>());
+  builder.create_local_store(var, builder.get_int32(1));
+  auto *if_stmt = builder.create_if(x);
+  {
+    auto _ = builder.get_if_guard(if_stmt, true);
+    builder.create_local_store(var, builder.get_int32(2));
+  }
+  auto *load = builder.create_local_load(var);
+  builder.create_return(load);
+  auto ir = builder.extract_ir();
+  ASSERT_TRUE(ir->is<Block>());
+  auto *block = ir->as<Block>();
+
+  Stmt *outer_store = block->statements[block->locate(if_stmt) - 1].get();
+  Stmt *inner_store = if_stmt->true_statements->statements.back().get();
+  ASSERT_TRUE(outer_store->is<LocalStoreStmt>());
+  ASSERT_TRUE(inner_store->is<LocalStoreStmt>());
+
+  auto cfg = irpass::analysis::build_cfg(block);
+  auto find_node = [&](Stmt *stmt) -> CFGNode * {
+    for (auto &node : cfg->nodes) {
+      if (node->block == stmt->parent) {
+        const int location = node->block->locate(stmt);
+        if (location >= node->begin_location &&
+            location < node->end_location) {
+          return node.get();
+        }
+      }
+    }
+    return nullptr;
+  };
+
+  cfg->reaching_definition_analysis(/*after_lower_access=*/true);
+  auto *load_node = find_node(load);
+  ASSERT_NE(load_node, nullptr);
+  // Both stores reach the load, one of them through the if branch.
+  EXPECT_EQ(load_node->reach_in.size(), 2);
+  EXPECT_EQ(load_node->reach_in.count(outer_store), 1);
+  EXPECT_EQ(load_node->reach_in.count(inner_store), 1);
+  auto *inner_node = find_node(inner_store);
+  ASSERT_NE(inner_node, nullptr);
+  EXPECT_EQ(inner_node->reach_out.size(), 1);
+  EXPECT_EQ(inner_node->reach_out.count(inner_store), 1);
+
+  cfg->live_variable_analysis(/*after_lower_access=*/true, std::nullopt);
+  auto *outer_node = find_node(outer_store);
+  ASSERT_NE(outer_node, nullptr);
+  EXPECT_EQ(outer_node->live_out.count(var), 1);
+  EXPECT_EQ(load_node->live_out.count(var), 0);
+}
+
+}  // namespace lang
+}  // namespace taichi
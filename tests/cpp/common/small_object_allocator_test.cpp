@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "taichi/system/small_object_allocator.h"
+
+namespace taichi {
+
+TEST(SmallObjectAllocator, Reuse) {
+  if (!SmallObjectAllocator::enabled()) {
+    return;
+  }
+  void *a = SmallObjectAllocator::allocate(40);
+  SmallObjectAllocator::deallocate(a, 40);
+  // Same size class
+  void *b = SmallObjectAllocator::allocate(48);
+  EXPECT_EQ(a, b);
+  SmallObjectAllocator::deallocate(b, 48);
+}
+
+TEST(SmallObjectAllocator, CrossThread) {
+  struct Node : SmallObject {
+    virtual ~Node() = default;
+    int value{0};
+  };
+  struct LargeNode : Node {
+    char payload[2000];
+  };
+
+  std::vector<Node *> nodes;
+  for (int i = 0; i < 1000; i++) {
+    Node *node = (i % 2) ? new LargeNode : new Node;
+    node->value = i;
+    nodes.push_back(node);
+  }
+  // Free on another thread, which then exits
+  std::thread([&]() {
+    for (int i = 0; i < (int)nodes.size(); i++) {
+      EXPECT_EQ(nodes[i]->value, i);
+      delete nodes[i];
+    }
+  }).join();
+  for (int i = 0; i < 1000; i++) {
+    nodes[i] = new Node;
+    nodes[i]->value = -i;
+  }
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(nodes[i]->value, -i);
+    delete nodes[i];
+  }
+}
+
+TEST(SmallObjectAllocator, ProducerConsumer) {
+  if (!SmallObjectAllocator::enabled()) {
+    return;
+  }
+  struct Node : SmallObject {
+    virtual ~Node() = default;
+    int value{0};
+  };
+  constexpr int kRounds = 64;
+  constexpr int kNumNodes = 10000;
+  std::vector<Node *> nodes(kNumNodes);
+  // Even: the producer allocates, odd: the consumer frees.
+  std::atomic<int> turn{0};
+  auto wait_for = [&](int t) {
+    while (turn.load() != t) {
+      std::this_thread::yield();
+    }
+  };
+  // A long-lived thread freeing what the main thread allocates
+  std::thread consumer([&]() {
+    for (int r = 0; r < kRounds; r++) {
+      wait_for(2 * r + 1);
+      for (auto *node : nodes) {
+        delete node;
+      }
+      turn = 2 * r + 2;
+    }
+  });
+  std::size_t warm_bytes = 0;
+  for (int r = 0; r < kRounds; r++) {
+    wait_for(2 * r);
+    if (r == 2) {
+      warm_bytes = SmallObjectAllocator::chunk_bytes();
+    }
+    for (auto &node : nodes) {
+      node = new Node;
+    }
+    turn = 2 * r + 1;
+  }
+  wait_for(2 * kRounds);
+  consumer.join();
+  // The freed nodes flow back to the producer instead of piling up on the
+  // consumer, which would take about 10 MB here.
+  EXPECT_LE(SmallObjectAllocator::chunk_bytes() - warm_bytes, 1024 * 1024);
+}
+
+}  // namespace taichi
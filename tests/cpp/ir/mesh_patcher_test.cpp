@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include <set>
+
+#include "taichi/ir/mesh_patcher.h"
+
+namespace taichi {
+namespace lang {
+namespace mesh {
+namespace {
+
+// n^3 cubes, each of which is split into 6 tetrahedra
+std::vector<int> make_tet_grid(int n) {
+  auto vertex = [n](int i, int j, int k) {
+    return (i * (n + 1) + j) * (n + 1) + k;
+  };
+  std::vector<int> indices;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      for (int k = 0; k < n; k++) {
+        const int corner[8] = {
+            vertex(i, j, k),         vertex(i + 1, j, k),
+            vertex(i + 1, j + 1, k), vertex(i, j + 1, k),
+            vertex(i, j, k + 1),     vertex(i + 1, j, k + 1),
+            vertex(i + 1, j + 1, k + 1), vertex(i, j + 1, k + 1)};
+        const int tets[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+                                {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+        for (auto &tet : tets) {
+          for (int v : tet) {
+            indices.push_back(corner[v]);
+          }
+        }
+      }
+    }
+  }
+  return indices;
+}
+
+}  // namespace
+
+TEST(MeshPatcher, TetGrid) {
+  const int n = 3;
+  const auto indices = make_tet_grid(n);
+  const int num_vertices = (n + 1) * (n + 1) * (n + 1);
+  std::vector<MeshRelationType> relations;
+  for (int i = 0; i < 16; i++) {
+    relations.push_back(MeshRelationType(i));
+  }
+  const auto patches =
+      build_mesh_patches(MeshTopology::Tetrahedron, num_vertices, indices,
+                         relations, /*patch_size=*/16, /*num_threads=*/4);
+
+  const int num_cells = (int)indices.size() / 4;
+  const auto &verts = patches.elements.at(MeshElementType::Vertex);
+  const auto &edges = patches.elements.at(MeshElementType::Edge);
+  const auto &faces = patches.elements.at(MeshElementType::Face);
+  const auto &cells = patches.elements.at(MeshElementType::Cell);
+  EXPECT_EQ(verts.num, num_vertices);
+  EXPECT_EQ(cells.num, num_cells);
+  // Euler characteristic of a ball
+  EXPECT_EQ(verts.num - edges.num + faces.num - cells.num, 1);
+  EXPECT_GE(patches.num_patches, num_cells / 16);
+
+  for (const auto &[type, e] : patches.elements) {
+    ASSERT_EQ(e.owned_offsets.size(), patches.num_patches + 1);
+    ASSERT_EQ(e.total_offsets.size(), patches.num_patches + 1);
+    EXPECT_EQ(e.owned_offsets.back(), e.num);
+    std::set<int> reordered;
+    for (int p = 0; p < patches.num_patches; p++) {
+      const int num_owned = e.owned_offsets[p + 1] - e.owned_offsets[p];
+      const int num_total = e.total_offsets[p + 1] - e.total_offsets[p];
+      EXPECT_GE(num_total, num_owned);
+      EXPECT_LE(num_total, e.max_num_per_patch);
+      for (int i = 0; i < num_total; i++) {
+        const int l = e.total_offsets[p] + i;
+        EXPECT_EQ(e.g2r[e.l2g[l]], e.l2r[l]);
+        if (i < num_owned) {
+          EXPECT_EQ(e.l2r[l], e.owned_offsets[p] + i);
+          reordered.insert(e.l2r[l]);
+        }
+      }
+    }
+    EXPECT_EQ(reordered.size(), e.num);
+  }
+
+  // Cell-vertex relation in the patches matches the input
+  const auto &cv = patches.relations.at(MeshRelationType::CV);
+  EXPECT_TRUE(cv.offset.empty());
+  for (int p = 0; p < patches.num_patches; p++) {
+    for (int i = cells.total_offsets[p]; i < cells.total_offsets[p + 1]; i++) {
+      for (int j = 0; j < 4; j++) {
+        const int v = verts.l2g[verts.total_offsets[p] + cv.value[i * 4 + j]];
+        EXPECT_EQ(v, indices[cells.l2g[i] * 4 + j]);
+      }
+    }
+  }
+
+  // Each cell is found once from each of its vertices
+  const auto &vc = patches.relations.at(MeshRelationType::VC);
+  ASSERT_EQ(vc.offset.size(), verts.num + patches.num_patches);
+  EXPECT_EQ(vc.value.size(), num_cells * 4);
+  std::vector<int> count(num_cells, 0);
+  for (int p = 0; p < patches.num_patches; p++) {
+    const int base = verts.owned_offsets[p] + p;
+    const int num_owned = verts.owned_offsets[p + 1] - verts.owned_offsets[p];
+    for (int i = 0; i < num_owned; i++) {
+      const int v = verts.l2g[verts.total_offsets[p] + i];
+      for (int k = vc.offset[base + i]; k < vc.offset[base + i + 1]; k++) {
+        const int c = cells.l2g[cells.total_offsets[p] + vc.value[k]];
+        bool found = false;
+        for (int j = 0; j < 4; j++) {
+          found |= indices[c * 4 + j] == v;
+        }
+        EXPECT_TRUE(found);
+        count[c]++;
+      }
+    }
+  }
+  for (int c = 0; c < num_cells; c++) {
+    EXPECT_EQ(count[c], 4);
+  }
+
+  // Interior edges of the grid are shared by 4 or 6 cells, and every face is
+  // shared by at most 2 cells
+  const auto &cc = patches.relations.at(MeshRelationType::CC);
+  for (int i = 0; i + 1 < (int)cc.offset.size(); i++) {
+    EXPECT_LE(cc.offset[i + 1] - cc.offset[i], 4);
+  }
+}
+
+TEST(MeshPatcher, Triangles) {
+  // Two triangles sharing an edge
+  const std::vector<int> indices = {0, 1, 2, 2, 1, 3};
+  const auto patches = build_mesh_patches(
+      MeshTopology::Triangle, 4, indices,
+      {MeshRelationType::FV, MeshRelationType::FE, MeshRelationType::FF,
+       MeshRelationType::VV},
+      /*patch_size=*/1, /*num_threads=*/1);
+  EXPECT_EQ(patches.num_patches, 2);
+  EXPECT_EQ(patches.elements.at(MeshElementType::Edge).num, 5);
+  EXPECT_EQ(patches.elements.count(MeshElementType::Cell), 0);
+  const auto &ff = patches.relations.at(MeshRelationType::FF);
+  EXPECT_EQ(ff.value.size(), 2);
+  const auto &vv = patches.relations.at(MeshRelationType::VV);
+  // 5 edges, each seen from both ends
+  EXPECT_EQ(vv.value.size(), 10);
+}
+
+}  // namespace mesh
+}  // namespace lang
+}  // namespace taichi
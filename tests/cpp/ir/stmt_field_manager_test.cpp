@@ -47,6 +47,7 @@ TEST(StmtFieldManager, TestStmtFieldManager) {
   auto b = Stmt::make<TestStmt>(nullptr, 1, 2.0f);
 
   EXPECT_EQ(a->field_manager.equal(b->field_manager), true);
+  EXPECT_EQ(a->field_manager.hash(), b->field_manager.hash());
 
   auto c = Stmt::make<TestStmt>(nullptr, 2, 2.1f);
 
@@ -55,6 +56,17 @@ TEST(StmtFieldManager, TestStmtFieldManager) {
   // same field_manager
 }
 
+TEST(StmtFieldManager, TestStmtFieldManagerHashConstants) {
+  auto one = Stmt::make<ConstStmt>(LaneAttribute<TypedConstant>(1));
+  auto another_one = Stmt::make<ConstStmt>(LaneAttribute<TypedConstant>(1));
+  auto two = Stmt::make<ConstStmt>(LaneAttribute<TypedConstant>(2));
+  auto one_f32 = Stmt::make<ConstStmt>(LaneAttribute<TypedConstant>(1.0f));
+
+  EXPECT_EQ(one->field_manager.hash(), another_one->field_manager.hash());
+  EXPECT_NE(one->field_manager.hash(), two->field_manager.hash());
+  EXPECT_NE(one->field_manager.hash(), one_f32->field_manager.hash());
+}
+
 TEST(StmtFieldManager, TestStmtFieldManagerWithVector) {
   auto one = Stmt::make<ConstStmt>(LaneAttribute<TypedConstant>(1));
   auto a = Stmt::make<TestStmtVector>(std::vector<Stmt *>(),
@@ -67,6 +79,7 @@ TEST(StmtFieldManager, TestStmtFieldManagerWithVector) {
                                       std::vector<Stmt *>(1, one.get()));
 
   EXPECT_EQ(a->field_manager.equal(b->field_manager), true);
+  EXPECT_EQ(a->field_manager.hash(), b->field_manager.hash());
 
   auto c = Stmt::make<TestStmtVector>(std::vector<Stmt *>(1, one.get()),
                                       std::vector<Stmt *>());
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include "taichi/program/iterative_solver.h"
+
+namespace taichi {
+namespace lang {
+namespace {
+
+// 5-point Laplacian on an n x n grid, shifted by -|shift| * I
+std::unique_ptr<SparseMatrix> make_poisson(int n,
+                                           DataType dtype,
+                                           float64 shift) {
+  auto sm = make_sparse_matrix(n * n, n * n, dtype, PrimitiveType::i32);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      const int row = i * n + j;
+      sm->set_element(row, row, 4 - shift);
+      if (i > 0)
+        sm->set_element(row, row - n, -1);
+      if (i + 1 < n)
+        sm->set_element(row, row + n, -1);
+      if (j > 0)
+        sm->set_element(row, row - 1, -1);
+      if (j + 1 < n)
+        sm->set_element(row, row + 1, -1);
+    }
+  }
+  return sm;
+}
+
+float64 relative_residual(const SparseMatrix &sm,
+                          const Eigen::VectorXd &b,
+                          const Eigen::VectorXd &x) {
+  return (sm.mat_vec_mul(x) - b).norm() / b.norm();
+}
+
+}  // namespace
+
+TEST(IterativeSolver, Methods) {
+  const int n = 30;
+  auto sm = make_poisson(n, PrimitiveType::f64, 0);
+  const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n * n, -1, 1);
+  for (std::string method : {"CG", "BiCGSTAB", "MINRES"}) {
+    int num_iterations_without_preconditioner = 0;
+    for (std::string preconditioner : {"none", "Jacobi", "IC"}) {
+      auto solver = make_iterative_solver(PrimitiveType::f64, method,
+                                          preconditioner, 1000, 1e-10);
+      solver->compute(*sm);
+      Eigen::VectorXd x = Eigen::VectorXd::Zero(n * n);
+      EXPECT_TRUE(solver->solve(b.data(), x.data()))
+          << method << " " << preconditioner;
+      EXPECT_LT(relative_residual(*sm, b, x), 1e-8)
+          << method << " " << preconditioner;
+      if (preconditioner == "none") {
+        num_iterations_without_preconditioner = solver->num_iterations();
+      } else if (preconditioner == "IC") {
+        EXPECT_LT(solver->num_iterations(),
+                  num_iterations_without_preconditioner)
+            << method;
+      }
+    }
+  }
+}
+
+TEST(IterativeSolver, Indefinite) {
+  const int n = 20;
+  auto sm = make_poisson(n, PrimitiveType::f64, 1);
+  const Eigen::VectorXd b = Eigen::VectorXd::Ones(n * n);
+  auto solver =
+      make_iterative_solver(PrimitiveType::f64, "MINRES", "none", 2000, 1e-10);
+  solver->compute(*sm);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(n * n);
+  EXPECT_TRUE(solver->solve(b.data(), x.data()));
+  EXPECT_LT(relative_residual(*sm, b, x), 1e-8);
+}
+
+TEST(IterativeSolver, MatrixFree) {
+  const int n = 30;
+  auto sm = make_poisson(n, PrimitiveType::f32, 0);
+  int num_calls = 0;
+  auto matvec = [&](const void *x_ptr, void *y_ptr) {
+    auto *x = (const float32 *)x_ptr;
+    auto *y = (float32 *)y_ptr;
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        const int k = i * n + j;
+        y[k] = 4 * x[k] - (i > 0 ? x[k - n] : 0) - (i + 1 < n ? x[k + n] : 0) -
+               (j > 0 ? x[k - 1] : 0) - (j + 1 < n ? x[k + 1] : 0);
+      }
+    }
+    num_calls++;
+  };
+  const std::vector<float32> diagonal(n * n, 4);
+  auto solver =
+      make_iterative_solver(PrimitiveType::f32, "CG", "Jacobi", 1000, 1e-5);
+  solver->set_operator(n * n, matvec, diagonal.data());
+  const Eigen::VectorXf b = Eigen::VectorXf::Ones(n * n);
+  Eigen::VectorXf x = Eigen::VectorXf::Zero(n * n);
+  EXPECT_TRUE(solver->solve(b.data(), x.data()));
+  EXPECT_EQ(num_calls, solver->num_iterations() + 1);
+  EXPECT_LT((sm->mat_vec_mul(x) - b).norm() / b.norm(), 1e-4);
+
+  // The IC preconditioner needs the matrix
+  auto ic = make_iterative_solver(PrimitiveType::f32, "CG", "IC", 1000, 1e-5);
+  EXPECT_ANY_THROW(ic->set_operator(n * n, matvec, nullptr));
+}
+
+}  // namespace lang
+}  // namespace taichi
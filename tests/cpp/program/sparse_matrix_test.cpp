@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+
+#include <random>
+
+#include "taichi/program/sparse_matrix.h"
+
+namespace taichi {
+namespace lang {
+namespace {
+
+// Random matrix with about |per_col| nonzeros per column, large enough for
+// the parallel code paths
+template <typename EigenMatrix>
+EigenMatrix make_random(int rows, int cols, int per_col, int seed) {
+  using Scalar = typename EigenMatrix::Scalar;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> row(0, rows - 1);
+  std::uniform_real_distribution<Scalar> value(-1, 1);
+  std::vector<Eigen::Triplet<Scalar, typename EigenMatrix::StorageIndex>>
+      triplets;
+  for (int c = 0; c < cols; c++) {
+    for (int k = 0; k < per_col; k++) {
+      triplets.emplace_back(row(rng), c, value(rng));
+    }
+  }
+  EigenMatrix m(rows, cols);
+  m.setFromTriplets(triplets.begin(), triplets.end());
+  return m;
+}
+
+template <typename EigenMatrix>
+void expect_near(const SparseMatrix &sm, const EigenMatrix &expected) {
+  const auto &m =
+      static_cast<const EigenSparseMatrix<EigenMatrix> &>(sm).get_matrix();
+  EXPECT_EQ(m.rows(), expected.rows());
+  EXPECT_EQ(m.cols(), expected.cols());
+  EXPECT_LE((m - expected).norm(), 1e-4 * expected.norm());
+}
+
+template <typename EigenMatrix>
+void test_operations() {
+  using Scalar = typename EigenMatrix::Scalar;
+  const int n = 3000;
+  const EigenMatrix a = make_random<EigenMatrix>(n, n, 16, 1);
+  const EigenMatrix b = make_random<EigenMatrix>(n, n, 16, 2);
+  EigenSparseMatrix<EigenMatrix> sa(a), sb(b);
+
+  expect_near(*sa.add(sb), EigenMatrix(a + b));
+  expect_near(*sa.sub(sb), EigenMatrix(a - b));
+  expect_near(*sa.mul(sb), EigenMatrix(a.cwiseProduct(b)));
+  expect_near(*sa.matmul(sb), EigenMatrix(a * b));
+
+  const Eigen::VectorXf xf = Eigen::VectorXf::Random(n);
+  const Eigen::VectorXd xd = Eigen::VectorXd::Random(n);
+  const Eigen::VectorXf yf = (a * xf.cast<Scalar>()).template cast<float32>();
+  const Eigen::VectorXd yd = (a * xd.cast<Scalar>()).template cast<float64>();
+  EXPECT_LE((sa.mat_vec_mul(xf) - yf).norm(), 1e-4 * yf.norm());
+  EXPECT_LE((sa.mat_vec_mul(xd) - yd).norm(), 1e-4 * yd.norm());
+
+  // Changing an element invalidates the row-major copy used by SpMV, and
+  // leaves the matrix uncompressed
+  sa.set_element(0, n - 1, 100);
+  EigenMatrix a1 = a;
+  a1.coeffRef(0, n - 1) = 100;
+  const Eigen::VectorXd y1 = (a1 * xd.cast<Scalar>()).template cast<float64>();
+  EXPECT_LE((sa.mat_vec_mul(xd) - y1).norm(), 1e-4 * y1.norm());
+  expect_near(*sa.add(sb), EigenMatrix(a1 + b));
+  expect_near(*sa.matmul(sb), EigenMatrix(a1 * b));
+}
+
+}  // namespace
+
+TEST(SparseMatrix, ParallelOperations) {
+  test_operations<EigenSparseMatrixF32I32>();
+  test_operations<EigenSparseMatrixF64I64>();
+}
+
+TEST(SparseMatrix, RectangularProduct) {
+  using EigenMatrix = EigenSparseMatrixF64I32;
+  const EigenMatrix a = make_random<EigenMatrix>(2000, 5000, 10, 3);
+  const EigenMatrix b = make_random<EigenMatrix>(5000, 300, 200, 4);
+  EigenSparseMatrix<EigenMatrix> sa(a), sb(b);
+  expect_near(*sa.matmul(sb), EigenMatrix(a * b));
+  EXPECT_ANY_THROW(sb.matmul(sb));
+  EXPECT_ANY_THROW(sa.add(sb));
+  EXPECT_ANY_THROW(sa.mat_vec_mul(Eigen::VectorXd::Zero(2000)));
+}
+
+}  // namespace lang
+}  // namespace taichi
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "taichi/ir/statements.h"
+#include "taichi/ir/ir_builder.h"
 #include "taichi/ir/transforms.h"
 #include "tests/cpp/program/test_program.h"
 
@@ -53,5 +54,41 @@ TEST(Simplify, SimplifyLinearizedWithTrivialInputs) {
   }
 }
 
+TEST(Simplify, StmtWorklist) {
+  IRBuilder builder;
+  // (((x + 1) + 2) + 3) + 4
+  auto *x = builder.create_arg_load(0, get_data_type<int>(), false);
+  auto *one = builder.get_int32(1);
+  auto *sum1 = builder.create_add(x, one);
+  auto *two = builder.get_int32(2);
+  auto *sum2 = builder.create_add(sum1, two);
+  auto *sum3 = builder.create_add(sum2, builder.get_int32(3));
+  auto *sum4 = builder.create_add(sum3, builder.get_int32(4));
+  builder.create_return(sum4);
+  auto ir = builder.extract_ir();
+  auto *ir_block = ir->as<Block>();
+  irpass::type_check(ir_block, CompileConfig());
+  EXPECT_EQ(ir_block->size(), 10);
+
+  StmtWorklist worklist;
+  // All the statements are new.
+  EXPECT_EQ(worklist.collect(ir_block).size(), 10);
+  // Nothing has changed.
+  EXPECT_TRUE(worklist.collect(ir_block).empty());
+
+  // -> (((x + 2) + 2) + 3) + 4
+  sum1->as<BinaryOpStmt>()->rhs = two;
+  // The changed statement and its users up to two levels down
+  EXPECT_EQ(worklist.collect(ir_block),
+            std::vector<Stmt *>({sum1, sum2, sum3}));
+  EXPECT_TRUE(worklist.collect(ir_block).empty());
+
+  // -> (((x + 0) + 0) + 3) + 4
+  auto *zero = ir_block->insert(Stmt::make<ConstStmt>(TypedConstant(0)), 0);
+  irpass::replace_all_usages_with(ir_block, two, zero);
+  EXPECT_EQ(worklist.collect(ir_block),
+            std::vector<Stmt *>({zero, sum1, sum2, sum3, sum4}));
+}
+
 }  // namespace lang
 }  // namespace taichi
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include "taichi/ir/statements.h"
+#include "taichi/ir/ir_builder.h"
+#include "taichi/ir/transforms.h"
+#include "tests/cpp/program/test_program.h"
+
+namespace taichi {
+namespace lang {
+
+class WholeKernelCSETest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tp_.setup();
+  }
+
+  TestProgram tp_;
+};
+
+TEST_F(WholeKernelCSETest, ChainedExpressions) {
+  IRBuilder builder;
+  // (x + 1) * 2 - (x + 1) * 2
+  auto *x = builder.create_arg_load(0, get_data_type<int>(), false);
+  auto *lhs = builder.create_mul(builder.create_add(x, builder.get_int32(1)),
+                                 builder.get_int32(2));
+  auto *rhs = builder.create_mul(builder.create_add(x, builder.get_int32(1)),
+                                 builder.get_int32(2));
+  auto *result = builder.create_sub(lhs, rhs);
+  builder.create_return(result);
+  auto ir = builder.extract_ir();
+  ASSERT_TRUE(ir->is<Block>());
+  auto *ir_block = ir->as<Block>();
+  irpass::type_check(ir_block, CompileConfig());
+  EXPECT_EQ(ir_block->size(), 11);
+
+  // The usages of the eliminated statements are numbered in the same sweep,
+  // so the whole right hand side is eliminated.
+  EXPECT_TRUE(irpass::whole_kernel_cse(ir_block));
+  EXPECT_EQ(ir_block->size(), 7);
+  EXPECT_EQ(result->lhs, lhs);
+  EXPECT_EQ(result->rhs, lhs);
+
+  EXPECT_FALSE(irpass::whole_kernel_cse(ir_block));
+}
+
+TEST_F(WholeKernelCSETest, NestedScopes) {
+  IRBuilder builder;
+  auto *x = builder.create_arg_load(0, get_data_type<int>(), false);
+  auto *one = builder.get_int32(1);
+  auto *outer_sum = builder.create_add(x, one);
+  auto *if_stmt = builder.create_if(x);
+  Stmt *inner_sum = nullptr;
+  Stmt *inner_product = nullptr;
+  PrintStmt *inner_print = nullptr;
+  {
+    auto _ = builder.get_if_guard(if_stmt, true);
+    // Visible from the outer scope
+    inner_sum = builder.create_add(x, one);
+    inner_product = builder.create_mul(x, one);
+    inner_print = builder.create_print(inner_sum, inner_product);
+  }
+  // Not visible from the true branch
+  auto *outer_product = builder.create_mul(x, one);
+  auto *outer_print = builder.create_print(outer_sum, outer_product);
+  auto ir = builder.extract_ir();
+  ASSERT_TRUE(ir->is<Block>());
+  auto *ir_block = ir->as<Block>();
+  irpass::type_check(ir_block, CompileConfig());
+
+  EXPECT_TRUE(irpass::whole_kernel_cse(ir_block));
+  EXPECT_EQ(if_stmt->true_statements->size(), 2);
+  EXPECT_EQ(inner_print->operand(0), outer_sum);
+  EXPECT_EQ(inner_print->operand(1), inner_product);
+  EXPECT_EQ(outer_print->operand(1), outer_product);
+  EXPECT_EQ(ir_block->size(), 6);
+}
+
+TEST_F(WholeKernelCSETest, ManyConstants) {
+  IRBuilder builder;
+  constexpr int kNumConstants = 1000;
+  auto *x = builder.create_arg_load(0, get_data_type<int>(), false);
+  std::vector<Stmt *> sums;
+  std::vector<PrintStmt *> prints;
+  for (int i = 0; i < kNumConstants; i++) {
+    auto *sum = builder.create_add(x, builder.get_int32(i));
+    auto *same_sum = builder.create_add(x, builder.get_int32(i));
+    sums.push_back(sum);
+    prints.push_back(builder.create_print(sum, same_sum));
+  }
+  auto ir = builder.extract_ir();
+  ASSERT_TRUE(ir->is<Block>());
+  auto *ir_block = ir->as<Block>();
+  irpass::type_check(ir_block, CompileConfig());
+  EXPECT_EQ(ir_block->size(), 1 + kNumConstants * 5);
+
+  // Only the second copy of each constant and sum is eliminated.
+  EXPECT_TRUE(irpass::whole_kernel_cse(ir_block));
+  EXPECT_EQ(ir_block->size(), 1 + kNumConstants * 3);
+  for (int i = 0; i < kNumConstants; i++) {
+    EXPECT_EQ(prints[i]->operand(0), sums[i]);
+    EXPECT_EQ(prints[i]->operand(1), sums[i]);
+    auto *constant = sums[i]->as<BinaryOpStmt>()->rhs->as<ConstStmt>();
+    EXPECT_EQ(constant->val[0].val_int32(), i);
+  }
+}
+
+}  // namespace lang
+}  // namespace taichi
@@ -399,3 +399,35 @@ def test_triple_for_loops_bls():
     for i in range(N):
         assert b.grad[i * 2] == min(min(N - i - 1, i + 1), M) * N
         assert b.grad[i * 2 + 1] == min(min(N - i - 1, i + 1), M) * N
+
+
+@ti.test(arch=[ti.cpu, ti.cuda], ad_stack_size=4)
+def test_ad_stack_spill():
+    N = 10
+    a = ti.field(ti.f32, shape=N, needs_grad=True)
+    b = ti.field(ti.i32, shape=N)
+    p = ti.field(ti.f32, shape=N, needs_grad=True)
+
+    @ti.kernel
+    def compute_sum():
+        for i in range(N):
+            ret = 1.0
+            for j in range(b[i]):
+                ret = ret * 0.5 + a[i]
+            p[i] = ret
+
+    for i in range(N):
+        a[i] = 3
+        b[i] = 10 * i
+
+    compute_sum()
+
+    for i in range(N):
+        p.grad[i] = 1
+
+    compute_sum.grad()
+
+    for i in range(N):
+        # d(ret_n)/d(a) = sum_{k<n} 0.5^k; entries beyond the 4 inline ones
+        # live in the spilled segment of the stack.
+        assert a.grad[i] == ti.approx(2 * (1 - 0.5**b[i]))
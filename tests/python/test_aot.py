@@ -61,6 +61,48 @@ def test_save():
             json.load(json_file)
 
 
+@ti.test(arch=ti.cpu)
+def test_save_and_load_cpu():
+    density = ti.field(ti.i32, shape=(4, 4))
+    velocity = ti.Vector.field(2, ti.f32, shape=8)
+
+    @ti.kernel
+    def init():
+        for i, j in density:
+            density[i, j] = i * 4 + j
+        for i in velocity:
+            velocity[i] = [i, -i]
+
+    @ti.kernel
+    def foo(n: ti.template(), delta: ti.i32) -> ti.i32:
+        for i in range(n):
+            density[0, 0] += delta
+        return density[0, 0]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        m = ti.aot.Module(ti.cpu)
+        m.add_field('density', density)
+        m.add_field('velocity', velocity)
+        m.add_kernel(init)
+        with m.add_kernel_template(foo) as kt:
+            kt.instantiate(n=6)
+        filename = 'taichi_aot_example'
+        m.save(tmpdir, filename)
+        for suffix in ['.so', '_metadata.tcb', '_metadata.json']:
+            assert os.path.exists(os.path.join(tmpdir, filename + suffix))
+
+        loader = ti.core.AotModuleLoaderCpu(tmpdir, filename)
+        loader.launch('init')
+        for i in range(16):
+            assert loader.get_field_value('density', i) == i
+        for i in range(8):
+            assert loader.get_field_value('velocity', i) == i
+        assert loader.launch_tmpl('foo', 'n=6/', 3) == 18
+        assert loader.get_field_value('density', 0) == 18
+        for i in range(1, 16):
+            assert loader.get_field_value('density', i) == i
+
+
 @ti.test(arch=ti.opengl)
 def test_non_dense_snode():
     n = 8
@@ -1,4 +1,5 @@
 import numpy as np
+import pytest
 
 import taichi as ti
 
@@ -51,3 +52,31 @@ def test_2D_bit_array():
 
     set_val()
     verify_val()
+
+
+@pytest.mark.parametrize('block_dim', [8, 12, 64])
+@ti.test(require=ti.extension.quant, debug=True)
+def test_bit_array_parallel_store(block_dim):
+    ci4 = ti.quant.int(4, True)
+
+    x = ti.field(dtype=ci4)
+
+    N = 4096
+
+    ti.root.dense(ti.i, N // 8).bit_array(ti.i, 8, num_bits=32).place(x)
+
+    @ti.kernel
+    def set_val(k: ti.i32):
+        # Threads own whole words unless block_dim is not a multiple of 8
+        ti.block_dim(block_dim)
+        for i in range(N):
+            x[i] = (i * k) % 16 - 8
+
+    @ti.kernel
+    def verify_val(k: ti.i32):
+        for i in range(N):
+            assert x[i] == (i * k) % 16 - 8
+
+    for k in [1, 3, 5]:
+        set_val(k)
+        verify_val(k)
@@ -169,6 +169,56 @@ def test_negative(exponent_bits):
     assert b[None] == -123
 
 
+@pytest.mark.parametrize('exponent_bits', [5, 8])
+@ti.test(require=ti.extension.quant)
+def test_shared_exponent_bit_array(exponent_bits):
+    cft = ti.quant.float(exp=exponent_bits, frac=14)
+    x = ti.field(dtype=cft)
+    N = 16
+    ti.root.dense(ti.i, N // 4).bit_array(ti.i, 4, num_bits=64).place(
+        x, shared_exponent=True)
+
+    @ti.kernel
+    def fill():
+        for i in range(N):
+            x[i] = (i - 5) * 0.25
+
+    @ti.kernel
+    def add():
+        for i in range(N * 4):
+            x[i % N] += 0.5
+
+    fill()
+    for i in range(N):
+        assert x[i] == approx((i - 5) * 0.25, abs=2e-3)
+    add()
+    for i in range(N):
+        assert x[i] == approx((i - 5) * 0.25 + 2, abs=5e-3)
+
+    # The other elements of the container lose precision
+    x[0] = 100
+    assert x[0] == approx(100, rel=1e-3)
+    assert x[1] == approx(1, abs=2e-2)
+    assert x[4] == approx(1.75, abs=2e-3)
+
+
+@ti.test(require=ti.extension.quant)
+def test_custom_float_bit_array_without_exponent():
+    cft = ti.quant.fixed(frac=16, num_range=2.0)
+    x = ti.field(dtype=cft)
+    N = 16
+    ti.root.dense(ti.i, N // 4).bit_array(ti.i, 4, num_bits=64).place(x)
+
+    @ti.kernel
+    def fill():
+        for i in range(N):
+            x[i] = (i - 8) * 0.1
+
+    fill()
+    for i in range(N):
+        assert x[i] == approx((i - 8) * 0.1, abs=1e-4)
+
+
 # TODO: test precision
 # TODO: make sure unsigned has one more effective significand bit
 # TODO: test shared exponent floats with custom int in a single bit struct
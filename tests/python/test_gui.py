@@ -1,3 +1,6 @@
+import os
+import sys
+
 import numpy as np
 import pytest
 
@@ -29,3 +32,81 @@ def test_save_image_without_window(dtype):
         delta = (image - i).sum()
         assert delta == 0, "Expected image difference to be 0 but got {} instead.".format(
             delta)
+
+
+@pytest.mark.skipif(sys.platform != 'linux' or not os.environ.get('DISPLAY'),
+                    reason='Requires an X11 display, e.g. Xvfb')
+@pytest.mark.parametrize('fast_gui', [False, True])
+@pytest.mark.parametrize('shm', ['0', '1'])
+@ti.test(arch=ti.get_host_arch_list())
+def test_x11_window_image(fast_gui, shm, monkeypatch):
+    monkeypatch.setenv('TI_GUI_X11_SHM', shm)
+    res = (64, 48)
+    pixels = ti.Vector.field(3, dtype=ti.u8, shape=res)
+    gui = ti.GUI("Test", res=res, fast_gui=fast_gui)
+    rng = np.random.default_rng(0)
+
+    def check(image):
+        pixels.from_numpy(image)
+        gui.set_image(pixels)
+        gui.show()
+        window = np.zeros(res[0] * res[1], dtype=np.uint32)
+        gui.core.get_window_image(window.ctypes.data)
+        # Rows of 0x00RRGGBB pixels from the top of the window
+        window = window.reshape(res[1], res[0]).T[:, ::-1]
+        expected = (image[..., 0].astype(np.uint32) << 16) + (
+            image[..., 1].astype(np.uint32) << 8) + image[..., 2]
+        np.testing.assert_array_equal(window, expected)
+
+    image = rng.integers(0, 256, res + (3, ), dtype=np.uint8)
+    gui.show()
+    check(image)
+    # Only a small dirty rectangle is pushed
+    image[10:13, 20:30] = 255 - image[10:13, 20:30]
+    check(image)
+    check(image)
+    gui.close()
+
+
+@pytest.mark.parametrize('primitive', ['circles', 'lines', 'triangles'])
+@ti.test(arch=ti.get_host_arch_list())
+def test_batched_primitives(primitive):
+    # Enough primitives for the canvas to rasterize them in parallel tiles
+    n = 300
+    res = (256, 192)
+    rng = np.random.default_rng(0)
+    a, b, c = (rng.random((n, 2), dtype=np.float32) for _ in range(3))
+    # Points near each other, so that the primitives overlap a few tiles
+    b = a + (b - 0.5) * 0.3
+    c = a + (c - 0.5) * 0.3
+    radius = rng.random(n, dtype=np.float32) * 8 + 1
+    color = rng.integers(0, 0x1000000, n, dtype=np.uint32)
+
+    gui = ti.GUI("Test", res=res, show_gui=False)
+
+    def draw(batched):
+        gui.clear(0)
+        if primitive == 'circles':
+            if batched:
+                gui.circles(a, radius=radius, color=color)
+            else:
+                for i in range(n):
+                    gui.circle(a[i], color=int(color[i]), radius=radius[i])
+        elif primitive == 'lines':
+            if batched:
+                gui.lines(a, b, radius=radius, color=color)
+            else:
+                for i in range(n):
+                    gui.line(a[i], b[i], radius=radius[i], color=int(color[i]))
+        else:
+            if batched:
+                gui.triangles(a, b, c, color=color)
+            else:
+                for i in range(n):
+                    gui.triangle(a[i], b[i], c[i], color=int(color[i]))
+        return gui.get_image().copy()
+
+    # Overlapping primitives are blended in the same order, and the endpoints
+    # of batched lines are offset by 1e-6 (see Canvas::paths_batched)
+    np.testing.assert_allclose(draw(True), draw(False), atol=1e-2)
+    gui.close()
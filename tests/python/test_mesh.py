@@ -1,3 +1,4 @@
+import json
 import os
 
 import numpy as np
@@ -232,3 +233,70 @@ def test_mesh_local():
         assert res1[i] == res2[i]
         assert res1[i] == res3[i]
         assert res1[i] == res4[i]
+
+
+def _load_tet_mesh(filename):
+    # Recovers the raw vertices and tetrahedra from a metadata file
+    with open(filename, "r") as fi:
+        data = json.loads(fi.read())
+    verts = next(e for e in data["elements"] if e["order"] == 0)
+    cells = next(e for e in data["elements"] if e["order"] == 3)
+    cv = next(r for r in data["relations"]
+              if r["from_order"] == 3 and r["to_order"] == 0)["value"]
+    indices = np.zeros((cells["num"], 4), dtype=np.int32)
+    for p in range(data["num_patches"]):
+        vert_offset = verts["total_offsets"][p]
+        for i in range(cells["total_offsets"][p],
+                       cells["total_offsets"][p + 1]):
+            for j in range(4):
+                indices[cells["l2g_mapping"][i], j] = verts["l2g_mapping"][
+                    vert_offset + cv[i * 4 + j]]
+    return np.array(data["attrs"]["x"]).reshape(-1, 3), indices
+
+
+@ti.test(require=ti.extension.mesh, dynamic_index=False)
+def test_mesh_generate_meta():
+    vertices, indices = _load_tet_mesh(model_file_path)
+    mesh_builder = ti.Mesh.Tet()
+    mesh_builder.verts.place({'t': ti.i32})
+    mesh_builder.cells.place({'t': ti.i32}, reorder=True)
+    mesh_builder.cells.link(mesh_builder.verts)
+    mesh_builder.verts.link(mesh_builder.cells)
+    mesh_builder.cells.link(mesh_builder.cells)
+    mesh_builder.verts.link(mesh_builder.verts)
+    meta = ti.Mesh.generate_meta(vertices, indices, patch_size=4)
+    assert meta.num_patches == 6
+    model = mesh_builder.build(meta)
+
+    @ti.kernel
+    def cell_vert():
+        for c in model.cells:
+            for j in range(c.verts.size):
+                c.t += c.verts[j].id
+
+    @ti.kernel
+    def vert_cell():
+        for v in model.verts:
+            for j in range(v.cells.size):
+                v.t += v.cells[j].id
+
+    @ti.kernel
+    def cell_cell():
+        for c in model.cells:
+            for j in range(c.cells.size):
+                c.t += c.cells[j].id
+
+    @ti.kernel
+    def vert_vert():
+        for v in model.verts:
+            for j in range(v.verts.size):
+                v.t += v.verts[j].id
+
+    # Same as the ones of the preprocessed mesh in _test_mesh_for()
+    for kernel, field, total in [(cell_vert, model.cells.t, 892),
+                                 (vert_cell, model.verts.t, 1104),
+                                 (cell_cell, model.cells.t, 690),
+                                 (vert_vert, model.verts.t, 1144)]:
+        kernel()
+        assert field.to_numpy().sum() == total
+        field.fill(0)
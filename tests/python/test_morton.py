@@ -0,0 +1,84 @@
+import numpy as np
+import pytest
+
+import taichi as ti
+
+
+def _test_morton_dense(shape, block_shape=None):
+    axes = ti.ijk if len(shape) == 3 else ti.ij
+    coeffs = [10000, 100, 1][-len(shape):]
+    x = ti.field(ti.i32)
+    y = ti.field(ti.i32)
+    if block_shape is None:
+        ti.root.dense(axes, shape, morton=True).place(x, y)
+    else:
+        outer = [s // b for s, b in zip(shape, block_shape)]
+        ti.root.dense(axes, outer).dense(axes, block_shape,
+                                          morton=True).place(x, y)
+
+    @ti.kernel
+    def fill():
+        for I in ti.grouped(ti.ndrange(*shape)):
+            x[I] = I.dot(ti.Vector(coeffs))
+
+    @ti.kernel
+    def copy():
+        for I in ti.grouped(x):
+            y[I] = x[I] * 2
+
+    fill()
+    copy()
+    index = np.indices(shape)
+    expected = sum(index[k] * coeffs[k] for k in range(len(shape)))
+    np.testing.assert_equal(x.to_numpy(), expected)
+    np.testing.assert_equal(y.to_numpy(), expected * 2)
+
+    x.from_numpy(expected + 1)
+    np.testing.assert_equal(x.to_numpy(), expected + 1)
+
+
+@pytest.mark.parametrize('shape', [(16, 16), (8, 32), (5, 6, 7)])
+@ti.test()
+def test_morton_dense(shape):
+    _test_morton_dense(shape)
+
+
+@ti.test()
+def test_morton_dense_nested():
+    _test_morton_dense((16, 16, 16), block_shape=(4, 4, 8))
+
+
+@pytest.mark.parametrize('shape', [(16, 16), (4, 16), (6, 10, 12)])
+@ti.test(arch=[ti.cpu, ti.cuda], demote_dense_struct_fors=False)
+def test_morton_dense_struct_for(shape):
+    _test_morton_dense(shape)
+
+
+@ti.test(arch=[ti.cpu, ti.cuda])
+def test_morton_dense_under_pointer():
+    n = 32
+    x = ti.field(ti.i32)
+    ti.root.pointer(ti.ij, 4).dense(ti.ij, (8, 4), morton=True).place(x)
+
+    @ti.kernel
+    def activate():
+        for i, j in ti.ndrange(n, n // 2):
+            if (i // 8 + j // 4) % 2 == 0:
+                x[i, j] = i * n + j
+
+    @ti.kernel
+    def count() -> ti.i32:
+        errors = 0
+        for i, j in x:
+            if x[i, j] != i * n + j or (i // 8 + j // 4) % 2 != 0:
+                errors += 1
+        return errors
+
+    activate()
+    assert count() == 0
+
+
+@ti.test(arch=ti.cpu, packed=True)
+def test_morton_dense_packed():
+    with pytest.raises(RuntimeError):
+        ti.root.dense(ti.ij, 16, morton=True)
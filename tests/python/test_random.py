@@ -171,3 +171,43 @@ def test_randn():
         moments = [0.0, 1.0, 0.0, 3.0]
         for i in range(4):
             assert (X**(i + 1)).mean() == approx(moments[i], abs=3e-2)
+
+
+@ti.test(arch=[ti.cpu, ti.cuda])
+def test_random_philox_independent_of_threads():
+    import numpy as np
+    n = 1024
+    arch = ti.cfg.arch
+    result = []
+    for num_threads in [1, 4]:
+        ti.init(arch=arch,
+                random_generator='philox',
+                cpu_max_num_threads=num_threads)
+        x = ti.field(ti.f32, shape=(n, 4))
+        y = ti.field(ti.f64, shape=(n, n))
+
+        @ti.kernel
+        def gen():
+            for i in range(n):
+                for j in range(4):
+                    x[i, j] = ti.random()
+            for i, j in y:
+                y[i, j] = ti.random(ti.f64)
+
+        samples = []
+        for _ in range(2):
+            gen()
+            samples.append((x.to_numpy(), y.to_numpy()))
+        # Every launch draws new numbers
+        assert not np.allclose(samples[0][0], samples[1][0])
+        assert not np.allclose(samples[0][1], samples[1][1])
+        # Every draw of an iteration is different
+        assert not np.allclose(samples[0][0][:, 0], samples[0][0][:, 1])
+        for i in range(1, 4):
+            assert (samples[0][1]**i).mean() == approx(1 / (i + 1), rel=1e-2)
+        result.append(samples)
+        ti.reset()
+
+    for a, b in zip(result[0], result[1]):
+        np.testing.assert_array_equal(a[0], b[0])
+        np.testing.assert_array_equal(a[1], b[1])
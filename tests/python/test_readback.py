@@ -0,0 +1,57 @@
+import queue
+import threading
+
+import numpy as np
+import pytest
+
+import taichi as ti
+
+
+@pytest.mark.parametrize('kind', ['field', 'vector_field', 'ndarray'])
+@ti.test(arch=[ti.cpu, ti.cuda], ndarray_use_torch=False)
+def test_async_readback(kind):
+    n = 64
+    num_steps = 20
+    if kind == 'field':
+        x = ti.field(ti.f32, shape=(n, n))
+    elif kind == 'vector_field':
+        x = ti.Vector.field(3, ti.i32, shape=n)
+    else:
+        x = ti.ndarray(ti.f32, shape=(n, n))
+
+    @ti.kernel
+    def step_field(t: ti.i32):
+        for I in ti.grouped(x):
+            x[I] = x[I] * 0 + t  # Broadcasts to vectors
+
+    @ti.kernel
+    def step_ndarray(a: ti.any_arr(), t: ti.i32):
+        for I in ti.grouped(a):
+            a[I] = t
+
+    readback = ti.AsyncReadback(x, num_buffers=2)
+    futures = queue.Queue()
+    results = {}
+
+    def consume():
+        while True:
+            future = futures.get()
+            if future is None:
+                break
+            results[future.frame] = future.result()
+
+    consumer = threading.Thread(target=consume)
+    consumer.start()
+    for t in range(num_steps):
+        if kind == 'ndarray':
+            step_ndarray(x, t)
+        else:
+            step_field(t)
+        futures.put(readback.read())
+    futures.put(None)
+    consumer.join()
+
+    assert sorted(results) == list(range(num_steps))
+    for t, result in results.items():
+        assert result.shape == x.to_numpy().shape
+        np.testing.assert_array_equal(result, t)
@@ -143,3 +143,37 @@ def test_reduction_any_arr():
     n = 1024
     x = np.ones(n, dtype=np.int32)
     assert reduce(x) == -n
+
+
+@ti.test(arch=ti.cpu)
+def test_reduction_f64_accumulator():
+    N = 1024
+    a = ti.field(ti.f32, shape=N)
+    tot = ti.field(ti.f32, shape=())
+    cnt = ti.field(ti.f32, shape=())
+
+    @ti.kernel
+    def fill():
+        for i in a:
+            a[i] = 1.0 if i == 0 else 2**-24
+
+    @ti.kernel
+    def reduce():
+        ti.accumulate_in_f64(tot)
+        ti.block_dim(N)
+        for i in range(N):
+            tot[None] += a[i]
+
+    @ti.kernel
+    def count():
+        ti.accumulate_in_f64(cnt)
+        for i in range(N):
+            cnt[None] += 1.0
+
+    fill()
+    reduce()
+    # Each 2**-24 would be lost when added to 1.0 in f32
+    assert tot[None] == approx(1 + (N - 1) * 2**-24, rel=1e-6)
+    # The widening cast of a constant addend is folded
+    count()
+    assert cnt[None] == N
@@ -105,6 +105,46 @@ def test_sfg_dead_store_elimination():
         assert ti.approx(x_grad[i]) == 2.0 * i
 
 
+@ti.test(require=ti.extension.async_mode, async_mode=True)
+def test_sfg_fusion_cache():
+    n = 32
+    x = ti.field(dtype=ti.i32, shape=n)
+
+    @ti.kernel
+    def inc():
+        for i in x:
+            x[i] += 1
+
+    @ti.kernel
+    def double():
+        for i in x:
+            x[i] *= 2
+
+    inc()
+    double()
+    ti.sync()
+
+    stats = ti.get_kernel_stats()
+    stats.clear()
+
+    num_frames = 5
+    for _ in range(num_frames):
+        inc()
+        double()
+        ti.sync()
+
+    counters = stats.get_counters()
+    # Every frame fuses the same pair of tasks, which has been done before.
+    assert counters['fusion_cache_hits'] >= num_frames
+    assert 'fusion_cache_misses' not in counters
+    assert 'async_compile_cache_misses' not in counters
+
+    expected = 0
+    for _ in range(num_frames + 1):
+        expected = (expected + 1) * 2
+    assert (x.to_numpy() == expected).all()
+
+
 @ti.test(require=ti.extension.async_mode, async_mode=True)
 def test_global_tmp_value_state():
     # https://github.com/taichi-dev/taichi/issues/2024
@@ -122,3 +162,73 @@ def test_global_tmp_value_state():
     x.from_numpy(np.arange(0, n, dtype=np.float32))
     mean = compute_mean_of_boundary_edges()
     assert ti.approx(mean) == 33
+
+
+def _run_async_opt_every(arch, async_opt_every):
+    # Only ti.sync() flushes, so with async_opt_every > 0 most of the graph is
+    # optimized incrementally between flushes.
+    ti.init(arch=arch,
+            async_mode=True,
+            async_flush_every=0,
+            async_opt_every=async_opt_every)
+    n = 16
+    x = ti.field(ti.i32)
+    y = ti.field(ti.i32)
+    unused = ti.field(ti.i32, shape=())
+    ti.root.pointer(ti.i, n).dense(ti.i, 4).place(x)
+    ti.root.pointer(ti.i, n).dense(ti.i, 4).place(y)
+
+    @ti.kernel
+    def activate():
+        for i in range(n * 4):
+            if i % 3 == 0:
+                x[i] = i
+            if i % 5 == 0:
+                y[i] = i
+
+    @ti.kernel
+    def inc(f: ti.template()):
+        for i in f:
+            f[i] += 1
+
+    @ti.kernel
+    def double(f: ti.template()):
+        for i in f:
+            f[i] *= 2
+
+    @ti.kernel
+    def scatter():
+        for i in x:
+            unused[None] += x[i]
+
+    activate()
+    ti.sync()
+    stats = ti.get_kernel_stats()
+    stats.clear()
+    for _ in range(3):
+        for _ in range(10):
+            inc(x)
+            scatter()
+            double(y)
+            inc(y)
+        ti.sync()
+    counters = {
+        k: v
+        for k, v in stats.get_counters().items()
+        if k.startswith('launched_tasks')
+    }
+    return x.to_numpy(), y.to_numpy(), counters
+
+
+@pytest.mark.parametrize('async_opt_every', [1, 4, 16])
+@ti.test(require=[ti.extension.async_mode, ti.extension.sparse],
+         async_mode=True)
+def test_sfg_async_opt_every(async_opt_every):
+    arch = ti.cfg.arch
+    xs, ys, counters = _run_async_opt_every(arch, 0)
+    xs_opt, ys_opt, counters_opt = _run_async_opt_every(arch, async_opt_every)
+    np.testing.assert_array_equal(xs_opt, xs)
+    np.testing.assert_array_equal(ys_opt, ys)
+    # Optimizing between flushes only skips the nodes that are already
+    # optimized, so the same tasks are launched in the end.
+    assert counters_opt == counters
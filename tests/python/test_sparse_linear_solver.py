@@ -52,3 +52,158 @@ def test_sparse_LLT_solver(solver_type):
     x = solver.solve(b)
     for i in range(n):
         assert x[i] == ti.approx(res[i])
+
+
+@pytest.mark.parametrize("solver_type", ["LLT", "LDLT", "LU"])
+@pytest.mark.parametrize("index_dtype", [ti.i32, ti.i64])
+@ti.test(arch=ti.cpu)
+def test_sparse_solver_f64(solver_type, index_dtype):
+    n = 4
+    Abuilder = ti.linalg.SparseMatrixBuilder(n,
+                                             n,
+                                             max_num_triplets=100,
+                                             dtype=ti.f64,
+                                             index_dtype=index_dtype)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64),
+             InputArray: ti.ext_arr()):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += InputArray[i, j]
+
+    fill(Abuilder, Aarray)
+    A = Abuilder.build()
+    assert A.dtype == ti.f64
+    solver = ti.linalg.SparseSolver(dtype=ti.f64,
+                                    solver_type=solver_type,
+                                    index_dtype=index_dtype)
+    solver.compute(A)
+    x = solver.solve(np.arange(1, n + 1))
+    assert x.dtype == np.float64
+    np.testing.assert_allclose(x, res, rtol=1e-12)
+
+
+@ti.test(arch=ti.cpu, ndarray_use_torch=False)
+def test_sparse_solver_in_place():
+    n = 4
+    Abuilder = ti.linalg.SparseMatrixBuilder(n,
+                                             n,
+                                             max_num_triplets=100,
+                                             dtype=ti.f64)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64),
+             InputArray: ti.ext_arr()):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += InputArray[i, j]
+
+    fill(Abuilder, Aarray)
+    A = Abuilder.build()
+    solver = ti.linalg.SparseSolver(dtype=ti.f64)
+    solver.compute(A)
+    b = ti.ndarray(ti.f64, shape=n)
+    for i in range(n):
+        b[i] = i + 1
+    x = ti.ndarray(ti.f64, shape=n)
+    solver.solve(b, x)
+    np.testing.assert_allclose(x.to_numpy(), res, rtol=1e-12)
+
+    y = ti.field(ti.f64, shape=n)
+    solver.solve(b, y)
+    np.testing.assert_allclose(y.to_numpy(), res, rtol=1e-12)
+
+
+@pytest.mark.parametrize("solver_type", ["LLT", "LDLT", "LU"])
+@ti.test(arch=ti.cpu)
+def test_sparse_solver_refactorize(solver_type):
+    n = 4
+    Abuilder = ti.linalg.SparseMatrixBuilder(n,
+                                             n,
+                                             max_num_triplets=100,
+                                             dtype=ti.f64)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64),
+             InputArray: ti.ext_arr(), scale: ti.f64):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += InputArray[i, j] * scale
+
+    A = ti.linalg.SparseMatrix(n, n, dtype=ti.f64)
+    solver = ti.linalg.SparseSolver(dtype=ti.f64, solver_type=solver_type)
+    b = np.arange(1, n + 1)
+    for frame in range(3):
+        fill(Abuilder, Aarray, frame + 1)
+        assert Abuilder.build_into(A) is A
+        solver.compute(A)
+        np.testing.assert_allclose(solver.solve(b), res / (frame + 1),
+                                   rtol=1e-12)
+    # The pattern is only analyzed in the first frame
+    assert solver.num_analyses() == 1
+
+    @ti.kernel
+    def fill_diag(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64),
+                  InputArray: ti.ext_arr()):
+        for i in range(n):
+            Abuilder[i, i] += InputArray[i, i]
+
+    # A new pattern is analyzed again
+    fill_diag(Abuilder, Aarray)
+    Abuilder.build_into(A)
+    solver.factorize(A)
+    np.testing.assert_allclose(solver.solve(b), b / np.diag(Aarray),
+                               rtol=1e-12)
+    assert solver.num_analyses() == 2
+
+
+@pytest.mark.parametrize("solver_type", ["CG", "BiCGSTAB", "MINRES"])
+@pytest.mark.parametrize("preconditioner", ["none", "Jacobi", "IC"])
+@ti.test(arch=ti.cpu)
+def test_iterative_solver(solver_type, preconditioner):
+    n = 4
+    Abuilder = ti.linalg.SparseMatrixBuilder(n,
+                                             n,
+                                             max_num_triplets=100,
+                                             dtype=ti.f64)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=ti.f64),
+             InputArray: ti.ext_arr()):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += InputArray[i, j]
+
+    fill(Abuilder, Aarray)
+    A = Abuilder.build()
+    solver = ti.linalg.IterativeSolver(dtype=ti.f64,
+                                       solver_type=solver_type,
+                                       preconditioner=preconditioner,
+                                       tolerance=1e-12)
+    solver.compute(A)
+    x = solver.solve(np.arange(1, n + 1))
+    assert solver.info()
+    assert solver.num_iterations() <= 2 * n
+    np.testing.assert_allclose(x, res, rtol=1e-9)
+
+
+@ti.test(arch=ti.cpu)
+def test_iterative_solver_matrix_free():
+    n = 4
+    A = ti.field(ti.f32, shape=(n, n))
+    A.from_numpy(Aarray)
+
+    @ti.kernel
+    def matvec(x: ti.any_arr(), y: ti.any_arr()):
+        for i in range(n):
+            y[i] = 0.0
+            for j in range(n):
+                y[i] += A[i, j] * x[j]
+
+    solver = ti.linalg.IterativeSolver(solver_type="CG",
+                                       preconditioner="Jacobi")
+    solver.set_operator(n, matvec, diagonal=np.diag(Aarray))
+    b = ti.field(ti.f32, shape=n)
+    b.from_numpy(np.arange(1, n + 1))
+    x = ti.field(ti.f32, shape=n)
+    solver.solve(b, x)
+    assert solver.info()
+    for i in range(n):
+        assert x[i] == ti.approx(res[i], rel=1e-4)
@@ -1,3 +1,6 @@
+import numpy as np
+import pytest
+
 import taichi as ti
 
 
@@ -18,6 +21,87 @@ def test_sparse_matrix_builder():
             assert A[i, j] == i + j
 
 
+@ti.test(arch=ti.cpu)
+def test_sparse_matrix_builder_duplicates():
+    n = 8
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=300)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(), scale: ti.f32,
+             width: ti.i32):
+        for i, j, k in ti.ndrange(n, n, 4):
+            if j < width:
+                Abuilder[i, j] += scale * (i + j)
+
+    # The pattern of the first matrix is reused by the second one, but not by
+    # the third one
+    for scale, width in [(1, n), (2, n), (3, n // 2)]:
+        fill(Abuilder, scale, width)
+        A = Abuilder.build()
+        for i in range(n):
+            for j in range(n):
+                expected = 4 * scale * (i + j) if j < width else 0
+                assert A[i, j] == expected
+
+
+@ti.test(arch=ti.cpu)
+def test_sparse_matrix_builder_summation_order():
+    n = 1024
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=3 * n)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder()):
+        ti.serialize()
+        for k in range(3 * n):
+            # (1e8 + 1) - 1e8 == 0 in f32, but (1e8 - 1e8) + 1 == 1
+            value = 1e8
+            if k >= 2 * n:
+                value = -1e8
+            elif k >= n:
+                value = 1.0
+            Abuilder[k % n, k % n] += value
+
+    # The duplicates are summed in insertion order both with a new sparsity
+    # pattern and with a reused one
+    for _ in range(2):
+        fill(Abuilder)
+        A = Abuilder.build()
+        for i in range(n):
+            assert A[i, i] == 0
+
+
+@ti.test(arch=ti.cpu)
+def test_sparse_matrix_builder_overflow():
+    n = 8
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=10)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder()):
+        for i, j in ti.ndrange(n, n):
+            Abuilder[i, j] += 1
+
+    fill(Abuilder)
+    with pytest.raises(RuntimeError):
+        Abuilder.build()
+
+
+@pytest.mark.parametrize('i, j', [(8, 0), (0, 8), (-1, 0)])
+@ti.test(arch=ti.cpu)
+def test_sparse_matrix_builder_out_of_bounds(i, j):
+    n = 8
+    Abuilder = ti.linalg.SparseMatrixBuilder(n, n, max_num_triplets=10)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(), i: ti.i32,
+             j: ti.i32):
+        Abuilder[0, 0] += 1
+        Abuilder[i, j] += 1
+
+    fill(Abuilder, i, j)
+    with pytest.raises(RuntimeError):
+        Abuilder.build()
+
+
 @ti.test(arch=ti.cpu)
 def test_sparse_matrix_element_access():
     n = 8
@@ -197,3 +281,33 @@ def test_sparse_matrix_nonsymmetric_multiplication():
     for i in range(n):
         for j in range(m):
             assert C[i, j] == GT[i][j]
+
+
+@pytest.mark.parametrize("dtype", [ti.f32, ti.f64])
+@pytest.mark.parametrize("index_dtype", [ti.i32, ti.i64])
+@ti.test(arch=ti.cpu)
+def test_sparse_matrix_dtypes(dtype, index_dtype):
+    n = 8
+    Abuilder = ti.linalg.SparseMatrixBuilder(n,
+                                             n,
+                                             max_num_triplets=100,
+                                             dtype=dtype,
+                                             index_dtype=index_dtype)
+
+    @ti.kernel
+    def fill(Abuilder: ti.linalg.sparse_matrix_builder(dtype=dtype),
+             InputArray: ti.ext_arr()):
+        for i in range(n):
+            Abuilder[i, i] += InputArray[i]
+
+    values = 1 + 1e-10 * np.arange(n)
+    fill(Abuilder, values)
+    A = Abuilder.build()
+    assert A.dtype == dtype
+    assert A.index_dtype == index_dtype
+    B = (A @ A.transpose() + A) * 2.0
+    assert B.dtype == dtype
+    x = A @ np.ones(n)
+    assert x.dtype == (np.float64 if dtype == ti.f64 else np.float32)
+    if dtype == ti.f64:
+        assert A[n - 1, n - 1] == values[n - 1]
@@ -0,0 +1,68 @@
+import shutil
+import subprocess
+
+import numpy as np
+import pytest
+
+import taichi as ti
+from taichi import make_temp_file
+
+
+@pytest.mark.parametrize('kind', ['field', 'vector_field', 'ndarray'])
+@pytest.mark.parametrize('dtype', [ti.u8, ti.f32])
+@ti.test(arch=ti.get_host_arch_list(), ndarray_use_torch=False)
+def test_video_frame_conversion(kind, dtype):
+    res = (37, 20)
+    if dtype == ti.u8:
+        image = np.random.randint(256, size=res + (3, ), dtype=np.uint8)
+    else:
+        image = np.random.rand(*res, 3).astype(np.float32)
+    if kind == 'field':
+        img = ti.field(dtype, shape=res + (3, ))
+    elif kind == 'vector_field':
+        img = ti.Vector.field(3, dtype, shape=res)
+    else:
+        img = ti.Vector.ndarray(3, dtype, shape=res)
+    img.from_numpy(image)
+    writer = ti.VideoWriter(make_temp_file(suffix='.mp4'))
+    # Frames from Taichi are converted by a kernel, which must agree with the
+    # conversion of NumPy arrays up to rounding
+    frame = writer._convert(img).view(np.uint8).reshape(res[1], res[0], 4)
+    expected = writer._convert(image)
+    np.testing.assert_allclose(frame.astype(np.int32),
+                               expected.astype(np.int32),
+                               atol=0 if dtype == ti.u8 else 1)
+
+
+@pytest.mark.skipif(shutil.which('ffmpeg') is None,
+                    reason='Requires ffmpeg')
+@ti.test(arch=ti.get_host_arch_list())
+def test_video_writer():
+    res = (64, 48)
+    num_frames = 10
+    pixels = ti.Vector.field(3, ti.f32, shape=res)
+
+    @ti.kernel
+    def paint(t: ti.f32):
+        for i, j in pixels:
+            pixels[i, j] = ti.Vector([t, 0.5, 1 - t])
+
+    path = make_temp_file(suffix='.mp4')
+    with ti.VideoWriter(path, queue_size=2) as video:
+        for frame in range(num_frames):
+            paint(frame / num_frames)
+            video.write_frame(pixels)
+    assert video.frame_counter == num_frames
+
+    decoded = subprocess.run([
+        'ffmpeg', '-loglevel', 'error', '-i', path, '-f', 'rawvideo',
+        '-pix_fmt', 'rgb24', '-'
+    ],
+                             stdout=subprocess.PIPE,
+                             check=True).stdout
+    decoded = np.frombuffer(decoded, dtype=np.uint8).reshape(
+        num_frames, res[1], res[0], 3).astype(np.float32)
+    for frame in range(num_frames):
+        t = frame / num_frames
+        expected = np.array([t, 0.5, 1 - t]) * 255
+        assert np.abs(decoded[frame] - expected).mean() < 4